@@ -35,6 +35,7 @@
 #include "commands/nullcommands.h"
 #include "commands/configtest.h"
 #include "commands/shell.h"
+#include "commands/server.h"
 #include "commands/help.h"
 #include "commands/subcommand.h"
 #include "commands/locale/localescmd.h"
@@ -107,6 +108,7 @@ namespace
 
       makeCmd<HelpCmd> ( ZypperCommand::HELP_e, std::string(), { "help", "?" } ),
       makeCmd<ShellCmd>( ZypperCommand::SHELL_e, std::string(), { "shell", "sh" } ),
+      makeCmd<ServerCmd>( ZypperCommand::SERVER_e, std::string(), { "server" } ),
 
       makeCmd<ListReposCmd> ( ZypperCommand::LIST_REPOS_e, _("Repository Management:"), {"repos", "lr", "catalogs","ca"} ),
       makeCmd<AddRepoCmd>   ( ZypperCommand::ADD_REPO_e , std::string() , { "addrepo", "ar" }),
@@ -252,6 +254,7 @@ DEF_ZYPPER_COMMAND( PURGE_KERNELS );
 DEF_ZYPPER_COMMAND( HELP );
 DEF_ZYPPER_COMMAND( SHELL );
 DEF_ZYPPER_COMMAND( SHELL_QUIT );
+DEF_ZYPPER_COMMAND( SERVER );
 DEF_ZYPPER_COMMAND( MOO );
 
 DEF_ZYPPER_COMMAND( RUG_PATCH_INFO );
@@ -81,6 +81,7 @@ struct ZypperCommand
   static const ZypperCommand HELP;
   static const ZypperCommand SHELL;
   static const ZypperCommand SHELL_QUIT;
+  static const ZypperCommand SERVER;
   static const ZypperCommand MOO;
 
   static const ZypperCommand CONFIGTEST;
@@ -158,6 +159,7 @@ struct ZypperCommand
     HELP_e,
     SHELL_e,
     SHELL_QUIT_e,
+    SERVER_e,
     MOO_e,
 
     CONFIGTEST_e,
@@ -0,0 +1,459 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <new>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <zypp-core/base/Logger.h>
+#include <zypp-core/fs/PathInfo.h>
+#include <zypp/ZYppFactory.h>
+#include <zypp/Package.h>
+#include <zypp/sat/Transaction.h>
+#include <zypp/target/CommitPackageCache.h>
+
+#include "Zypper.h"
+#include "CommitPrefetcher.h"
+
+using namespace zypp;
+
+extern ZYpp::Ptr God;
+
+namespace
+{
+  /** Read all pending bytes from the non-blocking \a fd_r; \c false on EOF or error. */
+  inline bool drain( int fd_r )
+  {
+    char buf[256];
+    while ( true )
+    {
+      ssize_t got = ::read( fd_r, buf, sizeof(buf) );
+      if ( got > 0 )
+        continue;
+      if ( got < 0 && errno == EINTR )
+        continue;
+      return got < 0 && errno == EAGAIN;
+    }
+  }
+
+  /** State of a package in \ref CommitPrefetcher::Shared. */
+  enum State : unsigned char
+  {
+    PENDING = 0,	///< not yet started
+    RUNNING,		///< a lane is downloading it
+    DONE,		///< in the package cache
+    FAILED,		///< libzypp retrieves it itself
+    CLAIMED		///< libzypp retrieved it before a lane started it
+  };
+} // namespace
+
+///////////////////////////////////////////////////////////////////
+/// \brief Shared by the parent and the lanes (anonymous shared mapping).
+/// The per package states follow the struct.
+struct CommitPrefetcher::Shared
+{
+  Shared( unsigned items_r )
+  {
+    for ( unsigned idx = 0; idx < items_r; ++idx )
+      new ( &state( idx ) ) std::atomic<unsigned char>( PENDING );
+  }
+
+  std::atomic<unsigned char> & state( unsigned index_r )
+  { return reinterpret_cast<std::atomic<unsigned char> *>( this + 1 )[index_r]; }
+
+  static size_t size( unsigned items_r )
+  { return sizeof(Shared) + items_r * sizeof(std::atomic<unsigned char>); }
+
+  std::atomic<unsigned> installer { 0 };	///< index of the package being installed
+  std::atomic<bool> stop { false };		///< lanes must not start another download
+};
+
+CommitPrefetcher * CommitPrefetcher::_active = nullptr;
+
+CommitPrefetcher::CommitPrefetcher( Window window_r )
+: _window { std::move(window_r) }
+{
+  if ( ! _window.packages )
+    _window.packages = 1;
+  if ( ! _window.jobs )
+    _window.jobs = 1;
+
+  // The packages to retrieve, in the order the commit is going to install them.
+  sat::Transaction steps { God->resolver()->getTransaction() };
+  steps.order();
+  _bytesBefore.push_back( ByteCount() );
+  for ( const sat::Transaction::Step & step : steps )
+  {
+    if ( step.stepType() != sat::Transaction::TRANSACTION_INSTALL && step.stepType() != sat::Transaction::TRANSACTION_MULTIINSTALL )
+      continue;
+
+    PoolItem pi { step.satSolvable() };
+    if ( ! pi.isKind<Package>() || pi->asKind<Package>()->isCached() )
+      continue;
+
+    _index[pi.satSolvable()] = _items.size();
+    _items.push_back( pi );
+    _bytesTotal += pi.downloadSize();
+    _bytesBefore.push_back( _bytesTotal );
+  }
+
+  MIL << "Pipelined commit: " << _items.size() << " packages (" << _bytesTotal << ") to retrieve, prefetch window "
+      << _window.packages << " packages / " << _window.size << ", " << _window.jobs << " jobs" << endl;
+  if ( _items.size() < 2 )
+    return;	// libzypp retrieves the 1st one itself
+
+  _sharedSize = Shared::size( _items.size() );
+  void * addr = ::mmap( nullptr, _sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+  if ( addr == MAP_FAILED )
+  {
+    ERR << "mmap failed: " << ::strerror( errno ) << "; not prefetching" << endl;
+    return;
+  }
+  _shared = new ( addr ) Shared( _items.size() );
+
+  int fds[2];
+  if ( ::pipe2( fds, O_CLOEXEC ) != 0 )
+  {
+    ERR << "pipe failed: " << ::strerror( errno ) << "; not prefetching" << endl;
+    ::munmap( _shared, _sharedSize );
+    _shared = nullptr;
+    return;
+  }
+
+  unsigned lanes = laneCount();
+  std::vector<int> wakeRead;	// per lane: read end of its wakeup pipe
+  for ( unsigned lane = 0; lane < lanes; ++lane )
+  {
+    int wfds[2];
+    if ( ::pipe2( wfds, O_CLOEXEC | O_NONBLOCK ) != 0 )
+    {
+      ERR << "pipe failed: " << ::strerror( errno ) << "; not prefetching" << endl;
+      break;
+    }
+    wakeRead.push_back( wfds[0] );
+    _wakeFds.push_back( wfds[1] );
+  }
+
+  std::cout.flush();
+  std::cerr.flush();
+  ::fflush( nullptr );
+  for ( unsigned lane = 0; lane < wakeRead.size(); ++lane )
+  {
+    pid_t pid = ::fork();
+    if ( pid == 0 )
+    {
+      //////////////////////////////////////////////////////////////////////
+      // Zyppers signal handler would clean up the parents tmpdir on exit.
+      ::signal( SIGINT,  SIG_DFL );
+      ::signal( SIGTERM, SIG_DFL );
+      ::signal( SIGPIPE, SIG_DFL );
+
+      // Nothing to read, and nobody is reading the output.
+      int nullfd = ::open( "/dev/null", O_RDWR );
+      if ( nullfd >= 0 )
+      {
+        ::dup2( nullfd, STDIN_FILENO );
+        ::dup2( nullfd, STDOUT_FILENO );
+        ::dup2( nullfd, STDERR_FILENO );
+        ::close( nullfd );
+      }
+      ::close( fds[0] );
+      for ( int fd : _wakeFds )
+        ::close( fd );
+      for ( unsigned other = 0; other < wakeRead.size(); ++other )
+      {
+        if ( other != lane )
+          ::close( wakeRead[other] );
+      }
+
+      runLane( lane, fds[1], wakeRead[lane] );
+
+      ::_exit( 0 );
+      // No sense in returning! I am forked away!!
+      //////////////////////////////////////////////////////////////////////
+    }
+    if ( pid < 0 )
+    {
+      ERR << "fork failed: " << ::strerror( errno ) << "; not prefetching" << endl;
+      break;
+    }
+    _lanes.push_back( pid );
+  }
+  ::close( fds[1] );
+  for ( int fd : wakeRead )
+    ::close( fd );
+  _doneFd = fds[0];
+  ::fcntl( _doneFd, F_SETFL, ::fcntl( _doneFd, F_GETFL ) | O_NONBLOCK );
+
+  if ( _lanes.size() != lanes )
+  {
+    // The packages of a missing lane would never be prefetched.
+    stopLanes();
+    return;
+  }
+
+  _active = this;
+  _prefetched.resize( _items.size() );
+  _reported.resize( lanes );
+  for ( unsigned lane = 0; lane < lanes; ++lane )
+    _reported[lane] = lane + 1;
+  _report->start( callback::UserData( "CommitPreloadReport/start" ) );
+}
+
+CommitPrefetcher::~CommitPrefetcher()
+{
+  if ( _active != this )
+    return;	// never started
+
+  _active = nullptr;
+  stopLanes();
+  for ( unsigned idx = 0; idx < _prefetched.size(); ++idx )
+    dispose( idx );	// prefetched but not installed
+  MIL << "Pipelined commit: prefetched " << _done << " packages, " << _failed << " failed" << endl;
+  _report->finish( _failed ? media::CommitPreloadReport::MISS : media::CommitPreloadReport::SUCCESS,
+                   callback::UserData( "CommitPreloadReport/finish" ) );
+}
+
+unsigned CommitPrefetcher::laneCount() const
+{
+  // the 1st package is never prefetched; more lanes than the window allows would idle
+  return std::min<size_t>( std::min( _window.jobs, _window.packages ), _items.size() - 1 );
+}
+
+void CommitPrefetcher::wakeLanes()
+{
+  // A full pipe already holds a wakeup for the lane.
+  char ch = 'x';
+  for ( int fd : _wakeFds )
+  {
+    while ( ::write( fd, &ch, 1 ) < 0 && errno == EINTR )
+    {;} // just loop
+  }
+}
+
+void CommitPrefetcher::stopLanes()
+{
+  // Running downloads are completed, not killed (no partial files left behind).
+  // Closing the wakeup pipes wakes the waiting lanes.
+  _shared->stop = true;
+  for ( int fd : _wakeFds )
+    ::close( fd );
+  _wakeFds.clear();
+  for ( pid_t pid : _lanes )
+  {
+    int status = 0;
+    while ( ::waitpid( pid, &status, 0 ) < 0 && errno == EINTR )
+    {;} // just loop
+  }
+  collect();
+  _lanes.clear();
+
+  ::close( _doneFd );
+  _doneFd = -1;
+  ::munmap( _shared, _sharedSize );
+  _shared = nullptr;
+}
+
+void CommitPrefetcher::providing( const Resolvable::constPtr & res_r )
+{
+  if ( _active && res_r )
+    _active->advance( res_r->satSolvable() );
+}
+
+void CommitPrefetcher::installed()
+{
+  if ( _active )
+  {
+    _active->collect();
+    _active->dispose( _active->_installer );
+    _active->waitForNext();
+  }
+}
+
+void CommitPrefetcher::advance( const sat::Solvable & slv_r )
+{
+  auto it = _index.find( slv_r );
+  if ( it != _index.end() && it->second > _installer )
+  {
+    // libzypp retrieves these itself now; a lane must not start them.
+    for ( unsigned idx = _installer + 1; idx <= it->second; ++idx )
+    {
+      unsigned char expected = PENDING;
+      _shared->state( idx ).compare_exchange_strong( expected, CLAIMED );
+    }
+    _installer = it->second;
+    _shared->installer = _installer;
+    wakeLanes();
+  }
+  collect();
+  reportProgress();
+}
+
+void CommitPrefetcher::waitForNext()
+{
+  // libzypp retrieves the next package after an installation finished. If
+  // a lane is downloading it right now, wait for it rather than having
+  // libzypp download it a second time.
+  unsigned next = _installer + 1;
+  if ( next >= _items.size() || _shared->state( next ) != RUNNING )
+    return;
+
+  DBG << "Waiting for prefetching " << _items[next] << endl;
+  pid_t lane { _lanes[ (next - 1) % _lanes.size() ] };
+  while ( _shared->state( next ) == RUNNING )
+  {
+    struct pollfd pfd { _doneFd, POLLIN, 0 };
+    int ready = ::poll( &pfd, 1, 1000 );
+    if ( ready < 0 && errno != EINTR )
+      break;
+    if ( ready > 0 )
+    {
+      if ( ! drain( _doneFd ) )
+        break;	// all lanes are gone
+    }
+    else if ( ready == 0 )
+    {
+      // Lanes are reaped by the dtor; just check whether it died.
+      siginfo_t info;
+      info.si_pid = 0;
+      if ( ::waitid( P_PID, lane, &info, WEXITED | WNOHANG | WNOWAIT ) != 0 || info.si_pid != 0 )
+        break;
+    }
+  }
+  collect();
+  reportProgress();
+}
+
+void CommitPrefetcher::dispose( unsigned index_r )
+{
+  if ( index_r >= _prefetched.size() || ! _prefetched[index_r] )
+    return;
+  _prefetched[index_r] = false;
+
+  const PoolItem & pi { _items[index_r] };
+  if ( pi.repoInfo().keepPackages() )
+    return;
+  Pathname localfile { pi->asKind<Package>()->cachedLocation() };
+  if ( ! localfile.empty() )
+  {
+    DBG << "Removing prefetched " << localfile << endl;
+    filesystem::unlink( localfile );
+  }
+}
+
+bool CommitPrefetcher::inWindow( unsigned index_r, unsigned installer_r ) const
+{
+  if ( index_r <= installer_r + 1 )
+    return true;	// always the next one
+  if ( index_r - installer_r - 1 >= _window.packages )
+    return false;
+  return ByteCount( _bytesBefore[index_r+1] - _bytesBefore[installer_r+1] ) <= _window.size;
+}
+
+void CommitPrefetcher::runLane( unsigned lane_r, int doneFd_r, int wakeFd_r )
+{
+  _active = nullptr;	// nothing to forward in the child
+  Zypper::instance().configNoConst().non_interactive = true;	// a failed prefetch is retried by libzypp
+
+  unsigned lanes = laneCount();
+  target::CommitPackageCache packageCache;
+  for ( unsigned idx = lane_r + 1; idx < _items.size(); idx += lanes )
+  {
+    // Check before blocking: the wakeup may have been written meanwhile.
+    while ( ! _shared->stop && ! inWindow( idx, _shared->installer ) )
+    {
+      struct pollfd pfd { wakeFd_r, POLLIN, 0 };
+      if ( ::poll( &pfd, 1, -1 ) < 0 && errno != EINTR )
+        return;
+      if ( ! drain( wakeFd_r ) )
+        return;	// parent closed the pipe
+    }
+    if ( _shared->stop )
+      break;
+
+    unsigned char expected = PENDING;
+    if ( ! _shared->state( idx ).compare_exchange_strong( expected, RUNNING ) )
+      continue;	// claimed by libzypp meanwhile
+
+    bool ok = false;
+    try
+    {
+      ManagedFile localfile { packageCache.get( _items[idx] ) };
+      localfile.resetDispose();	// kept for libzypp; the parent disposes it (see dispose)
+      ok = ! localfile->empty();
+    }
+    catch ( const Exception & excpt_r )
+    {
+      ZYPP_CAUGHT( excpt_r );
+      WAR << "Prefetching " << _items[idx] << " failed: " << excpt_r.asUserHistory() << endl;
+    }
+    catch ( ... )
+    {
+      WAR << "Prefetching " << _items[idx] << " failed." << endl;
+    }
+    _shared->state( idx ) = ok ? DONE : FAILED;
+
+    char ch = 'x';
+    while ( ::write( doneFd_r, &ch, 1 ) < 0 && errno == EINTR )
+    {;} // just loop
+  }
+}
+
+void CommitPrefetcher::collect()
+{
+  drain( _doneFd );	// just wakeups
+
+  for ( unsigned lane = 0; lane < _reported.size(); ++lane )
+  {
+    // A lane finishes its packages in order.
+    unsigned & idx { _reported[lane] };
+    for ( ; idx < _items.size(); idx += _reported.size() )
+    {
+      unsigned char state = _shared->state( idx );
+      if ( state == PENDING || state == RUNNING )
+        break;
+      if ( state == CLAIMED )
+        continue;
+
+      const PoolItem & pi { _items[idx] };
+      if ( state == DONE )
+      {
+        _prefetched[idx] = true;
+        ++_done;
+        _bytesDone += pi.downloadSize();
+      }
+      else
+        ++_failed;
+
+      _report->fileDone( pi->asKind<Package>()->location().filename(),
+                         state == DONE ? media::CommitPreloadReport::NO_ERROR : media::CommitPreloadReport::ERROR,
+                         callback::UserData( "CommitPreloadReport/fileDone" ) );
+    }
+  }
+}
+
+void CommitPrefetcher::reportProgress()
+{
+  // Both streams in one line: the prefetch progress and the installers position.
+  callback::UserData data( "CommitPreloadReport/progress" );
+  data.set( "bytesReceived", double(_bytesDone) );
+  data.set( "bytesRequired", double(_bytesTotal) );
+  data.set( "packagesPrefetched", _done );
+  data.set( "packagesInstalling", _installer + 1 );
+  data.set( "packagesTotal", unsigned(_items.size()) );
+  if ( ! _report->progress( _bytesTotal ? int( 100 * double(_bytesDone) / double(_bytesTotal) ) : 100, data ) )
+    _shared->stop = true;	// user abort: don't start further downloads
+}
@@ -0,0 +1,113 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_COMMITPREFETCHER_H_
+#define ZYPPER_COMMITPREFETCHER_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <zypp-core/base/NonCopyable.h>
+#include <zypp-core/ByteCount.h>
+#include <zypp/ZYppCallbacks.h>
+#include <zypp/PoolItem.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class CommitPrefetcher
+/// \brief Download packages into the package cache while the commit installs the previous ones.
+///
+/// Used with \c DownloadAsNeeded (\c --download pipelined), which implies the
+/// classic rpm backend retrieving and installing the packages one by one: libzypp
+/// retrieves each package right before installing it, but takes it from the
+/// package cache if it is already there. While alive, the prefetcher keeps up
+/// to a \ref Window of packages (or bytes) ahead of the installer downloaded,
+/// so downloading and installing overlap.
+///
+/// The downloads are done by \ref Window::jobs forked lane processes, started
+/// by the ctor and reaped by the dtor. Each lane downloads every n-th package.
+/// The lanes and the parent share the per package state and the installers
+/// position in an anonymous shared mapping; a lane writes a byte into a pipe
+/// whenever it finished a package. A lane waiting for the window to move
+/// blocks on its own wakeup pipe, written by the parent whenever the installer
+/// advances. The lanes output goes to /dev/null (errors are logged).
+///
+/// The installer position is passed in via \ref providing, which is called from
+/// the \c DownloadResolvableReport receiver. \ref installed, called when an
+/// installation finished, waits for the package libzypp is going to retrieve
+/// next, if a lane is currently downloading it. The prefetch progress is reported
+/// via \c media::CommitPreloadReport.
+///
+/// Prefetching is best effort: a package which fails to prefetch is simply
+/// retrieved by libzypp itself, reporting any error as usual.
+///
+/// libzypp removes a package it downloaded itself after installing it, unless
+/// the repo keeps packages, but leaves a package it found in the cache alone.
+/// So the prefetched packages of repos not keeping packages are removed after
+/// their installation (or by the dtor if they were not installed).
+class CommitPrefetcher : private zypp::base::NonCopyable
+{
+public:
+  /** How far the prefetcher may get ahead of the installer (at least one package). */
+  struct Window
+  {
+    unsigned packages = 8;
+    zypp::ByteCount size = zypp::ByteCount( 256, zypp::ByteCount::MB );
+    unsigned jobs = 2;	///< max. number of lanes (packages downloaded concurrently)
+  };
+
+public:
+  /** Ctor; collects the packages to be installed in commit order and starts prefetching. */
+  CommitPrefetcher( Window window_r );
+
+  /** Dtor; stops prefetching, waits for the lanes and reports the result. */
+  ~CommitPrefetcher();
+
+  /** libzypp is about to retrieve \a res_r for installation (forwarded to the active prefetcher). */
+  static void providing( const zypp::Resolvable::constPtr & res_r );
+
+  /** libzypp installed a package and is about to retrieve the next one (forwarded to the active prefetcher). */
+  static void installed();
+
+private:
+  struct Shared;
+
+  unsigned laneCount() const;
+  void advance( const zypp::sat::Solvable & slv_r );
+  void waitForNext();
+  void dispose( unsigned index_r );
+  bool inWindow( unsigned index_r, unsigned installer_r ) const;
+  void runLane( unsigned lane_r, int doneFd_r, int wakeFd_r );
+  void wakeLanes();
+  void stopLanes();
+  void collect();
+  void reportProgress();
+
+private:
+  Window _window;
+  std::vector<zypp::PoolItem> _items;			///< packages to install in commit order
+  std::vector<zypp::ByteCount> _bytesBefore;		///< download size of the _items before (one more entry)
+  std::unordered_map<zypp::sat::Solvable, unsigned> _index;	///< position in _items
+  unsigned _installer = 0;	///< index of the package being installed
+  std::vector<unsigned> _reported;	///< per lane: next index to report
+  std::vector<bool> _prefetched;	///< per item: prefetched and not yet disposed
+  unsigned _done = 0;		///< prefetched packages
+  unsigned _failed = 0;		///< packages failed to prefetch
+  zypp::ByteCount _bytesDone;
+  zypp::ByteCount _bytesTotal;
+  Shared * _shared = nullptr;
+  size_t _sharedSize = 0;
+  std::vector<pid_t> _lanes;
+  int _doneFd = -1;		///< read end of the lanes 'package finished' pipe
+  std::vector<int> _wakeFds;	///< per lane: write end of the lanes 'installer advanced' pipe
+  zypp::callback::SendReport<zypp::media::CommitPreloadReport> _report;
+
+  static CommitPrefetcher * _active;
+};
+
+#endif /* ZYPPER_COMMITPREFETCHER_H_ */
@@ -13,6 +13,7 @@
 #include "Table.h"
 #include "Zypper.h"
 #include "utils/console.h"
+#include "output/OutJSON.h"
 
 CommitSummary::CommitSummary( const zypp::ZYppCommitResult &result, const ViewOptions options ) :
   _viewop(options),
@@ -86,6 +87,39 @@ void CommitSummary::dumpAsXmlTo(std::ostream &out)
   out << "</commit-summary>" << endl;
 }
 
+void CommitSummary::dumpAsJsonTo( std::ostream & out )
+{
+  collectData();
+
+  jsonout::Object event;
+  event.add( "event", "commit-summary" );
+  auto addList = [&event]( const char * name_r, const std::vector<zypp::sat::Solvable> & solvables_r ) {
+    if ( solvables_r.empty() )
+      return;
+    jsonout::Array list;
+    for ( const auto & solvable : solvables_r )
+    {
+      jsonout::Object obj;
+      obj.add( "type", solvable.kind().asString() );
+      obj.add( "name", solvable.name() );
+      obj.add( "edition", solvable.edition().asString() );
+      obj.add( "arch", solvable.arch().asString() );
+      if ( ! solvable.summary().empty() )
+        obj.add( "summary", solvable.summary() );
+      if ( ! solvable.description().empty() )
+        obj.add( "description", solvable.description() );
+      list.add( obj );
+    }
+    event.addRaw( name_r, list.str() );
+  };
+  addList( "failed-installs",	_failedInstalls );
+  addList( "skipped-installs",	_skippedInstalls );
+  addList( "failed-removals",	_failedRemovals );
+  addList( "skipped-removals",	_skippedRemovals );
+
+  out << event.str() << endl;
+}
+
 void CommitSummary::showBasicErrorMessage( Zypper &zypp )
 {
   zypp.out().error(_("Installation has completed with error.") );
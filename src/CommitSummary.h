@@ -49,6 +49,8 @@ public:
 
   void dumpTo( std::ostream & out );
   void dumpAsXmlTo( std::ostream & out );
+  /** The \c commit-summary event for \c --jsonout (one line). */
+  void dumpAsJsonTo( std::ostream & out );
 
   static void showBasicErrorMessage ( Zypper &zypp );
 
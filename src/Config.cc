@@ -22,6 +22,7 @@ extern "C"
 #include "utils/flags/flagtypes.h"
 #include "output/OutNormal.h"
 #include "output/OutXML.h"
+#include "output/OutJSON.h"
 #include "Config.h"
 #include "global-settings.h"
 #include "Zypper.h"
@@ -73,12 +74,20 @@ namespace
   enum class ConfigOption {
     MAIN_SHOW_ALIAS,
     MAIN_REPO_LIST_COLUMNS,
+    MAIN_REFRESH_JOBS,
+    MAIN_DOWNLOAD_JOBS,
+    MAIN_DOWNLOAD_JOBS_PER_HOST,
+    MAIN_XML_PROGRESS_INTERVAL,
 
     SOLVER_INSTALL_RECOMMENDS,
     SOLVER_FORCE_RESOLUTION_COMMANDS,
 
     COMMIT_AUTO_AGREE_WITH_LICENSES,
     COMMIT_PS_CHECK_ACCESS_DELETED,
+    COMMIT_PS_CHECK_ACCESS_DELETED_SCOPE,
+    COMMIT_PIPELINE_WINDOW,
+    COMMIT_PIPELINE_WINDOW_SIZE,
+    COMMIT_PIPELINE_JOBS,
 
     COLOR_USE_COLORS,
     COLOR_RESULT,
@@ -110,11 +119,19 @@ namespace
     static const std::vector<std::pair<std::string,ConfigOption>> _data = {
       { "main/showAlias",			ConfigOption::MAIN_SHOW_ALIAS			},
       { "main/repoListColumns",			ConfigOption::MAIN_REPO_LIST_COLUMNS		},
+      { "main/refreshJobs",			ConfigOption::MAIN_REFRESH_JOBS			},
+      { "main/downloadJobs",			ConfigOption::MAIN_DOWNLOAD_JOBS		},
+      { "main/downloadJobsPerHost",		ConfigOption::MAIN_DOWNLOAD_JOBS_PER_HOST	},
+      { "main/xmlProgressInterval",		ConfigOption::MAIN_XML_PROGRESS_INTERVAL	},
       { "solver/installRecommends",		ConfigOption::SOLVER_INSTALL_RECOMMENDS		},
       { "solver/forceResolutionCommands",	ConfigOption::SOLVER_FORCE_RESOLUTION_COMMANDS	},
 
       { "commit/autoAgreeWithLicenses",		ConfigOption::COMMIT_AUTO_AGREE_WITH_LICENSES	},
       { "commit/psCheckAccessDeleted",		ConfigOption::COMMIT_PS_CHECK_ACCESS_DELETED	},
+      { "commit/psCheckAccessDeletedScope",	ConfigOption::COMMIT_PS_CHECK_ACCESS_DELETED_SCOPE	},
+      { "commit/pipelineWindow",		ConfigOption::COMMIT_PIPELINE_WINDOW		},
+      { "commit/pipelineWindowSize",		ConfigOption::COMMIT_PIPELINE_WINDOW_SIZE	},
+      { "commit/pipelineJobs",			ConfigOption::COMMIT_PIPELINE_JOBS		},
 
       { "color/useColors",			ConfigOption::COLOR_USE_COLORS			},
       //"color/background"			LEGACY
@@ -188,8 +205,16 @@ namespace
 
 Config::Config()
   : repo_list_columns("anr")
+  , repo_refreshJobs(1)
+  , download_jobs(1)
+  , download_jobsPerHost(4)
+  , xml_progressInterval(100)
   , solver_installRecommends(!ZConfig::instance().solver_onlyRequires())
   , psCheckAccessDeleted(true)
+  , psCheckAccessDeletedSystemWide(false)
+  , commit_pipelineWindow(8)
+  , commit_pipelineWindowSize(256)
+  , commit_pipelineJobs(2)
   , color_useColors	("autodetect")
   , color_pkglistHighlight(true)
   , color_pkglistHighlightAttribute(ansi::Color::nocolor())
@@ -213,7 +238,6 @@ Config::Config()
   , terse( false )
   , changedRoot( false )
   , ignore_unknown( false )
-  , exclude_optional_patches_default( true )
   , exclude_optional_patches( exclude_optional_patches_default )
   , wantHelp ( false )
 {}
@@ -349,7 +373,7 @@ std::vector<ZyppFlags::CommandGroup> Config::cliOptions()
         std::move( ZyppFlags::CommandOption(
           "xmlout", 'x', ZyppFlags::NoArgument, ZyppFlags::CallbackVal( [ this ]( const ZyppFlags::CommandOption &, const boost::optional<std::string> & ) {
                 do_colors = false;	// no color in xml mode!
-                Zypper::instance().setOutputWriter( new OutXML( verbosity ) );
+                Zypper::instance().setOutputWriter( new OutXML( verbosity, xml_progressInterval ) );
                 machine_readable = true;
                 no_abbrev = true;
               }),
@@ -357,6 +381,17 @@ std::vector<ZyppFlags::CommandGroup> Config::cliOptions()
               _("Switch to XML output.")
           ).setPriority( Priority::OUTPUT )
         ),
+        std::move( ZyppFlags::CommandOption(
+          "jsonout", '\0', ZyppFlags::NoArgument, ZyppFlags::CallbackVal( [ this ]( const ZyppFlags::CommandOption &, const boost::optional<std::string> & ) {
+                do_colors = false;	// no color in json mode!
+                Zypper::instance().setOutputWriter( new OutJSON( verbosity ) );
+                machine_readable = true;
+                no_abbrev = true;
+              }),
+              // translators: --jsonout
+              _("Switch to JSON output (one JSON object per line).")
+          ).setPriority( Priority::OUTPUT )
+        ),
         { "ignore-unknown", 'i', ZyppFlags::NoArgument, ZyppFlags::BoolType( &ignore_unknown, ZyppFlags::StoreTrue, ignore_unknown ),
               // translators: --ignore-unknown, -i
               _("Ignore unknown packages.")
@@ -582,6 +617,42 @@ void Config::read( const std::string & file )
     if (!s.empty()) // TODO add some validation
       repo_list_columns = s;
 
+    s = augeas.getOption(asString( ConfigOption::MAIN_REFRESH_JOBS ));
+    if (!s.empty())
+    {
+      unsigned jobs = 0;
+      str::strtonum( s, jobs );
+      if ( jobs )
+        repo_refreshJobs = jobs;
+      else
+        WAR << "zypper.conf: main/refreshJobs: invalid value '" << s << "'" << endl;
+    }
+
+    for ( const auto & el : std::initializer_list<std::pair<unsigned &, ConfigOption>> {
+      { download_jobs,		ConfigOption::MAIN_DOWNLOAD_JOBS		},
+      { download_jobsPerHost,	ConfigOption::MAIN_DOWNLOAD_JOBS_PER_HOST	},
+    } )
+    {
+      s = augeas.getOption( asString( el.second ) );
+      if ( s.empty() )
+        continue;
+      unsigned val = 0;
+      str::strtonum( s, val );
+      if ( val )
+        el.first = val;
+      else
+        WAR << "zypper.conf: " << asString( el.second ) << ": invalid value '" << s << "'" << endl;
+    }
+
+    s = augeas.getOption(asString( ConfigOption::MAIN_XML_PROGRESS_INTERVAL ));
+    if (!s.empty())
+    {
+      if ( s.find_first_not_of( "0123456789" ) == std::string::npos )	// 0 is valid
+        xml_progressInterval = str::strtonum<unsigned>( s );
+      else
+        WAR << "zypper.conf: main/xmlProgressInterval: invalid value '" << s << "'" << endl;
+    }
+
     // ---------------[ solver ]------------------------------------------------
 
     s = augeas.getOption(asString( ConfigOption::SOLVER_INSTALL_RECOMMENDS ));
@@ -611,6 +682,31 @@ void Config::read( const std::string & file )
     if ( ! s.empty() )
       psCheckAccessDeleted = str::strToBool( s, psCheckAccessDeleted );
 
+    s = augeas.getOption(asString( ConfigOption::COMMIT_PS_CHECK_ACCESS_DELETED_SCOPE ));
+    if ( s == "system" )
+      psCheckAccessDeletedSystemWide = true;
+    else if ( s == "transaction" )
+      psCheckAccessDeletedSystemWide = false;
+    else if ( ! s.empty() )
+      WAR << "zypper.conf: commit/psCheckAccessDeletedScope: invalid value '" << s << "'" << endl;
+
+    for ( const auto & el : std::initializer_list<std::pair<unsigned &, ConfigOption>> {
+      { commit_pipelineWindow,		ConfigOption::COMMIT_PIPELINE_WINDOW		},
+      { commit_pipelineWindowSize,	ConfigOption::COMMIT_PIPELINE_WINDOW_SIZE	},
+      { commit_pipelineJobs,		ConfigOption::COMMIT_PIPELINE_JOBS		},
+    } )
+    {
+      s = augeas.getOption( asString( el.second ) );
+      if ( s.empty() )
+        continue;
+      unsigned val = 0;
+      str::strtonum( s, val );
+      if ( val )
+        el.first = val;
+      else
+        WAR << "zypper.conf: " << asString( el.second ) << ": invalid value '" << s << "'" << endl;
+    }
+
     // ---------------[ colors ]------------------------------------------------
 
     s = augeas.getOption( asString( ConfigOption::COLOR_USE_COLORS ) );
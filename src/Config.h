@@ -38,10 +38,29 @@ struct Config : public ztui::Config
   /** Which columns to show in repo list by default (string of short options).*/
   std::string repo_list_columns;
 
+  /** zypper.conf: main.refreshJobs - number of repos to refresh in parallel */
+  unsigned repo_refreshJobs;
+
+  /** zypper.conf: main.downloadJobs - number of packages '(source-)download' retrieves in parallel */
+  unsigned download_jobs;
+  /** zypper.conf: main.downloadJobsPerHost - max. parallel downloads from the same server */
+  unsigned download_jobsPerHost;
+
+  /** zypper.conf: main.xmlProgressInterval - min. ms between two progress updates of a task in XML output */
+  unsigned xml_progressInterval;
+
   bool solver_installRecommends;
   std::set<ZypperCommand> solver_forceResolutionCommands;
 
   bool psCheckAccessDeleted;	///< do post commit 'zypper ps' check?
+  bool psCheckAccessDeletedSystemWide;	///< post commit check for all deleted files, not just the replaced ones
+
+  /** zypper.conf: commit.pipelineWindow - max. packages prefetched ahead of the installer (--download pipelined) */
+  unsigned commit_pipelineWindow;
+  /** zypper.conf: commit.pipelineWindowSize - max. MiB prefetched ahead of the installer (--download pipelined) */
+  unsigned commit_pipelineWindowSize;
+  /** zypper.conf: commit.pipelineJobs - max. packages downloaded concurrently ahead of the installer (--download pipelined) */
+  unsigned commit_pipelineJobs;
 
   /** zypper.conf: color.useColors */
   std::string color_useColors;
@@ -85,7 +104,7 @@ struct Config : public ztui::Config
   bool terse;
   bool changedRoot;
   bool ignore_unknown;
-  const int	exclude_optional_patches_default;	// global default
+  static constexpr int exclude_optional_patches_default = true;	// global default
   int		exclude_optional_patches;		// effective value (--with[out]-optional)
   bool wantHelp; ///< help was requested by CLI
 
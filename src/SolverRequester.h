@@ -52,6 +52,7 @@ struct CliMatchPatch
       {
         zypper.out().warning( str::Format(_("Suspicious category filter value '%1%'.")) % cat );
       }
+      _categoriesLC.insert( str::toLower( cat ) );
     }
     _severities = std::move ( severities_r );
     for ( const std::string & sev : _severities )
@@ -60,6 +61,7 @@ struct CliMatchPatch
       {
         zypper.out().warning( str::Format(_("Suspicious severity filter value '%1%'.")) % sev );
       }
+      _severitiesLC.insert( str::toLower( sev ) );
     }
   }
 
@@ -91,11 +93,27 @@ struct CliMatchPatch
   bool operator()( const PoolItem & pi_r ) const
   { return pi_r.isKind<Patch>() && operator()( asKind<Patch>(pi_r) ); }
 
+  /** \overload for already retrieved patch attributes (category and severity lowercased)
+   * Like Patch::isCategory and Patch::isSeverity the strings are compared case insensitive.
+   */
+  bool operator()( const Date & timestamp_r, const std::string & categoryLC_r, const std::string & severityLC_r ) const
+  {
+    if ( _dateBefore && timestamp_r > _dateBefore )
+      return false;
+    if ( ! ( _categoriesLC.empty() || _categoriesLC.count( categoryLC_r ) ) )
+      return false;
+    if ( ! ( _severitiesLC.empty() || _severitiesLC.count( severityLC_r ) ) )
+      return false;
+    return true;
+  }
+
 private:
   friend class SolverRequester;	// SolverRequester::updatePatches uses _dateBefore
   Date _dateBefore;
   std::set<std::string> _categories;
   std::set<std::string> _severities;
+  std::set<std::string> _categoriesLC;	///< _categories lowercased
+  std::set<std::string> _severitiesLC;	///< _severities lowercased
 };
 
 
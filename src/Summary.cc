@@ -6,15 +6,21 @@
 \*---------------------------------------------------------------------------*/
 
 #include <string.h>
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <sstream>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <zypp/ZYppFactory.h>
 #include <zypp-core/base/LogTools.h>
 #include <zypp/base/Measure.h>
 #include <zypp-core/base/DtorReset>
 #include <zypp/ResPool.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/WhatProvides.h>
 #include <zypp/Patch.h>
 #include <zypp/Package.h>
 #include <zypp/ui/Selectable.h>
@@ -25,6 +31,7 @@
 #include "utils/misc.h"
 #include "Table.h"
 #include "Zypper.h"
+#include "output/OutJSON.h"
 
 #include "Summary.h"
 #include "utils/console.h"
@@ -171,12 +178,83 @@ namespace {
 
 // --------------------------------------------------------------------------
 
-bool Summary::ResPairNameCompare::operator()( const ResPair & p1, const ResPair & p2 ) const
+namespace
+{
+  /** The \c strxfrm key of \a name_r; comparing keys via \c strcmp is like \c strcoll on the names. */
+  std::string collationKey( const std::string & name_r )
+  {
+    std::string ret;
+    size_t len = ::strxfrm( nullptr, name_r.c_str(), 0 );
+    ret.resize( len + 1 );
+    ::strxfrm( &ret[0], name_r.c_str(), len + 1 );
+    ret.resize( len );
+    return ret;
+  }
+} // namespace
+
+void Summary::ResPairSet::doSort() const
+{
+  // keys of a previous sort are still valid
+  _keys.reserve( _pairs.size() );
+  for ( size_t i = _keys.size(); i < _pairs.size(); ++i )
+    _keys.push_back( collationKey( _pairs[i].second.name() ) );
+
+  std::vector<size_t> order( _pairs.size() );
+  std::iota( order.begin(), order.end(), 0 );
+  auto less = [this]( size_t lhs, size_t rhs ) { return compare( *this, lhs, *this, rhs ) < 0; };
+  // stable: the entry inserted first preceeds its equivalents
+  std::stable_sort( order.begin(), order.end(), less );
+
+  std::vector<ResPair> pairs;
+  std::vector<std::string> keys;
+  pairs.reserve( order.size() );
+  keys.reserve( order.size() );
+  for ( size_t idx : order )
+  {
+    if ( ! pairs.empty() && keys.back() == _keys[idx]
+         && Edition::compare( pairs.back().second.edition(), _pairs[idx].second.edition() ) == 0 )
+      continue;	// equivalent to the previous one
+    pairs.push_back( _pairs[idx] );
+    keys.push_back( std::move(_keys[idx]) );
+  }
+  _pairs.swap( pairs );
+  _keys.swap( keys );
+  _sorted = true;
+}
+
+int Summary::ResPairSet::compare( const ResPairSet & lhs_r, size_t lidx_r, const ResPairSet & rhs_r, size_t ridx_r )
 {
-  int ret = ::strcoll( p1.second->name().c_str(), p2.second->name().c_str() );
+  int ret = lhs_r._keys[lidx_r].compare( rhs_r._keys[ridx_r] );
   if ( ret == 0 )
-    return p1.second->edition() < p2.second->edition();
-  return ret < 0;
+    ret = Edition::compare( lhs_r._pairs[lidx_r].second.edition(), rhs_r._pairs[ridx_r].second.edition() );
+  return ret;
+}
+
+Summary::ResPairSet Summary::ResPairSet::difference( const ResPairSet & lhs_r, const ResPairSet & rhs_r )
+{
+  lhs_r.sort();
+  rhs_r.sort();
+
+  ResPairSet ret;
+  size_t l = 0;
+  size_t r = 0;
+  while ( l < lhs_r._pairs.size() )
+  {
+    int cmp = ( r < rhs_r._pairs.size() ? compare( lhs_r, l, rhs_r, r ) : -1 );
+    if ( cmp < 0 )
+    {
+      ret._pairs.push_back( lhs_r._pairs[l] );
+      ret._keys.push_back( lhs_r._keys[l] );
+      ++l;
+    }
+    else
+    {
+      if ( cmp == 0 )
+        ++l;
+      ++r;
+    }
+  }
+  return ret;
 }
 
 // --------------------------------------------------------------------------
@@ -194,20 +272,15 @@ Summary::Summary( const ResPool & pool, SummaryHints summaryHints, const ViewOpt
 
 // --------------------------------------------------------------------------
 
-struct ResNameCompare
+namespace
 {
-  bool operator()( ResObject::constPtr r1, ResObject::constPtr r2 ) const
+  /** Log the number of entries per kind in \a category_r. */
+  void logCategory( const char * name_r, const Summary::KindToResPairSet & category_r )
   {
-    int ret = ::strcoll( r1->name().c_str(), r2->name().c_str() );
-    if ( ret == 0 )
-      return r1->edition() < r2->edition();
-    return ret < 0;
+    for ( const auto & [kind, resPairs] : category_r )
+      DBG << "summary " << name_r << ": " << resPairs.size() << " " << kind << endl;
   }
-};
-
-typedef std::map<Resolvable::Kind, std::set<ResObject::constPtr, ResNameCompare> > KindToResObjectSet;
-
-// --------------------------------------------------------------------------
+} // namespace
 
 void Summary::readPool( const ResPool & pool )
 {
@@ -223,6 +296,9 @@ void Summary::readPool( const ResPool & pool )
   _inst_size_remove = ByteCount();
 
   _ctc.clear();
+  _requested.clear();
+  _recommendsCollected = false;
+  _notInstalledDepsCollected = false;
 
   // find multi-version packages, which actually have mult. versions installed
   for ( const ui::Selectable::Ptr & s : sat::Pool::instance().multiversion().selectable() )
@@ -232,53 +308,58 @@ void Summary::readPool( const ResPool & pool )
     if ( s->installedSize() > 1 || ( s->installedSize() == 1 && s->toInstall() ) )
       _multiInstalled.insert( s->name() );
   }
-  // collect resolvables to be installed/removed
 
-  KindToResObjectSet to_be_installed;
-  KindToResObjectSet to_be_removed;
+  // Classify the transaction in a single sweep over the pool. Everything else
+  // is derived from the collected lists, the pool is not scanned again.
+  // (Like the final lists, the ones to be installed/removed are ordered by
+  // name and edition; the pairing of upgrades below relies on this.)
+  KindToResPairSet to_be_installed;
+  KindToResPairSet to_be_removed;
 
   MIL << "Pool contains " << pool.size() << " items." << std::endl;
   DBG << "Install summary:" << endl;
 
-  debug::Measure m;
-
-  for_( it, pool.begin(), pool.end() )
   {
-    if (it->status().isToBeInstalled() || it->status().isToBeUninstalled())
+    debug::Measure m( "summary transaction sweep" );
+    for ( const PoolItem & pi : pool )
     {
-      if ( it->isKind( ResKind::patch ) )
+      const ResStatus & status { pi.status() };
+      if ( ! ( status.isToBeInstalled() || status.isToBeUninstalled() ) )
+        continue;
+
+      if ( pi.isKind( ResKind::patch ) )
       {
-        Patch::constPtr patch = asKind<Patch>(it->resolvable());
+        Patch::constPtr patch = asKind<Patch>( pi.resolvable() );
 
         // set the 'need reboot' flag
         if ( patch->rebootSuggested() )
         {
           _need_reboot_patch = true;
-          _rebootNeeded[ResKind::patch].insert( ResPair( nullptr, patch ) );
+          _rebootNeeded[ResKind::patch].insert( pi.satSolvable() );
         }
         else if ( patch->restartSuggested() )
           _need_restart = true;
       }
 
-      if (it->status().isToBeInstalled())
+      if ( status.isToBeInstalled() )
       {
         DBG << "<install>   ";
-        to_be_installed[it->kind()].insert(it->resolvable());
+        to_be_installed[pi.kind()].insert( pi.satSolvable() );
 
-        if ( it->isKind( ResKind::package ) ) {
-          Package::constPtr package = asKind<Package>( it->resolvable() );
+        if ( pi.isKind( ResKind::package ) ) {
+          Package::constPtr package = asKind<Package>( pi.resolvable() );
           if ( package->isNeedreboot() ) {
             _need_reboot_nonpatch = true;
-            _rebootNeeded[ResKind::package].insert( ResPair( nullptr, package ) );
+            _rebootNeeded[ResKind::package].insert( pi.satSolvable() );
           }
         }
       }
-      if (it->status().isToBeUninstalled())
+      if ( status.isToBeUninstalled() )
       {
         DBG << "<uninstall> ";
-        to_be_removed[it->kind()].insert(it->resolvable());
+        to_be_removed[pi.kind()].insert( pi.satSolvable() );
       }
-      DBG << *it << endl;
+      DBG << pi << endl;
     }
   }
 
@@ -299,7 +380,7 @@ void Summary::readPool( const ResPool & pool )
   }
 
   for ( const auto & spkg : Zypper::instance().runtimeData().srcpkgs_to_install )
-  { to_be_installed[ResKind::srcpackage].insert(spkg); }
+  { to_be_installed[ResKind::srcpackage].insert( spkg->satSolvable() ); }
 
   // total packages to download & install
   // (packages & srcpackages only - patches, patterns, and products are virtual)
@@ -307,196 +388,212 @@ void Summary::readPool( const ResPool & pool )
     to_be_installed[ResKind::package].size() +
     to_be_installed[ResKind::srcpackage].size();
 
-  m.elapsed();
-
   // iterate the to_be_installed to find installs/upgrades/downgrades + size info
-  for_( it, to_be_installed.begin(), to_be_installed.end() )
   {
-    for_( resit, it->second.begin(), it->second.end() )
+    debug::Measure m( "summary install/upgrade/downgrade" );
+    std::vector<bool> paired( sat::Pool::instance().capacity() );	// removals turned out to be an upgrade/downgrade
+
+    for ( const auto & [kind, installs] : to_be_installed )
     {
-      ResObject::constPtr res(*resit);
-      Package::constPtr pkg = asKind<Package>(res);
+      // the ones to be removed by name, ordered by edition
+      std::unordered_map<IdString::IdType, std::vector<sat::Solvable>> removals;
+      for ( const ResPair & rp : to_be_removed[kind] )
+        removals[rp.second.ident().id()].push_back( rp.second );
 
-      if ( pkg )
+      for ( const ResPair & ip : installs )
       {
-        switch ( pkg->vendorSupport() )
+        sat::Solvable res { ip.second };
+        PoolItem pi { res };
+        Package::constPtr pkg = asKind<Package>( pi.resolvable() );
+
+        if ( pkg )
         {
-          case VendorSupportUnknown:
-            _supportUnknown[res->kind()].insert( ResPair( nullptr, res ) );
-            break;
-          case VendorSupportUnsupported:
-            _supportUnsupported[res->kind()].insert( ResPair( nullptr, res ) );
-            break;
-          case VendorSupportACC:
-            _supportNeedACC[res->kind()].insert( ResPair( nullptr, res ) );
-            break;
-          case VendorSupportSuperseded:
-            _supportSuperseded[res->kind()].insert( ResPair( nullptr, res ) );
-          default:
-            // L1, L2 or L3 support are not reported
-            break;
+          switch ( pkg->vendorSupport() )
+          {
+            case VendorSupportUnknown:
+              _supportUnknown[kind].insert( res );
+              break;
+            case VendorSupportUnsupported:
+              _supportUnsupported[kind].insert( res );
+              break;
+            case VendorSupportACC:
+              _supportNeedACC[kind].insert( res );
+              break;
+            case VendorSupportSuperseded:
+              _supportSuperseded[kind].insert( res );
+            default:
+              // L1, L2 or L3 support are not reported
+              break;
+          }
         }
-      }
 
-      // find in to_be_removed:
-      bool upgrade_downgrade = false;
-      for_( rmit, to_be_removed[res->kind()].begin(), to_be_removed[res->kind()].end() )
-      {
-        if ( res->name() == (*rmit)->name() )
+        // find in to_be_removed:
+        bool upgrade_downgrade = false;
+        auto sameName = removals.find( res.ident().id() );
+        if ( sameName != removals.end() )
         {
-          ResPair rp( *rmit, res );
-
-          // upgrade
-          if ( res->edition() > (*rmit)->edition() )
+          for ( sat::Solvable rm : sameName->second )
           {
-            // don't put multiversion packages to '_toupgrade', they will
-            // always be reported as newly installed (and removed)
-            if (_multiInstalled.find( res->name()) != _multiInstalled.end() )
+            if ( paired[rm.id()] )
               continue;
 
-            _toupgrade[res->kind()].insert( rp );
-            if ( res->arch() != (*rmit)->arch() )
-              _tochangearch[res->kind()].insert( rp );
-            if ( !VendorAttr::instance().equivalent(res->vendor(), (*rmit)->vendor()) )
-              _tochangevendor[res->kind()].insert( rp );
-          }
-          // reinstall
-          else if ( res->edition() == (*rmit)->edition() )
-          {
-            if ( res->arch() != (*rmit)->arch() )
-              _tochangearch[res->kind()].insert( rp );
+            ResPair rp( rm, res );
+
+            // upgrade
+            if ( res.edition() > rm.edition() )
+            {
+              // don't put multiversion packages to '_toupgrade', they will
+              // always be reported as newly installed (and removed)
+              if ( _multiInstalled.find( res.name() ) != _multiInstalled.end() )
+                continue;
+
+              _toupgrade[kind].insert( rp );
+              if ( res.arch() != rm.arch() )
+                _tochangearch[kind].insert( rp );
+              if ( !VendorAttr::instance().equivalent( res.vendor(), rm.vendor() ) )
+                _tochangevendor[kind].insert( rp );
+            }
+            // reinstall
+            else if ( res.edition() == rm.edition() )
+            {
+              if ( res.arch() != rm.arch() )
+                _tochangearch[kind].insert( rp );
+              else
+                _toreinstall[kind].insert( rp );
+              if ( !VendorAttr::instance().equivalent( res.vendor(), rm.vendor() ) )
+                _tochangevendor[kind].insert( rp );
+            }
+            // downgrade
             else
-              _toreinstall[res->kind()].insert( rp );
-            if ( !VendorAttr::instance().equivalent( res->vendor(), (*rmit)->vendor() ) )
-              _tochangevendor[res->kind()].insert( rp );
-          }
-          // downgrade
-          else
-          {
-            // don't put multiversion packages to '_todowngrade', they will
-            // always be reported as newly installed (and removed)
-            if ( _multiInstalled.find( res->name() ) != _multiInstalled.end() )
-              continue;
-
-            _todowngrade[res->kind()].insert( rp );
-            if ( res->arch() != (*rmit)->arch() )
-              _tochangearch[res->kind()].insert( rp );
-            if ( !VendorAttr::instance().equivalent(res->vendor(), (*rmit)->vendor()) )
-              _tochangevendor[res->kind()].insert( rp );
+            {
+              // don't put multiversion packages to '_todowngrade', they will
+              // always be reported as newly installed (and removed)
+              if ( _multiInstalled.find( res.name() ) != _multiInstalled.end() )
+                continue;
+
+              _todowngrade[kind].insert( rp );
+              if ( res.arch() != rm.arch() )
+                _tochangearch[kind].insert( rp );
+              if ( !VendorAttr::instance().equivalent( res.vendor(), rm.vendor() ) )
+                _tochangevendor[kind].insert( rp );
+            }
+
+            _inst_size_install += res.installSize();
+            _inst_size_remove += rm.installSize();
+
+            // this turned out to be an upgrade/downgrade
+            paired[rm.id()] = true;
+            upgrade_downgrade = true;
+            break;
           }
+        }
 
-          _inst_size_install += res->installSize();
-          _inst_size_remove += (*rmit)->installSize();
-
-          // this turned out to be an upgrade/downgrade
-          to_be_removed[res->kind()].erase( *rmit );
-          upgrade_downgrade = true;
-          break;
+        if ( !upgrade_downgrade )
+        {
+          _toinstall[kind].insert( res );
+          _inst_size_install += res.installSize();
+          if ( pi.status().getTransactByValue() != ResStatus::SOLVER )
+            _requested.push_back( res );
         }
+
+        if ( pkg && pkg->isCached() )
+          _incache += res.downloadSize();
+        else
+          _todownload += res.downloadSize();
       }
+    }
 
-      if ( !upgrade_downgrade )
+    // collect the rest (not upgraded/downgraded) of to_be_removed as '_toremove'
+    // and decrease installed size change accordingly
+    for ( const auto & [kind, removes] : to_be_removed )
+      for ( const ResPair & rp : removes )
       {
-        _toinstall[res->kind()].insert( ResPair( nullptr, res ) );
-        _inst_size_install += res->installSize();
+        if ( paired[rp.second.id()] )
+          continue;
+        _toremove[kind].insert( rp.second );
+        _inst_size_remove += rp.second.installSize();
       }
-
-      if ( pkg && pkg->isCached() )
-        _incache += res->downloadSize();
-      else
-        _todownload += res->downloadSize();
-    }
   }
 
-  m.elapsed();
-
-  // collect the rest (not upgraded/downgraded) of to_be_removed as '_toremove'
-  // and decrease installed size change accordingly
+  // *** notupdated ***
+  {
+    debug::Measure m( "summary notupdated" );
 
-  //bool _toremove_by_solver = false;
-  for_( it, to_be_removed.begin(), to_be_removed.end() )
-    for_( resit, it->second.begin(), it->second.end() )
+    // get all available updates, no matter if they are installable or break
+    // some current policy
+    KindToResPairSet candidates;
+    ResKindSet kinds;
+    kinds.insert( ResKind::package );
+    kinds.insert( ResKind::product );
+    for_( kit, kinds.begin(), kinds.end() )
     {
-      /** \todo this does not work
-      if (!_toremove_by_solver)
+      for_( it, pool.proxy().byKindBegin(*kit), pool.proxy().byKindEnd(*kit) )
       {
-        PoolItem pi(*resit);
-        if (pi.status() == ResStatus::SOLVER)
-          _toremove_by_solver = true;
-      }*/
-      _toremove[it->first].insert( ResPair( nullptr, *resit ) );
-      _inst_size_remove += (*resit)->installSize();
+        if ( !(*it)->hasInstalledObj() )
+          continue;
+
+        PoolItem candidate = (*it)->highestAvailableVersionObj();
+
+        if ( !candidate )
+          continue;
+        if ( compareByNVRA( (*it)->installedObj(), candidate ) >= 0 )
+          continue;
+        // ignore higher versions with different arch (except noarch) bnc #646410
+        if ( (*it)->installedObj().arch() != candidate.arch()
+          && (*it)->installedObj().arch() != Arch_noarch
+          && candidate.arch() != Arch_noarch )
+          continue;
+        // mutliversion packages do not end up in _toupgrade, so we need to remove
+        // them from candidates if the candidate actually installs (bnc #629197)
+        if ( _multiInstalled.find( candidate.name() ) != _multiInstalled.end()
+          && candidate.status().isToBeInstalled() )
+          continue;
+
+        candidates[*kit].insert( candidate.satSolvable() );
+      }
+      MIL << *kit << " update candidates: " << candidates[*kit].size() << endl;
+      MIL << "to be actually updated: " << _toupgrade[*kit].size() << endl;
     }
 
-  m.elapsed();
-
-  // *** notupdated ***
-
-  // get all available updates, no matter if they are installable or break
-  // some current policy
-  KindToResPairSet candidates;
-  ResKindSet kinds;
-  kinds.insert( ResKind::package );
-  kinds.insert( ResKind::product );
-  for_( kit, kinds.begin(), kinds.end() )
-  {
-    for_( it, pool.proxy().byKindBegin(*kit), pool.proxy().byKindEnd(*kit) )
+    // compare available updates with the list of packages to be upgraded
+    //
+    // note: operator[] (kindToResPairSet[kind]) actually creates ResPairSet when
+    //       used. This avoids bnc #594282 which occurred when there was
+    //       for_(it, _toupgrade.begin(), _toupgrade.end()) loop used here and there
+    //       were no upgrades for that kind.
+    for_( kit, kinds.begin(), kinds.end() )
+      _notupdated[*kit] = ResPairSet::difference( candidates[*kit], _toupgrade[*kit] );
+
+    // remove kinds with empty sets after the set_difference
+    for ( KindToResPairSet::iterator it = _notupdated.begin(); it != _notupdated.end(); )
     {
-      if ( !(*it)->hasInstalledObj() )
-        continue;
-
-      PoolItem candidate = (*it)->highestAvailableVersionObj();
-
-      if ( !candidate )
-        continue;
-      if ( compareByNVRA( (*it)->installedObj(), candidate ) >= 0 )
-        continue;
-      // ignore higher versions with different arch (except noarch) bnc #646410
-      if ( (*it)->installedObj().arch() != candidate.arch()
-        && (*it)->installedObj().arch() != Arch_noarch
-        && candidate.arch() != Arch_noarch )
-        continue;
-      // mutliversion packages do not end up in _toupgrade, so we need to remove
-      // them from candidates if the candidate actually installs (bnc #629197)
-      if ( _multiInstalled.find( candidate.name() ) != _multiInstalled.end()
-        && candidate.status().isToBeInstalled() )
-        continue;
-
-      candidates[*kit].insert( ResPair( nullptr, candidate.resolvable() ) );
+      if (it->second.empty())
+        _notupdated.erase(it++);
+      else
+        ++it;
+    }
+    for ( KindToResPairSet::iterator it = _toupgrade.begin(); it != _toupgrade.end(); )
+    {
+      if (it->second.empty())
+        _toupgrade.erase(it++);
+      else
+        ++it;
     }
-    MIL << *kit << " update candidates: " << candidates[*kit].size() << endl;
-    MIL << "to be actually updated: " << _toupgrade[*kit].size() << endl;
-  }
-
-  // compare available updates with the list of packages to be upgraded
-  //
-  // note: operator[] (kindToResPairSet[kind]) actually creates ResPairSet when
-  //       used. This avoids bnc #594282 which occurred when there was
-  //       for_(it, _toupgrade.begin(), _toupgrade.end()) loop used here and there
-  //       were no upgrades for that kind.
-  for_( kit, kinds.begin(), kinds.end() )
-    std::set_difference( candidates[*kit].begin(), candidates[*kit].end(),
-                         _toupgrade [*kit].begin(), _toupgrade [*kit].end(),
-                         inserter( _notupdated[*kit], _notupdated[*kit].begin() ),
-                         Summary::ResPairNameCompare() );
-
-  // remove kinds with empty sets after the set_difference
-  for ( KindToResPairSet::iterator it = _notupdated.begin(); it != _notupdated.end(); )
-  {
-    if (it->second.empty())
-      _notupdated.erase(it++);
-    else
-      ++it;
-  }
-  for ( KindToResPairSet::iterator it = _toupgrade.begin(); it != _toupgrade.end(); )
-  {
-    if (it->second.empty())
-      _toupgrade.erase(it++);
-    else
-      ++it;
   }
 
-  m.stop();
+  // Weak dependencies of the objects requested by the user are collected
+  // when shown (see collectWeakDeps).
+  std::sort( _requested.begin(), _requested.end(), []( const sat::Solvable & lhs, const sat::Solvable & rhs ) { return lhs.id() < rhs.id(); } );
+  _requested.erase( std::unique( _requested.begin(), _requested.end() ), _requested.end() );
+
+  logCategory( "install", _toinstall );
+  logCategory( "upgrade", _toupgrade );
+  logCategory( "downgrade", _todowngrade );
+  logCategory( "reinstall", _toreinstall );
+  logCategory( "remove", _toremove );
+  logCategory( "change-arch", _tochangearch );
+  logCategory( "change-vendor", _tochangevendor );
+  logCategory( "notupdated", _notupdated );
 }
 
 // --------------------------------------------------------------------------
@@ -524,12 +621,12 @@ namespace
 {
   inline std::string ResPair2Name( const Summary::ResPairSet::value_type & resp_r, bool withKind_r = false )
   {
-    if ( resp_r.second->kind() == ResKind::product )
+    if ( resp_r.second.kind() == ResKind::product )
       // If two products are involved, show the old ones summary.
       // (The following product is going to be upgraded/downgraded:)
-      return resp_r.first ? resp_r.first->summary() : resp_r.second->summary();
+      return resp_r.first ? resp_r.first.summary() : resp_r.second.summary();
 
-    return( withKind_r ? resp_r.second->ident().asString() : resp_r.second->name() );
+    return( withKind_r ? resp_r.second.ident().asString() : resp_r.second.name() );
   }
 
   /** bsc#1061384: add hint if product is better updated by a different command
@@ -539,21 +636,21 @@ namespace
    *   Provides product-update() == dup
    * \endcode
    */
-  inline void addUpdateHint( TableRow & tr_r, std::list<std::string> & ctc_r, ResObject::constPtr obj_r )
+  inline void addUpdateHint( TableRow & tr_r, std::list<std::string> & ctc_r, sat::Solvable obj_r )
   {
-    if ( obj_r && obj_r->isKind<Product>() )
+    if ( obj_r && obj_r.isKind<Product>() )
     {
       // Check if buddy release package contains some update indicator provides.
       if ( Zypper::instance().command() != ZypperCommand::DIST_UPGRADE_e )
       {
         static const Capability indicator( "product-update()", Rel::EQ, "dup" );
-        if ( obj_r->asKind<Product>()->referencePackage().dep_provides().matches( indicator ) )
+        if ( make<Product>( obj_r )->referencePackage().dep_provides().matches( indicator ) )
         {
           WAR << obj_r << " provides " << indicator << endl;
           // translator: '%1%' is a products name
           //             '%2%' is a command to call (like 'zypper dup')
           //             Both may contain whitespace and should be enclosed by quotes!
-          std::string ctcmsg( str::Format( _("Product '%1%' requires to be upgraded by calling '%2%'!") ) % obj_r->summary() % DEFAULTString("zypper dup") );
+          std::string ctcmsg( str::Format( _("Product '%1%' requires to be upgraded by calling '%2%'!") ) % obj_r.summary() % DEFAULTString("zypper dup") );
           // ^^^ summary() for products like in ResPair2Name
           //     DEFAULTString to prevent the command string from being colored in MSG_WARNINGString below
           tr_r.addDetail( MSG_WARNINGString( ctcmsg ) );
@@ -612,13 +709,13 @@ bool Summary::writeResolvableList( std::ostream & out,
       if ( quote ) s << quoteCh;
 
       // version (if multiple versions are present)
-      if ( _multiInstalled.find( respair.second->name() ) != _multiInstalled.end() )
+      if ( _multiInstalled.find( respair.second.name() ) != _multiInstalled.end() )
       {
-        if ( respair.first && respair.first->edition() != respair.second->edition() )
-          s << "-" << respair.first->edition().asString()
-            << "->" << respair.second->edition().asString();
+        if ( respair.first && respair.first.edition() != respair.second.edition() )
+          s << "-" << respair.first.edition().asString()
+            << "->" << respair.second.edition().asString();
         else
-          s << "-" << respair.second->edition().asString();
+          s << "-" << respair.second.edition().asString();
       }
 
       s << " ";
@@ -652,49 +749,49 @@ bool Summary::writeResolvableList( std::ostream & out,
       continue;
 
     // version (if multiple versions are present)
-    if ( !(_viewop & SHOW_VERSION) && _multiInstalled.find( respair.second->name() ) != _multiInstalled.end() )
+    if ( !(_viewop & SHOW_VERSION) && _multiInstalled.find( respair.second.name() ) != _multiInstalled.end() )
     {
-      if ( respair.first && respair.first->edition() != respair.second->edition() )
-        name += std::string("-") + respair.first->edition().asString()
-             + "->" + respair.second->edition().asString();
+      if ( respair.first && respair.first.edition() != respair.second.edition() )
+        name += std::string("-") + respair.first.edition().asString()
+             + "->" + respair.second.edition().asString();
       else
-        name += std::string("-") + respair.second->edition().asString();
+        name += std::string("-") + respair.second.edition().asString();
     }
 
     TableRow tr;
     tr << name;
     if ( _viewop & SHOW_VERSION )
     {
-      if ( respair.first && respair.first->edition() != respair.second->edition() )
+      if ( respair.first && respair.first.edition() != respair.second.edition() )
       {
-        tr << respair.first->edition().asString() + " -> " +
-              respair.second->edition().asString();
+        tr << respair.first.edition().asString() + " -> " +
+              respair.second.edition().asString();
         // bsc#1061384: add hint if product is better updated by a different command
         addUpdateHint( tr, _ctc, respair.second );
       }
       else
-        tr << respair.second->edition().asString();
+        tr << respair.second.edition().asString();
     }
     if ( _viewop & SHOW_ARCH )
     {
-      if ( respair.first && respair.first->arch() != respair.second->arch() )
-        tr << respair.first->arch().asString() + " -> " +
-              respair.second->arch().asString();
+      if ( respair.first && respair.first.arch() != respair.second.arch() )
+        tr << respair.first.arch().asString() + " -> " +
+              respair.second.arch().asString();
       else
-        tr << respair.second->arch().asString();
+        tr << respair.second.arch().asString();
     }
     if ( _viewop & SHOW_REPO )
     {
       // we do not know about repository changes, only show the repo from
       // which the package will be installed
-      tr << respair.second->repoInfo().asUserString();
+      tr << respair.second.repoInfo().asUserString();
     }
     if ( _viewop & SHOW_VENDOR )
     {
-      if ( respair.first && ! VendorAttr::instance().equivalent( respair.first->vendor(), respair.second->vendor() ) )
-        tr << respair.first->vendor() + " -> " + respair.second->vendor();
+      if ( respair.first && ! VendorAttr::instance().equivalent( respair.first.vendor(), respair.second.vendor() ) )
+        tr << respair.first.vendor().asString() + " -> " + respair.second.vendor().asString();
       else
-        tr << respair.second->vendor();
+        tr << respair.second.vendor().asString();
     }
     t << std::move(tr);
   }
@@ -950,94 +1047,159 @@ void Summary::writeReinstalled( std::ostream & out )
 
 // --------------------------------------------------------------------------
 
-void Summary::collectInstalledRecommends( const ResObject::constPtr & obj )
+void Summary::collectWeakDeps()
 {
-  Capabilities rec = obj->dep_recommends();
-  for_( capit, rec.begin(), rec.end() )
+  if ( ( _viewop & SHOW_RECOMMENDED ) && ! _recommendsCollected )
   {
-    sat::WhatProvides q( *capit );
-    // not using selectables here: matching found resolvables against those
-    // in the _toinstall set (the ones selected by the solver)
-    for_( sit, q.begin(), q.end() )
-    {
-      if ( sit->isSystem() ) // is it necessary to have the system solvable?
-        continue;
-      if ( sit->name() == obj->name() )
-        continue; // ignore self-recommends (should not happen, though)
+    debug::Measure m( "summary recommends" );
+    collectInstalledRecommends( _requested );
+    _recommendsCollected = true;
+    logCategory( "required", _required );
+    logCategory( "recommended", _recommended );
+  }
+  if ( ( _viewop & ( SHOW_RECOMMENDED | SHOW_SUGGESTED ) ) && ! _notInstalledDepsCollected )
+  {
+    debug::Measure m( "summary not installed recommends/suggests" );
+    collectNotInstalledDeps( _requested );
+    _notInstalledDepsCollected = true;
+    logCategory( "not-installed-recommends", _noinstrec );
+    logCategory( "not-installed-suggests", _noinstsug );
+  }
+}
 
-      XXX << "rec: " << *sit << endl;
-      ResObject::constPtr recobj = makeResObject( *sit );
-      ResPairSet::const_iterator match = _toinstall[sit->kind()].find( ResPair( nullptr, recobj ) );
-      if ( match != _toinstall[sit->kind()].end() )
+// --------------------------------------------------------------------------
+
+void Summary::collectInstalledRecommends( const std::vector<sat::Solvable> & requested_r )
+{
+  // Not using selectables here: matching found solvables against those in
+  // the _toinstall set (the ones selected by the solver). The set is ordered
+  // by name and edition, so a solvable matches an entry of the same kind,
+  // name and edition. Index the entries by ident once, instead of creating a
+  // ResObject per provider just to look it up.
+  std::unordered_map<IdString::IdType, std::vector<const ResPair *>> toinstallByIdent;
+  for ( const auto & [kind, resPairs] : _toinstall )
+    for ( const ResPair & resPair : resPairs )
+      toinstallByIdent[resPair.second.ident().id()].push_back( &resPair );
+
+  auto findToInstall = [&toinstallByIdent]( const sat::Solvable & slv_r ) -> const ResPair * {
+    auto it = toinstallByIdent.find( slv_r.ident().id() );
+    if ( it != toinstallByIdent.end() )
+    {
+      for ( const ResPair * resPair : it->second )
       {
-        if ( _recommended[sit->kind()].insert( *match ).second )
-          collectInstalledRecommends( recobj );
-        break;
+        const sat::Solvable & obj { resPair->second };
+        if ( obj.kind() == slv_r.kind() && Edition::compare( obj.edition(), slv_r.edition() ) == 0 )
+          return resPair;
       }
     }
-  }
+    return nullptr;
+  };
 
-  Capabilities req = obj->dep_requires();
-  for_( capit, req.begin(), req.end() )
-  {
-    sat::WhatProvides q( *capit );
-    for_( sit, q.begin(), q.end() )
+  // Walk the deps of each solvable once. The collected sets do not depend on
+  // the order we visit the solvables in.
+  std::vector<bool> visited( sat::Pool::instance().capacity() );
+  std::vector<bool> recommended( visited.size() );	// matches in _recommended
+  std::vector<bool> required( visited.size() );		// matches in _required
+  std::vector<sat::Solvable> todo;
+  auto enqueue = [&]( const sat::Solvable & slv_r ) {
+    if ( ! visited[slv_r.id()] )
     {
-      if ( sit->isSystem() ) // is it necessary to have the system solvable?
-        continue;
-      if ( sit->name() == obj->name() )
-        continue; // ignore self-requires
-      XXX << "req: " << *sit << endl;
-      ResObject::constPtr reqobj = makeResObject( *sit );
-      ResPairSet::const_iterator match = _toinstall[sit->kind()].find( ResPair( nullptr, reqobj ) );
-      if ( match != _toinstall[sit->kind()].end() )
+      visited[slv_r.id()] = true;
+      todo.push_back( slv_r );
+    }
+  };
+
+  // collect recommends of all packages request by user
+  for ( const sat::Solvable & slv : requested_r )
+    enqueue( slv );
+
+  while ( ! todo.empty() )
+  {
+    sat::Solvable obj { todo.back() };
+    todo.pop_back();
+    const std::string & objname { obj.name() };
+
+    auto collect = [&]( const Capabilities & caps_r, KindToResPairSet & result_r, std::vector<bool> & inResult_r ) {
+      for ( const Capability & cap : caps_r )
       {
-        if ( _required[sit->kind()].insert( *match ).second )
-          collectInstalledRecommends( reqobj );
-        break;
+        for ( const sat::Solvable & sit : sat::WhatProvides( cap ) )
+        {
+          if ( sit.isSystem() ) // is it necessary to have the system solvable?
+            continue;
+          if ( sit.name() == objname )
+            continue; // ignore self-deps
+
+          XXX << "dep: " << sit << endl;
+          const ResPair * match = findToInstall( sit );
+          if ( match )
+          {
+            if ( ! inResult_r[match->second.id()] )
+            {
+              inResult_r[match->second.id()] = true;
+              result_r[sit.kind()].insert( *match );
+              enqueue( sit );
+            }
+            break;
+          }
+        }
       }
-    }
+    };
+    collect( obj.dep_recommends(), _recommended, recommended );
+    collect( obj.dep_requires(), _required, required );
   }
 }
 
 // --------------------------------------------------------------------------
 
-static void collectNotInstalledDeps( const Dep & dep, const ResObject::constPtr & obj, Summary::KindToResPairSet & result )
+void Summary::collectNotInstalledDeps( const std::vector<sat::Solvable> & requested_r )
 {
-  static std::vector<ui::Selectable::Ptr> tmp;	// reuse capacity
-  //DBG << obj << endl;
-  Capabilities req = obj->dep( dep );
-  for_( capit, req.begin(), req.end() )
-  {
-    tmp.clear();
-    sat::WhatProvides q( *capit );
-    for_( it, q.selectableBegin(), q.selectableEnd() )
+  // Many objects share the same deps; look up the providing selectables per
+  // capability just once.
+  std::unordered_map<Capability::IdType, std::vector<ui::Selectable::Ptr>> providers;
+  auto providersOf = [&providers]( const Capability & cap_r ) -> const std::vector<ui::Selectable::Ptr> & {
+    auto it = providers.find( cap_r.id() );
+    if ( it == providers.end() )
     {
-      if ( (*it)->name() == obj->name() )
-        continue;		// ignore self-deps
-
-      if ( (*it)->offSystem() )
-      {
-        if ( (*it)->toDelete() )
-          continue;		// ignore explicitly deleted
-        tmp.push_back( (*it) );	// remember uninstalled
-      }
-      else
-      {
-        // at least one of the recommendations is/gets installed: discard all
-        tmp.clear();
-        break;
-      }
+      sat::WhatProvides q( cap_r );
+      it = providers.emplace( cap_r.id(), std::vector<ui::Selectable::Ptr>( q.selectableBegin(), q.selectableEnd() ) ).first;
     }
-    if ( !tmp.empty() )
+    return it->second;
+  };
+
+  std::vector<ui::Selectable::Ptr> tmp;
+  auto collect = [&]( const sat::Solvable & obj_r, const Capabilities & caps_r, KindToResPairSet & result_r ) {
+    const std::string & objname { obj_r.name() };
+    for ( const Capability & cap : caps_r )
     {
-      // collect remembered ones
-      for_( it, tmp.begin(), tmp.end() )
+      tmp.clear();
+      for ( const ui::Selectable::Ptr & sel : providersOf( cap ) )
       {
-        //DBG << dep << " :" << (*it)->onSystem() << ": " << dump(*(*it)) << endl;
-        result[(*it)->kind()].insert( Summary::ResPair( nullptr, (*it)->candidateObj() ) );
+        if ( sel->name() == objname )
+          continue;		// ignore self-deps
+
+        if ( sel->offSystem() )
+        {
+          if ( sel->toDelete() )
+            continue;		// ignore explicitly deleted
+          tmp.push_back( sel );	// remember uninstalled
+        }
+        else
+        {
+          // at least one of the recommendations is/gets installed: discard all
+          tmp.clear();
+          break;
+        }
       }
+      // collect remembered ones
+      for ( const ui::Selectable::Ptr & sel : tmp )
+        result_r[sel->kind()].insert( sel->candidateObj().satSolvable() );
     }
+  };
+
+  for ( const sat::Solvable & obj : requested_r )
+  {
+    collect( obj, obj.dep_recommends(), _noinstrec );
+    collect( obj, obj.dep_suggests(), _noinstsug );
   }
 }
 
@@ -1045,27 +1207,6 @@ static void collectNotInstalledDeps( const Dep & dep, const ResObject::constPtr
 
 void Summary::writeRecommended( std::ostream & out )
 {
-  // lazy-compute the installed recommended objects
-  if (_recommended.empty() )
-  {
-    ResObject::constPtr obj;
-    for_( kindit, _toinstall.begin(), _toinstall.end() )
-      for_( it, kindit->second.begin(), kindit->second.end() )
-        // collect recommends of all packages request by user
-        if ( it->second->poolItem().status().getTransactByValue() != ResStatus::SOLVER )
-          collectInstalledRecommends( it->second );
-  }
-
-  // lazy-compute the not-to-be-installed recommended objects
-  if ( _noinstrec.empty() )
-  {
-    ResObject::constPtr obj;
-    for_( kindit, _toinstall.begin(), _toinstall.end() )
-      for_( it, kindit->second.begin(), kindit->second.end() )
-        if ( it->second->poolItem().status().getTransactByValue() != ResStatus::SOLVER )
-          collectNotInstalledDeps( Dep::RECOMMENDS, it->second, _noinstrec );
-  }
-
   for_( it, _recommended.begin(), _recommended.end() )
   {
     std::string label( "%d" );
@@ -1131,7 +1272,7 @@ void Summary::writeRecommended( std::ostream & out )
         }
         else    // recommended packages should be installed - but...
         {
-          if ( pair_it->second->poolItem().status().isSoftLocked() )
+          if ( PoolItem( pair_it->second ).status().isSoftLocked() )
           {
             softLocked.insert( *pair_it );
           }
@@ -1210,16 +1351,6 @@ void Summary::writeRecommended( std::ostream & out )
 
 void Summary::writeSuggested( std::ostream & out )
 {
-  if ( _noinstsug.empty() )
-  {
-    ResObject::constPtr obj;
-    for_( kindit, _toinstall.begin(), _toinstall.end() )
-      for_( it, kindit->second.begin(), kindit->second.end() )
-        // collect recommends of all packages request by user
-        if ( it->second->poolItem().status().getTransactByValue() != ResStatus::SOLVER )
-          collectNotInstalledDeps( Dep::SUGGESTS, it->second, _noinstsug );
-  }
-
   for_( it, _noinstsug.begin(), _noinstsug.end() )
   {
     std::string label( "%d" );
@@ -1439,7 +1570,7 @@ void Summary::writeSupportSuperseded( std::ostream & out )
 
       std::vector<std::pair<sat::Solvable,std::string>> itemsdetails;
       for ( const auto & pair : it->second ) {
-        Package::constPtr package = pair.second->asKind<Package>();
+        Package::constPtr package = make<Package>( pair.second );
         itemsdetails.push_back( std::make_pair( package->satSolvable(), supersedingAsString( package ) ) );
       }
       writeSolvableDetailsList( out, itemsdetails, highlightColor );
@@ -1493,9 +1624,9 @@ void Summary::writeLocked( std::ostream & out )
     {
       if ( (*it)->hasInstalledObj() )
        for_( iit, (*it)->installedBegin(), (*it)->installedEnd() )
-         instlocks.insert( ResPair( nullptr, *iit ) );
+         instlocks.insert( (*iit).satSolvable() );
       else
-       avidents.insert( ResPair( nullptr, (*it)->theObj() ) );
+       avidents.insert( (*it)->theObj().satSolvable() );
     }
   }
   if ( ! ( instlocks.empty() && avidents.empty() ) )
@@ -1792,6 +1923,7 @@ void Summary::dumpTo( std::ostream & out )
   writeUpgraded( out );
   writeDowngraded( out );
   writeReinstalled( out );
+  collectWeakDeps();
   if ( _viewop & SHOW_RECOMMENDED )
     writeRecommended( out) ;
   if ( _viewop & SHOW_SUGGESTED )
@@ -1854,27 +1986,27 @@ void Summary::writeXmlResolvableList( std::ostream & out, const KindToResPairSet
   {
     for_( pairit, it->second.begin(), it->second.end() )
     {
-      ResObject::constPtr res( pairit->second );
-      ResObject::constPtr rold( pairit->first );
+      sat::Solvable res( pairit->second );
+      sat::Solvable rold( pairit->first );
 
       out << "<solvable";
-      out << " type=\"" << res->kind() << "\"";
-      out << " name=\"" << res->name() << "\"";
-      out << " edition=\"" << res->edition() << "\"";
-      out << " arch=\"" << res->arch() << "\"";
-      out << " repository=\"" << res->repoInfo().alias() << "\"";
+      out << " type=\"" << res.kind() << "\"";
+      out << " name=\"" << res.name() << "\"";
+      out << " edition=\"" << res.edition() << "\"";
+      out << " arch=\"" << res.arch() << "\"";
+      out << " repository=\"" << res.repoInfo().alias() << "\"";
       if ( rold )
       {
-        out << " edition-old=\"" << rold->edition() << "\"";
-        out << " arch-old=\"" << rold->arch() << "\"";
+        out << " edition-old=\"" << rold.edition() << "\"";
+        out << " arch-old=\"" << rold.arch() << "\"";
       }
       {
-        const std::string & text( res->summary() );
+        const std::string & text( res.summary() );
         if ( !text.empty() )
           out << " summary=\"" << xml::escape(text) << "\"";
       }
       {
-        const std::string & text( res->description() );
+        const std::string & text( res.description() );
         if ( !text.empty() )
           out << ">\n" << "<description>" << xml::escape( text ) << "</description>" << "</solvable>" << endl;
         else
@@ -1886,6 +2018,43 @@ void Summary::writeXmlResolvableList( std::ostream & out, const KindToResPairSet
 
 // --------------------------------------------------------------------------
 
+void Summary::writeJsonResolvableList( jsonout::Array & out, const KindToResPairSet & resolvables )
+{
+  for ( const auto & kindres : resolvables )
+  {
+    for ( const auto & respair : kindres.second )
+    {
+      sat::Solvable res( respair.second );
+      sat::Solvable rold( respair.first );
+
+      jsonout::Object obj;
+      obj.add( "type", res.kind().asString() );
+      obj.add( "name", res.name() );
+      obj.add( "edition", res.edition().asString() );
+      obj.add( "arch", res.arch().asString() );
+      obj.add( "repository", res.repoInfo().alias() );
+      if ( rold )
+      {
+        obj.add( "edition-old", rold.edition().asString() );
+        obj.add( "arch-old", rold.arch().asString() );
+      }
+      {
+        const std::string & text( res.summary() );
+        if ( !text.empty() )
+          obj.add( "summary", text );
+      }
+      {
+        const std::string & text( res.description() );
+        if ( !text.empty() )
+          obj.add( "description", text );
+      }
+      out.add( obj );
+    }
+  }
+}
+
+// --------------------------------------------------------------------------
+
 void Summary::dumpAsXmlTo( std::ostream & out )
 {
   unsigned pkgchanged = _inst_pkg_total;
@@ -1963,3 +2132,44 @@ void Summary::dumpAsXmlTo( std::ostream & out )
 
   out << "</install-summary>" << endl;
 }
+
+// --------------------------------------------------------------------------
+
+void Summary::dumpAsJsonTo( std::ostream & out )
+{
+  // Same content as dumpAsXmlTo, the lists are arrays of solvable objects
+  unsigned pkgchanged = _inst_pkg_total;
+  const auto & iter = _toremove.find( ResKind::package );
+  if ( iter != _toremove.end() )
+    pkgchanged += iter->second.size();
+  zypp::ByteCount _inst_size_change = _inst_size_install - _inst_size_remove;
+
+  jsonout::Object event;
+  event.add( "event", "install-summary" );
+  event.add( "download-size", (ByteCount::SizeType)_todownload );
+  event.add( "space-usage-diff", (ByteCount::SizeType)_inst_size_change );
+  event.add( "space-usage-installed", (ByteCount::SizeType)_inst_size_install );
+  event.add( "space-usage-removed", (ByteCount::SizeType)_inst_size_remove );
+  event.add( "packages-to-change", pkgchanged );
+  event.add( "need-restart", showNeedRestartHint() );
+  event.add( "need-reboot", showNeedRebootHInt() );
+
+  auto addList = [&]( const char * name_r, std::initializer_list<const KindToResPairSet *> lists_r ) {
+    jsonout::Array list;
+    for ( const KindToResPairSet * resolvables : lists_r )
+      writeJsonResolvableList( list, *resolvables );
+    if ( ! list.empty() )
+      event.addRaw( name_r, list.str() );
+  };
+  addList( "to-upgrade",	{ &_toupgrade } );
+  addList( "to-downgrade",	{ &_todowngrade } );
+  addList( "to-install",	{ &_toinstall } );
+  addList( "to-reinstall",	{ &_toreinstall } );
+  addList( "to-remove",		{ &_toremove } );
+  addList( "to-change-arch",	{ &_tochangearch } );
+  addList( "to-change-vendor",	{ &_tochangevendor } );
+  if ( _viewop & SHOW_UNSUPPORTED )
+    addList( "unsupported",	{ &_supportUnknown, &_supportUnsupported } );
+
+  out << event.str() << endl;
+}
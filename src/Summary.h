@@ -11,14 +11,19 @@
 #include <set>
 #include <map>
 #include <iosfwd>
+#include <string>
+#include <vector>
 
 #include <zypp-core/base/PtrTypes.h>
 #include <zypp-core/ByteCount.h>
 #include <zypp-core/base/DefaultIntegral>
 #include <zypp/ResObject.h>
 #include <zypp/ResPool.h>
+#include <zypp/sat/Solvable.h>
 #include "utils/ansi.h"
 
+namespace jsonout { class Array; }
+
 /// \brief Information collected in SolveAndCommit which is to be shown in the summary.
 struct SummaryHints
 {
@@ -39,16 +44,65 @@ class Summary : private zypp::base::NonCopyable
 {
 public:
   /**
-   * \brief ResPair is used to track removed and installed ResObjects.
+   * \brief ResPair is used to track removed and installed solvables.
    *        usually only 'second' is intialized, the 'first' var is only
    *        required to track upgrades, first is the removed and second the installed package
    */
-  typedef std::pair<zypp::ResObject::constPtr, zypp::ResObject::constPtr> ResPair;
-  struct ResPairNameCompare
+  typedef std::pair<zypp::sat::Solvable, zypp::sat::Solvable> ResPair;
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class ResPairSet
+  /// \brief ResPairs ordered by name (according to the locale) and edition.
+  ///
+  /// Behaves like a \c std::set comparing the names via \c strcoll, but the
+  /// entries are just appended to a vector and sorted on the first read
+  /// access. The collation keys are built once per entry. Of equivalent
+  /// entries the one inserted first is kept.
+  class ResPairSet
   {
-    inline bool operator()( const ResPair & p1, const ResPair & p2 ) const;
+  public:
+    typedef ResPair value_type;
+    typedef std::vector<ResPair>::const_iterator const_iterator;
+
+    void insert( const ResPair & pair_r )
+    { _pairs.push_back( pair_r ); _sorted = false; }
+
+    /** Insert \a slv_r as ResPair without 'first'. */
+    void insert( zypp::sat::Solvable slv_r )
+    { insert( ResPair( zypp::sat::Solvable(), slv_r ) ); }
+
+    bool empty() const
+    { return _pairs.empty(); }
+
+    size_t size() const
+    { sort(); return _pairs.size(); }
+
+    const_iterator begin() const
+    { sort(); return _pairs.begin(); }
+
+    const_iterator end() const
+    { sort(); return _pairs.end(); }
+
+    void clear()
+    { _pairs.clear(); _keys.clear(); _sorted = true; }
+
+    /** The entries of \a lhs_r which are not in \a rhs_r. */
+    static ResPairSet difference( const ResPairSet & lhs_r, const ResPairSet & rhs_r );
+
+  private:
+    void sort() const
+    { if ( ! _sorted ) doSort(); }
+
+    void doSort() const;
+
+    /** Compare entry \a lidx_r of \a lhs_r and \a ridx_r of \a rhs_r (both sorted). */
+    static int compare( const ResPairSet & lhs_r, size_t lidx_r, const ResPairSet & rhs_r, size_t ridx_r );
+
+  private:
+    mutable std::vector<ResPair> _pairs;
+    mutable std::vector<std::string> _keys;	///< collation keys of the sorted entries names
+    mutable bool _sorted = true;
   };
-  typedef std::set<ResPair, ResPairNameCompare> ResPairSet;
   typedef std::map<zypp::ResKind, ResPairSet> KindToResPairSet;
 
   enum _view_options
@@ -128,6 +182,8 @@ public:
 
   void dumpTo( std::ostream & out );
   void dumpAsXmlTo( std::ostream & out );
+  /** The \c install-summary event for \c --jsonout (one line). */
+  void dumpAsJsonTo( std::ostream & out );
 
 private:
   void readPool( const zypp::ResPool & pool );
@@ -137,8 +193,15 @@ private:
   { return writeResolvableList( out, resolvables, ansi::Color::nocolor(), maxEntries_r, withKind_r ); }
 
   void writeXmlResolvableList( std::ostream & out, const KindToResPairSet & resolvables );
+  void writeJsonResolvableList( jsonout::Array & out, const KindToResPairSet & resolvables );
 
-  void collectInstalledRecommends( const zypp::ResObject::constPtr & obj );
+  /** Collect the weak deps the current \ref ViewOptions show (\c SHOW_RECOMMENDED,
+   * \c SHOW_SUGGESTED), unless done before. */
+  void collectWeakDeps();
+  /** Collect the installed recommends and requires of the objects the user asked to install. */
+  void collectInstalledRecommends( const std::vector<zypp::sat::Solvable> & requested_r );
+  /** Collect the recommends and suggests of the objects the user asked to install, which will not be installed. */
+  void collectNotInstalledDeps( const std::vector<zypp::sat::Solvable> & requested_r );
 
   bool showNeedRestartHint() const;
   bool showNeedRebootHInt() const;
@@ -190,8 +253,12 @@ private:
 
 
   /** \name For weak deps info.
+   * Collected on demand by \ref collectWeakDeps.
    * @{
    */
+  std::vector<zypp::sat::Solvable> _requested;	///< new installs on behalf of the user (sorted, unique)
+  bool _recommendsCollected = false;
+  bool _notInstalledDepsCollected = false;
   KindToResPairSet _required;
   KindToResPairSet _recommended;
   //! recommended but not to be installed
@@ -43,6 +43,7 @@
 #include "Table.h"
 #include "utils/text.h"
 #include "output/OutNormal.h"
+#include "output/OutJSON.h"
 
 #include "utils/misc.h"
 #include "utils/messages.h"
@@ -252,6 +253,32 @@ int Zypper::main( int argc, char ** argv )
   return exitCode();
 }
 
+int Zypper::serverMain( int argc, char ** argv, const std::function<bool()> & accept_r )
+{
+  _argc = argc;
+  _argv = argv;
+
+  try {
+    _commandArgOffset = processGlobalOptions();
+    if ( _commandArgOffset >= argc || _config.wantHelp )
+      return -1;
+    setCommand( ZypperCommand( argv[_commandArgOffset] ) );
+  }
+  catch ( const Exception & ex )
+  {
+    // Let the client run it and report the error.
+    ZYPP_CAUGHT( ex );
+    return -1;
+  }
+
+  _serverAccept = accept_r;
+  doCommand( argc, argv, _commandArgOffset );
+  _serverAccept = nullptr;
+  if ( ! _serverAccepted )
+    return -1;	// refused, or failed before all options were parsed
+  return exitCode() ? exitCode() : exitInfoCode();
+}
+
 Out & Zypper::out()
 {
     // PENDING SigINT? Some frequently called place to avoid exiting from within the signal handler?
@@ -401,6 +428,7 @@ void Zypper::commandShell()
   //will be reset by ShellQuitCmd
   _continue_running_shell = true;
   int lastExitCode = ZYPPER_EXIT_OK;
+  std::string reposStamp { repos_change_stamp( *this ) };
   while ( _continue_running_shell )
   {
     // read a line
@@ -421,8 +449,22 @@ void Zypper::commandShell()
 
     try
     {
-      MIL << "Reloading..." << endl;
-      God->target()->reload();   // reload system in case rpm database has changed
+      // Reload only what changed since the last command (also by other processes).
+      if ( std::string stamp { repos_change_stamp( *this ) }; stamp != reposStamp )
+      {
+        reposStamp = stamp;
+        _rm.reset();
+        if ( repos_changed_since_load( *this ) )
+        {
+          MIL << "Repositories changed: reloading them on demand" << endl;
+          unload_repos( *this );
+        }
+      }
+      if ( target_changed_since_load( *this ) )
+      {
+        MIL << "rpm database changed: reloading target" << endl;
+        load_target_resolvables( *this );
+      }
       doCommand( args.argc(), args.argv(), 0 );
     }
     catch ( const Exception & e )
@@ -480,14 +522,10 @@ void Zypper::shellCleanup()
   _rdata.solve_with_update = false;
   _rdata.plain_patch_command = false;
 
-  // cause the RepoManager to be reinitialized
-  _rm.reset();
-
-  // TODO:
-  // _rdata.repos re-read after repo operations or modify/remove these very repoinfos
-  // _rdata.repo_resolvables re-read only after certain repo operations (all?)
-  // _rdata.target_resolvables re-read only after installation/removal/update
-  // call target commit refresh pool after installation/removal/update (#328855)
+  // The RepoManager, _rdata.repos and the pool are kept. commandShell
+  // reloads them before the next command if repo definitions, caches or
+  // the rpm database changed. After a commit the pool is already synced
+  // (#328855, ZYppCommitPolicy::syncPoolAfterCommit).
 }
 
 
@@ -608,6 +646,41 @@ void Zypper::doCommand( int cmdArgc, char **cmdArgv, int firstFlag )
       _config.plusContentFromCLI.clear();
     }
 
+    // JSON output is implemented for some commands only; the others
+    // would write plain text tables and lists the consumer can't parse.
+    if ( OutJSON::typeJSON( out() ) )
+    {
+      switch ( command().toEnum() )
+      {
+        case ZypperCommand::REFRESH_e:
+        case ZypperCommand::REFRESH_SERVICES_e:
+        case ZypperCommand::INSTALL_e:
+        case ZypperCommand::REMOVE_e:
+        case ZypperCommand::REMOVE_PTF_e:
+        case ZypperCommand::SRC_INSTALL_e:
+        case ZypperCommand::VERIFY_e:
+        case ZypperCommand::INSTALL_NEW_RECOMMENDS_e:
+        case ZypperCommand::UPDATE_e:
+        case ZypperCommand::PATCH_e:
+        case ZypperCommand::DIST_UPGRADE_e:
+        case ZypperCommand::SEARCH_e:
+        case ZypperCommand::ADD_LOCK_e:
+        case ZypperCommand::REMOVE_LOCK_e:
+        case ZypperCommand::CLEAN_LOCKS_e:
+        case ZypperCommand::DOWNLOAD_e:
+        case ZypperCommand::PURGE_KERNELS_e:
+        case ZypperCommand::ADD_LOCALE_e:
+        case ZypperCommand::REMOVE_LOCALE_e:
+          break;
+
+        default:
+          // TranslatorExplanation %1% is "--jsonout", %2% a zypper command
+          out().error( str::Format(_("The %1% option is not supported by the '%2%' command.")) % "--jsonout" % command().asString() );
+          setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+          return;
+      }
+    }
+
     // === process command ===
 
     MIL << "Going to process command " << command() << endl;
@@ -657,6 +730,14 @@ void Zypper::doCommand( int cmdArgc, char **cmdArgv, int firstFlag )
         return;
       }
 
+      // zypper server: all options are known now (\ref serverMain)
+      if ( _serverAccept )
+      {
+        if ( ! _serverAccept() )
+          return;
+        _serverAccepted = true;
+      }
+
       // === ZYpp lock ===
       // bsc#1223766:
       // Delay assertZYppPtrGod until command options are parsed.
@@ -681,6 +762,7 @@ void Zypper::doCommand( int cmdArgc, char **cmdArgv, int firstFlag )
             if ( roh != NULL && roh[0] == '1' )
               zypp_readonly_hack::IWantIt ();
             else if ( command() == ZypperCommand::LIST_REPOS
+              || command() == ZypperCommand::SERVER
               || command() == ZypperCommand::LIST_SERVICES
               || command() == ZypperCommand::HELP
               || command() == ZypperCommand::VERSION_CMP
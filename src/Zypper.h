@@ -8,6 +8,7 @@
 #ifndef ZYPPER_H
 #define ZYPPER_H
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -136,6 +137,14 @@ public:
 
   int main( int argc, char ** argv );
 
+  /** Run a request forwarded to `zypper server` (in the servers forked child).
+   * Like \ref main, but once the global and command options are parsed,
+   * \a accept_r is asked whether the command may be served. If not, \c -1
+   * is returned without executing it, so the client can run it on its own.
+   * The caller resets config and output to the defaults before.
+   */
+  int serverMain( int argc, char ** argv, const std::function<bool()> & accept_r );
+
   // setters & getters
   Out & out() override;
 
@@ -148,6 +157,9 @@ public:
   void initRepoManager()
   { _rm = RepoManagerWrapper( _config.rm_options ); }
 
+  bool haveRepoManager() const
+  { return bool(_rm); }
+
   RepoManager & repoManager()
   { if ( !_rm ) initRepoManager(); return _rm->get(); }
 
@@ -250,6 +262,9 @@ private:
 
   RuntimeData _rdata;
 
+  std::function<bool()> _serverAccept;	///< \ref serverMain: asked after the command options are parsed
+  bool _serverAccepted = false;
+
 private:
   // Many commands allow a repository argument to be specified by a number.
   // In \ref match_repo the arguments are evaluated and numbers are mapped
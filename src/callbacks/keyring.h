@@ -18,6 +18,7 @@
 #include <zypp/Digest.h>
 
 #include "Zypper.h"
+#include "output/OutJSON.h"
 #include "utils/prompt.h"
 #include "Table.h"
 
@@ -62,6 +63,21 @@ namespace zypp
     std::ostream & dumpKeyInfo( std::ostream & str, const PublicKeyData & key, const KeyContext & context = KeyContext() )
     {
       Zypper & zypper = Zypper::instance();
+      if ( OutJSON::typeJSON( zypper.out() ) )
+      {
+        // An event of its own; nothing is written to str.
+        jsonout::Object event;
+        if ( !context.empty() )
+          event.add( "repository", context.repoInfo().asUserString() );
+        event.add( "key-name", key.name() )
+             .add( "key-fingerprint", key.fingerprint() )
+             .add( "key-algorithm", key.algoName() )
+             .add( "key-created", Date::ValueType(key.created()) )
+             .add( "key-expires", Date::ValueType(key.expires()) )
+             .add( "rpm-name", key.rpmName() );
+        OutJSON::writeEvent( "gpgkey-info", event );
+        return str;
+      }
       if ( zypper.out().type() == Out::TYPE_XML )
       {
         {
@@ -121,7 +137,10 @@ namespace zypp
         if ( keyData_r.expired() )
         {
           Zypper::instance().out().warning( str::Format(_("The gpg key signing file '%1%' has expired.")) % file_r );
-          dumpKeyInfo( (std::ostream&)ColorStream(std::cout,ColorContext::MSG_WARNING), keyData_r, context );
+          if ( OutJSON::typeJSON( Zypper::instance().out() ) )
+            dumpKeyInfo( std::cout, keyData_r, context );
+          else
+            dumpKeyInfo( (std::ostream&)ColorStream(std::cout,ColorContext::MSG_WARNING), keyData_r, context );
         }
         else if ( keyData_r.daysToLive() < 15 )
         {
@@ -474,7 +493,10 @@ namespace zypp
         auto newTag { HIGHLIGHTString(_("New:") ) };
         for ( const auto & kd : keyDataList ) {
           zypper.out().gap();
-          dumpKeyInfo( std::cout << "  " << newTag << endl, kd );
+          if ( OutJSON::typeJSON( zypper.out() ) )
+            dumpKeyInfo( std::cout, kd );
+          else
+            dumpKeyInfo( std::cout << "  " << newTag << endl, kd );
         }
 
         zypper.out().par( 2,HIGHLIGHTString(_("The repository metadata introducing the new keys have been signed and validated by the trusted key:")) );
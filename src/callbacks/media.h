@@ -215,6 +215,12 @@ namespace ZmartRecipients
       if ( userData.haskey("dbps_current") )
         outstr << " (" << zypp::ByteCount( userData.get<double>("dbps_current") ) << "/s)";
       outstr << ']';
+      if ( userData.haskey("packagesTotal") )	// pipelined commit: show the installers progress as well
+        // translators: %1% is the number of packages downloaded ahead, %2% the one being installed, %3% the total
+        outstr << " " << str::Format(_("%1% prefetched, installing %2%/%3%"))
+                         % userData.get<unsigned>("packagesPrefetched")
+                         % userData.get<unsigned>("packagesInstalling")
+                         % userData.get<unsigned>("packagesTotal");
 
       _lastProgressString = outstr;
       _lastProgressVal    = value;
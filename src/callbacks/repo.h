@@ -19,6 +19,7 @@
 #include "Zypper.h"
 #include "utils/prompt.h"
 #include "utils/misc.h"
+#include "CommitPrefetcher.h"
 
 ///////////////////////////////////////////////////////////////////
 namespace ZmartRecipients
@@ -118,6 +119,7 @@ struct DownloadResolvableReportReceiver : public callback::ReceiveReport<repo::D
   virtual void infoInCache( Resolvable::constPtr res_r, const Pathname & localfile_r )
   {
     Zypper & zypper = Zypper::instance();
+    CommitPrefetcher::providing( res_r );
 
     TermLine outstr( TermLine::SF_SPLIT | TermLine::SF_EXPAND );
     outstr.lhs << str::Format(_("In cache %1%")) % localfile_r.basename();
@@ -134,6 +136,7 @@ struct DownloadResolvableReportReceiver : public callback::ReceiveReport<repo::D
     _resolvable_ptr =  resolvable_ptr;
     _url = url;
     Zypper & zypper = Zypper::instance();
+    CommitPrefetcher::providing( resolvable_ptr );
 
     TermLine outstr( TermLine::SF_SPLIT | TermLine::SF_EXPAND );
     outstr.lhs << _("Retrieving:") << " " << _resolvable_ptr-> asUserString();
@@ -23,7 +23,9 @@
 #include <zypp/Patch.h>
 
 #include "Zypper.h"
+#include "CommitPrefetcher.h"
 #include "output/prompt.h"
+#include "output/OutJSON.h"
 #include "global-settings.h"
 #include "utils/prompt.h"
 
@@ -194,12 +196,31 @@ struct PatchScriptReportReceiver : public callback::ReceiveReport<target::PatchS
 {
   std::string _label;
   scoped_ptr<Out::XmlNode> _guard;	// guard script output if Out::TYPE_XML
+  scoped_ptr<std::ostringstream> _json;	// collect script output if OutJSON
 
   void closeNode()
-  { if ( _guard ) _guard.reset(); }
+  {
+    if ( _guard ) _guard.reset();
+    writeJson();
+  }
+
+  /** Write the collected script output as message event. */
+  void writeJson()
+  {
+    if ( _json && ! _json->str().empty() )
+    {
+      std::string text { _json->str() };
+      if ( text.back() == '\n' )
+        text.pop_back();
+      Zypper::instance().out().info( text );
+      _json->str( std::string() );
+    }
+  }
 
   std::ostream & printOut( const std::string & output_r )
   {
+    if ( _json )
+      return *_json << output_r;
     if ( _guard )
       std::cout << xml::escape( output_r );
     else
@@ -214,10 +235,13 @@ struct PatchScriptReportReceiver : public callback::ReceiveReport<target::PatchS
     Zypper & zypper = Zypper::instance();
     if ( zypper.out().type() == Out::TYPE_XML )
       _guard.reset( new Out::XmlNode( zypper.out(), "message", { "type", "info" } ) );
+    else if ( OutJSON::typeJSON( zypper.out() ) )
+      _json.reset( new std::ostringstream );
 
     // TranslatorExplanation speaking of a script - "Running: script file name (package name, script dir)"
     _label = str::Format(_("Running: %s  (%s, %s)")) % path_r.basename() % package->name() % path_r.dirname();
     printOut( _label ) << std::endl;
+    writeJson();
   }
 
   /**
@@ -229,7 +253,16 @@ struct PatchScriptReportReceiver : public callback::ReceiveReport<target::PatchS
   {
     Zypper & zypper = Zypper::instance();
     static bool was_ping_before = false;
-    if (kind == PING)
+    if ( _json )
+    {
+      // one message event per output chunk, no still-alive dots
+      if ( kind != PING )
+      {
+        printOut( output );
+        writeJson();
+      }
+    }
+    else if (kind == PING)
     {
       std::cout << "." << std::flush;
       was_ping_before = true;
@@ -414,6 +447,9 @@ struct InstallResolvableReportReceiver : public callback::ReceiveReport<target::
     if ( error != NO_ERROR )
       // don't write to output, the error should have been reported in problem() (bnc #381203)
       Zypper::instance().setExitCode(ZYPPER_EXIT_ERR_ZYPP);
+
+    // --download pipelined: the next package is retrieved now
+    CommitPrefetcher::installed();
   }
 
   void report( const UserData & userData_r ) override
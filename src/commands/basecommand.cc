@@ -162,8 +162,11 @@ int ZypperBaseCommand::defaultSystemSetup( Zypper &zypper, SetupSystemFlags flag
 {
   DBG << "FLAGS:" << flags_r << endl;
 
-  if ( flags_r.testFlag( ResetRepoManager ) )
-    zypper.initRepoManager();
+  if ( flags_r.testFlag( ResetRepoManager ) ) {
+    // zypper shell keeps the RepoManager until the repos change.
+    if ( ! ( zypper.runningShell() && zypper.haveRepoManager() ) )
+      zypper.initRepoManager();
+  }
 
   if ( flags_r.testFlag( InitTarget ) ) {
     init_target( zypper );
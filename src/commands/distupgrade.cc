@@ -96,6 +96,6 @@ int DistUpgradeCmd::execute( Zypper &zypper, const std::vector<std::string> &pos
     viewOpts = ( Summary::ViewOptions ) ( viewOpts | Summary::ViewOptions::DETAILS );
   }
 
-  solve_and_commit( zypper, SolveAndCommitPolicy( ).summaryOptions( viewOpts ).downloadMode( _downloadModeOpts.mode() ) );
+  solve_and_commit( zypper, SolveAndCommitPolicy( ).summaryOptions( viewOpts ).downloadMode( _downloadModeOpts.mode() ).pipelinedDownload( _downloadModeOpts.pipelined() ) );
   return zypper.exitCode();
 }
@@ -295,7 +295,7 @@ int InstallCmd::execute( Zypper &zypper, const std::vector<std::string> &positio
     opts = static_cast<Summary::ViewOptions>( opts | Summary::DETAILS );
 
   //do solve
-  auto policy = SolveAndCommitPolicy( ).summaryOptions( opts ).downloadMode( _downloadMode.mode() );
+  auto policy = SolveAndCommitPolicy( ).summaryOptions( opts ).downloadMode( _downloadMode.mode() ).pipelinedDownload( _downloadMode.pipelined() );
   policy.zyppCommitPolicy().allowDowngrade( _oldPackage );
   solve_and_commit( zypper, policy );
 
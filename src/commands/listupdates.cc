@@ -34,6 +34,10 @@ zypp::ZyppFlags::CommandGroup ListUpdatesCmd::cmdOptions() const
           // translators: -a, --all
           _("List all packages for which newer versions are available, regardless whether they are installable or not.")
     },
+    { "candidates-only", '\0', ZyppFlags::NoArgument, ZyppFlags::BoolType( &that._candidatesOnly, ZyppFlags::StoreTrue, _candidatesOnly ),
+          // translators: --candidates-only
+          _("List the best update candidate (keeping the vendor) of each installed package without running the solver. Faster, but the updates are not checked for installability.")
+    },
     { "filter-version-change", '\0', ZyppFlags::RequiredArgument,
       ZyppFlags::Value(
         []() -> boost::optional<std::string> { return std::string("none"); },
@@ -60,6 +64,7 @@ void ListUpdatesCmd::doReset()
   _kinds.clear();
   _all = false;
   _bestEffort = false;
+  _candidatesOnly = false;
   _vcFilter = VCF_None;
 }
 
@@ -78,6 +83,7 @@ int ListUpdatesCmd::execute( Zypper &zypper, const std::vector<std::string> &pos
   if ( code != ZYPPER_EXIT_OK )
     return code;
 
-  list_updates( zypper, _kinds, _bestEffort, _all, PatchSelector(), _vcFilter );
+  list_updates( zypper, _kinds, _bestEffort, _all, PatchSelector(), _vcFilter,
+                _candidatesOnly ? UpdateMode::Candidates : UpdateMode::Solver );
   return zypper.exitCode();
 }
@@ -24,6 +24,7 @@ private:
   std::set<ResKind> _kinds;
   bool _all = false;
   bool _bestEffort = false;
+  bool _candidatesOnly = false;
   VersionChangeFilter _vcFilter = VCF_None;
   InitReposOptionSet _initReposOpts { *this };
   SolverInstallsOptionSet _solverOpts { *this };
@@ -112,8 +112,10 @@ namespace
           target.setMode( DownloadInHeaps );
         else if (*in == "as-needed")
           target.setMode( DownloadAsNeeded );
+        else if (*in == "pipelined")
+          target.setPipelined();
         else {
-          ZYPP_THROW( ZyppFlags::InvalidValueException( opt.name, *in, str::form(_("Available download modes: %s"), "only, in-advance, in-heaps, as-needed") ) );
+          ZYPP_THROW( ZyppFlags::InvalidValueException( opt.name, *in, str::form(_("Available download modes: %s"), "only, in-advance, in-heaps, as-needed, pipelined") ) );
         }
         return;
       },
@@ -122,17 +124,20 @@ namespace
   }
 
   //A flag type that directly writes the DownloadMode variable
-  ZyppFlags::Value DownloadModeNoArgType( DownloadOptionSet &target, DownloadMode setFlag ) {
+  ZyppFlags::Value DownloadModeNoArgType( DownloadOptionSet &target, DownloadMode setFlag, bool pipelined = false ) {
     return ZyppFlags::Value (
       ZyppFlags::noDefaultValue,
-      [ &target, setFlag ]( const ZyppFlags::CommandOption &opt, const boost::optional<std::string> & ){
+      [ &target, setFlag, pipelined ]( const ZyppFlags::CommandOption &opt, const boost::optional<std::string> & ){
 
         if ( target.wasSetBefore() ) {
           Zypper::instance().out().warning(
             str::form( overrideWarning().c_str(), opt.name.c_str() ) );
         }
 
-        target.setMode( setFlag );
+        if ( pipelined )
+          target.setPipelined();
+        else
+          target.setMode( setFlag );
         return;
       }
     );
@@ -150,7 +155,7 @@ zypp::DownloadMode DownloadOptionSet::mode() const
   if      (_mode == DownloadInAdvance) MIL << "in-advance";
   else if (_mode == DownloadInHeaps)   MIL << "in-heaps";
   else if (_mode == DownloadOnly)      MIL << "only";
-  else if (_mode == DownloadAsNeeded)  MIL << "as-needed";
+  else if (_mode == DownloadAsNeeded)  MIL << ( _pipelined ? "pipelined" : "as-needed" );
   else                                 MIL << "UNKNOWN";
   MIL << (_mode == ZConfig::instance().commit_downloadMode() ? " (zconfig value)" : "") << endl;
 
@@ -160,9 +165,21 @@ zypp::DownloadMode DownloadOptionSet::mode() const
 void DownloadOptionSet::setMode(const zypp::DownloadMode &mode)
 {
   _mode = mode;
+  _pipelined = false;
   _wasSetBefore = true;
 }
 
+bool DownloadOptionSet::pipelined() const
+{
+  return _pipelined;
+}
+
+void DownloadOptionSet::setPipelined()
+{
+  setMode( DownloadAsNeeded );
+  _pipelined = true;
+}
+
 bool DownloadOptionSet::wasSetBefore() const
 {
   return _wasSetBefore;
@@ -175,7 +192,7 @@ std::vector<ZyppFlags::CommandGroup> DownloadOptionSet::options()
   return {{{
         { "download", '\0', ZyppFlags::RequiredArgument | ZyppFlags::Repeatable, DownloadModeArgType( *this, _mode ),
               // translators: --download
-              str::Format(_("Set the download-install mode. Available modes: %s") ) % "only, in-advance, in-heaps, as-needed"
+              str::Format(_("Set the download-install mode. Available modes: %s") ) % "only, in-advance, in-heaps, as-needed, pipelined"
         },
         { "download-only", _cmdMode == DownloadOptionSet::Default ? 'd' : '\0', ZyppFlags::NoArgument | ZyppFlags::Repeatable, DownloadModeNoArgType( *this, DownloadMode::DownloadOnly ),
               // translators: -d, --download-only
@@ -183,13 +200,15 @@ std::vector<ZyppFlags::CommandGroup> DownloadOptionSet::options()
         },
         { "download-in-advance", '\0', ZyppFlags::NoArgument | ZyppFlags::Repeatable | ZyppFlags::Hidden, DownloadModeNoArgType( *this, DownloadMode::DownloadInAdvance ), "" },
         { "download-in-heaps",   '\0', ZyppFlags::NoArgument | ZyppFlags::Repeatable | ZyppFlags::Hidden, DownloadModeNoArgType( *this, DownloadMode::DownloadInHeaps ), "" },
-        { "download-as-needed",  '\0', ZyppFlags::NoArgument | ZyppFlags::Repeatable | ZyppFlags::Hidden, DownloadModeNoArgType( *this, DownloadMode::DownloadAsNeeded ), "" }
+        { "download-as-needed",  '\0', ZyppFlags::NoArgument | ZyppFlags::Repeatable | ZyppFlags::Hidden, DownloadModeNoArgType( *this, DownloadMode::DownloadAsNeeded ), "" },
+        { "download-pipelined",  '\0', ZyppFlags::NoArgument | ZyppFlags::Repeatable | ZyppFlags::Hidden, DownloadModeNoArgType( *this, DownloadMode::DownloadAsNeeded, /*pipelined*/true ), "" }
   }}};
 }
 
 void DownloadOptionSet::reset()
 {
   _mode = ZConfig::instance().commit_downloadMode();
+  _pipelined = false;
   _wasSetBefore = false;
 }
 
@@ -68,8 +68,13 @@ public:
   void setMode( const zypp::DownloadMode &mode );
   bool wasSetBefore () const;
 
+  /** Whether \c pipelined was requested: \c DownloadAsNeeded with packages prefetched ahead of the installer. */
+  bool pipelined() const;
+  void setPipelined();
+
 private:
   zypp::DownloadMode _mode;
+  bool _pipelined = false;
   bool _wasSetBefore = false;
   Mode _cmdMode = Default;
 
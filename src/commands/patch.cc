@@ -126,6 +126,7 @@ int PatchCmd::execute( Zypper &zypper, const std::vector<std::string> &positiona
   SolveAndCommitPolicy p;
   p.summaryOptions( viewOpts );
   p.downloadMode( _downloadModeOpts.mode() );
+  p.pipelinedDownload( _downloadModeOpts.pipelined() );
   p.skipNotApplicablePatches( _skipNotApplicablePatches );
   solve_and_commit( zypper, std::move(p) );
 
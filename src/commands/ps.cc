@@ -16,6 +16,7 @@
 #include "Table.h"
 #include "utils/messages.h"
 #include "utils/flags/flagtypes.h"
+#include "utils/DeletedFilesScan.h"
 #include "commands/needs-rebooting.h"
 
 using namespace zypp;
@@ -61,11 +62,24 @@ void PSCommand::doReset()
   _format.clear();
 }
 
-inline void loadData( CheckAccessDeleted & checker_r )
+/** The processes using deleted files.
+ * Scanned by \ref DeletedFilesScan, unless a \a debugFile_r is requested. It receives
+ * the raw \c lsof output, so the check is then done by libzypp's \c CheckAccessDeleted.
+ */
+inline std::vector<CheckAccessDeleted::ProcInfo> loadData( const std::string & debugFile_r = std::string() )
 {
   try
   {
-    checker_r.check();
+    if ( debugFile_r.empty() )
+    {
+      DeletedFilesScan checker;
+      return { checker.begin(), checker.end() };
+    }
+
+    CheckAccessDeleted checker( false );	// wait for explicit call to check()
+    checker.setDebugOutputFile( debugFile_r );
+    checker.check();
+    return { checker.begin(), checker.end() };
   }
   catch ( const Exception & ex )
   {
@@ -75,8 +89,7 @@ inline void loadData( CheckAccessDeleted & checker_r )
 
 void PSCommand::printServiceNamesOnly()
 {
-  CheckAccessDeleted checker( false );	// wait for explicit call to check()
-  loadData( checker );
+  const std::vector<CheckAccessDeleted::ProcInfo> & checker { loadData() };
 
   std::set<std::string> services;
   for ( const auto & procInfo : checker )
@@ -125,12 +138,7 @@ int PSCommand::execute( Zypper &zypper, const std::vector<std::string> &position
 
   // Here: Table output
   zypper.out().info(_("Checking for running processes using deleted libraries..."), Out::HIGH );
-  CheckAccessDeleted checker( false );	// wait for explicit call to check()
-
-  if(debugEnabled())
-    checker.setDebugOutputFile(_debugFile);
-
-  loadData( checker );
+  const std::vector<CheckAccessDeleted::ProcInfo> & checker { loadData( _debugFile ) };
 
   Table t;
   bool tableWithFiles = tableWithFilesEnabled();
@@ -4,6 +4,7 @@
 #include "Table.h"
 #include "utils/messages.h"
 #include "utils/flags/flagtypes.h"
+#include "output/OutXML.h"
 
 #include <zypp/RepoManager.h>
 
@@ -29,6 +30,7 @@ void print_repos_to( const std::list<RepoInfo> & repos, std::ostream & out )
 /** Repo list as xml */
 void print_xml_repo_list( Zypper & zypper, std::list<RepoInfo> repos )
 {
+  OutXML::sync( zypper.out() );
   cout << "<repo-list>" << endl;
   for_( it, repos.begin(), repos.end() )
     it->dumpAsXmlOn( cout );
@@ -4,6 +4,10 @@
                          /__|\_, | .__/ .__/\___|_|
                              |__/|_|  |_|
 \*---------------------------------------------------------------------------*/
+#include <unistd.h>
+
+#include <zypp/ZYppCallbacks.h>
+
 #include "refresh.h"
 #include "repos.h"
 #include "commands/conditions.h"
@@ -12,6 +16,7 @@
 
 #include "utils/messages.h"
 #include "utils/flags/flagtypes.h"
+#include "utils/WorkerPool.h"
 #include "Zypper.h"
 
 using namespace zypp;
@@ -24,29 +29,49 @@ namespace {
   // prolonged, the update repo may contain it and zypp updates the trusted key on the fly
   // when refreshing it. This avoids a 'key has expired' warning being issued when refreshing
   // the GA repos
+  /** How \ref inRefreshOrder ranks \a repo_r: 0 if there is an 'update' directory
+   * within the URL's path, 1 if 'update' is in alias or name, 2 otherwise.
+   */
+  inline unsigned updateRank( const RepoInfo & repo_r )
+  {
+    static const std::string update { "update" };
+    if ( str::containsCI( repo_r.url().getPathName(), update ) )
+      return 0;
+    if ( str::containsCI( repo_r.alias(), update ) || str::containsCI( repo_r.name(), update ) )
+      return 1;
+    return 2;
+  }
+
   inline std::list<RepoInfo> inRefreshOrder( std::list<RepoInfo> && list_r )
   {
     list_r.sort( []( const RepoInfo & lhs, const RepoInfo & rhs ) {
-      static const std::string update { "update" };
-      // 'update' directory within the URS's path
-      bool lu = str::containsCI( lhs.url().getPathName(), update );
-      bool ru = str::containsCI( rhs.url().getPathName(), update );
-      if ( lu != ru )
-        return lu;      // update in path wins
-      const std::string & la { lhs.alias() };
-      const std::string & ra { rhs.alias() };
-      if ( lu )
-        return la < ra; // both update => by alias
-      // 'update' in alias or name
-      lu = str::containsCI( la, update ) || str::containsCI( lhs.name(), update );
-      ru = str::containsCI( ra, update ) || str::containsCI( rhs.name(), update );
-      if ( lu != ru )
-        return lu;    // update in alias or name wins
-      return la < ra; // finally by alias
+      unsigned lr = updateRank( lhs );
+      unsigned rr = updateRank( rhs );
+      if ( lr != rr )
+        return lr < rr;   // update in path wins, then update in alias or name
+      return lhs.alias() < rhs.alias(); // finally by alias
     } );
     return std::move(list_r);
   }
 
+  /** Whether \ref inRefreshOrder sorts \a repo_r into the 'update' group. */
+  inline bool isUpdateRepo( const RepoInfo & repo_r )
+  { return updateRank( repo_r ) < 2; }
+
+  /** Number of cache building workers in \ref RefreshRepoCmd::refreshInParallel. */
+  inline unsigned buildJobs()
+  {
+    long ncpu = ::sysconf( _SC_NPROCESSORS_ONLN );
+    return ncpu > 0 ? ncpu : 1;
+  }
+
+  /** Workers never prompt; errors are captured, the rest is not of interest. */
+  inline void workerSetup( Zypper & zypper )
+  {
+    zypper.configNoConst().non_interactive = true;
+    zypper.out().setVerbosity( Out::QUIET );
+  }
+
 } // namespace
 
 RefreshRepoCmd::RefreshRepoCmd(std::vector<std::string> &&commandAliases_r )
@@ -117,6 +142,11 @@ zypp::ZyppFlags::CommandGroup RefreshRepoCmd::cmdOptions() const
             // translators: -s, --services
             _("Refresh also services before refreshing repos.")
       },
+      {"jobs", 'j', ZyppFlags::RequiredArgument,
+            ZyppFlags::IntType( &that->_jobs ),
+            // translators: -j, --jobs <INTEGER>
+            _("Download the metadata of up to this number of repositories at the same time, building the caches of already downloaded repositories meanwhile. Default is taken from zypper.conf (main.refreshJobs).")
+      },
   }};
 }
 
@@ -125,6 +155,7 @@ void RefreshRepoCmd::doReset()
   _flags = Default;
   _repos.clear();
   _services = false;
+  _jobs = 0;
 }
 
 int RefreshRepoCmd::execute( Zypper &zypper , const std::vector<std::string> &positionalArgs_r )
@@ -134,6 +165,12 @@ int RefreshRepoCmd::execute( Zypper &zypper , const std::vector<std::string> &po
 
   bool force = _flags.testFlag(Force);
 
+  if ( _jobs < 0 )
+  {
+    zypper.out().error( str::Format(_("Invalid value '%1%' for option '%2%'. Use a positive integer number.")) % _jobs % "--jobs" );
+    return ( ZYPPER_EXIT_ERR_INVALID_ARGS );
+  }
+
   if ( _services )
   {
     if ( !positionalArgs_r.empty() )
@@ -177,7 +214,7 @@ int RefreshRepoCmd::execute( Zypper &zypper , const std::vector<std::string> &po
   for ( const std::string &repoFromCLI : positionalArgs_r )
     specifiedRepos.push_back(repoFromCLI);
 
-  return refreshRepositories ( zypper, _flags, specifiedRepos );
+  return refreshRepositories ( zypper, _flags, specifiedRepos, _jobs ? _jobs : zypper.config().repo_refreshJobs );
 }
 
 bool RefreshRepoCmd::refreshRepository(Zypper &zypper, const RepoInfo &repo, RefreshFlags flags_r)
@@ -211,7 +248,164 @@ bool RefreshRepoCmd::refreshRepository(Zypper &zypper, const RepoInfo &repo, Ref
   return error;
 }
 
-int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, const std::vector<std::string> repos_r )
+std::set<std::string> RefreshRepoCmd::refreshInParallel( Zypper & zypper, const std::list<RepoInfo> & repos_r, RefreshFlags flags_r, unsigned jobs_r )
+{
+  enum Lane { Download, Build };
+  WorkerPool pool( { jobs_r, buildJobs() } );
+  MIL << "Parallel refresh of " << repos_r.size() << " repos using " << pool.maxJobs( Download ) << " download and "
+      << pool.maxJobs( Build ) << " build jobs" << endl;
+
+  bool doDownload = !flags_r.testFlag(BuildOnly);
+  bool doBuild    = !flags_r.testFlag(DownloadOnly);
+  bool forceDownload = flags_r.testFlag(Force) || flags_r.testFlag(ForceDownload);
+  bool forceBuild = flags_r.testFlag(Force) || flags_r.testFlag(ForceBuild);
+
+  std::set<std::string> failed;			// by alias
+  std::set<std::string> retry;			// by alias; download to retry interactively
+  std::map<std::string,std::string> output;	// alias -> failed workers output
+
+  // bsc#1234752: Download the 'update' repos first (to have updated GPG keys on the fly).
+  // Their caches may be built while the rest is downloading.
+  // The up-to-date check is done here, so repos not needing a download are neither
+  // passed to the workers nor reported in the progress bar. Their cache is built here
+  // if needed, just like the serial refresh does. The workers download the others
+  // without checking again.
+  std::list<RepoInfo> waves[2];
+  unsigned pending = 0;
+  for ( const RepoInfo & repo : repos_r )
+  {
+    if ( doDownload && !forceDownload )
+    {
+      bool needed = true;	// if the check fails the worker reports the error
+      try
+      {
+        callback::TempConnect<zypp::media::MediaChangeReport> tempDisconnect;
+        needed = ( check_refresh_raw_metadata( zypper, repo ) == RepoManager::REFRESH_NEEDED );
+      }
+      catch ( const Exception & e )
+      { ZYPP_CAUGHT( e ); }
+
+      if ( ! needed )
+      {
+        MIL << "No need to download " << repo.alias() << endl;
+        if ( doBuild && build_cache( zypper, repo, forceBuild ) )
+          failed.insert( repo.alias() );
+        continue;
+      }
+    }
+    waves[isUpdateRepo( repo ) ? 0 : 1].push_back( repo );
+    ++pending;
+  }
+  unsigned wavePending = waves[0].size();
+  RefreshFlags downloadFlags { flags_r | DownloadOnly | ForceDownload };	// checked above
+
+  if ( pending )
+  {
+    Out::ProgressBar report( zypper.out(), "parallel-refresh", _("Refreshing repositories") );
+    report->range( pending );
+
+    auto workerFailed = [&]( const RepoInfo & repo_r, int exitcode_r, const std::string & output_r ) {
+      WAR << "Worker for " << repo_r.alias() << " returned " << exitcode_r << endl;
+      failed.insert( repo_r.alias() );
+      output[repo_r.alias()] = output_r;
+    };
+
+    auto enqueueBuild = [&]( const RepoInfo & repo_r ) {
+      pool.enqueue( [&zypper,repo=repo_r,forceBuild]()->int {
+                      workerSetup( zypper );
+                      return build_cache( zypper, repo, forceBuild ) ? 1 : 0;
+                    },
+                    [&,repo=repo_r]( int exitcode_r, const std::string & output_r ) {
+                      if ( exitcode_r != 0 )
+                        workerFailed( repo, exitcode_r, output_r );
+                      report->incr();
+                    },
+                    Build );
+    };
+
+    std::function<void(const std::list<RepoInfo> &)> enqueueWave;
+    enqueueWave = [&]( const std::list<RepoInfo> & wave_r ) {
+      for ( const RepoInfo & repo : wave_r )
+      {
+        if ( ! doDownload )
+        {
+          enqueueBuild( repo );
+          continue;
+        }
+        pool.enqueue( [&zypper,repo,downloadFlags]()->int {
+                        workerSetup( zypper );
+                        return refreshRepository( zypper, repo, downloadFlags ) ? 1 : 0;
+                      },
+                      [&,repo,isUpdateWave=(&wave_r == &waves[0])]( int exitcode_r, const std::string & output_r ) {
+                        if ( exitcode_r == 0 )
+                        {
+                          if ( doBuild )
+                            enqueueBuild( repo );
+                          else
+                            report->incr();
+                        }
+                        else
+                        {
+                          if ( zypper.config().non_interactive )
+                            workerFailed( repo, exitcode_r, output_r );
+                          else
+                            retry.insert( repo.alias() );
+                          report->incr();
+                        }
+                        if ( isUpdateWave && --wavePending == 0 )
+                          enqueueWave( waves[1] );
+                      },
+                      Download );
+      }
+    };
+
+    if ( wavePending && doDownload )
+      enqueueWave( waves[0] );
+    else
+    {
+      enqueueWave( waves[0] );
+      enqueueWave( waves[1] );
+    }
+
+    while ( pool.waitOne() )
+    {
+      if ( zypper.exitRequested() )
+      {
+        pool.cancel();
+        report.error();
+        break;
+      }
+    }
+    if ( ! failed.empty() )
+      report.error();
+  }
+  zypper.immediateExitCheck();
+
+  for ( const RepoInfo & repo : repos_r )
+  {
+    if ( zypper.exitRequested() )
+    {
+      // don't retry; whatever is not done has failed
+      if ( retry.count( repo.alias() ) )
+        failed.insert( repo.alias() );
+    }
+    else if ( retry.count( repo.alias() ) )
+    {
+      MIL << "Retry refreshing " << repo.alias() << " interactively." << endl;
+      if ( refreshRepository( zypper, repo, flags_r ) )
+        failed.insert( repo.alias() );
+    }
+    else if ( failed.count( repo.alias() ) )
+    {
+      const std::string & out { output[repo.alias()] };
+      if ( ! out.empty() )
+        cout << out << std::flush;
+    }
+  }
+  return failed;
+}
+
+int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, const std::vector<std::string> repos_r, unsigned jobs_r )
 {
   RepoManager & manager( zypper.repoManager() );
   // bsc#1234752: Try to refresh update repos first (to have updated GPG keys on the fly)
@@ -246,6 +440,10 @@ int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, c
   unsigned error_count = 0;
   unsigned enabled_repo_count = repos.size();
 
+  // --jobs: collect the repos and refresh them in parallel afterwards.
+  bool parallel = jobs_r > 1;
+  std::list<RepoInfo> torefresh;
+
   if ( !specified.empty() || not_found.empty() )
   {
     for_( rit, repos.begin(), repos.end() )
@@ -303,13 +501,29 @@ int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, c
       }
 
       // do the refresh
-      if ( refreshRepository( zypper, repo, flags_r ) )
+      if ( parallel )
+        torefresh.push_back( repo );
+      else if ( refreshRepository( zypper, repo, flags_r ) )
       {
         zypper.out().error( str::Format(_("Skipping repository '%s' because of the above error.")) % repo.asUserString() );
         ERR << "Skipping repository '" << repo.alias() << "' because of the above error." << endl;
         error_count++;
       }
     }
+
+    if ( ! torefresh.empty() )
+    {
+      const std::set<std::string> & failed { refreshInParallel( zypper, torefresh, flags_r, jobs_r ) };
+      for ( const RepoInfo & repo : torefresh )
+      {
+        if ( failed.count( repo.alias() ) )
+        {
+          zypper.out().error( str::Format(_("Skipping repository '%s' because of the above error.")) % repo.asUserString() );
+          ERR << "Skipping repository '" << repo.alias() << "' because of the above error." << endl;
+          error_count++;
+        }
+      }
+    }
   }
   else
     enabled_repo_count = 0;
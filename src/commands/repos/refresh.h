@@ -9,6 +9,10 @@
 
 #include "commands/basecommand.h"
 
+#include <list>
+#include <set>
+#include <string>
+
 #include <zypp-core/base/Flags.h>
 
 class RefreshRepoCmd : public ZypperBaseCommand
@@ -28,11 +32,29 @@ public:
 
   RefreshRepoCmd( std::vector<std::string> &&commandAliases_r );
 
-  static int refreshRepositories ( Zypper &zypper, RefreshFlags flags_r = Default, const std::vector<std::string> repos_r = std::vector<std::string>() );
+  /** Refresh all (or the specified) repos. With \a jobs_r > 1 they are refreshed by \ref refreshInParallel. */
+  static int refreshRepositories ( Zypper &zypper, RefreshFlags flags_r = Default, const std::vector<std::string> repos_r = std::vector<std::string>(), unsigned jobs_r = 1 );
 
   /** \return false on success, true on error */
   static bool refreshRepository  ( Zypper & zypper, const zypp::RepoInfo & repo, RefreshFlags flags_r = Default );
 
+  /**
+   * Refresh \a repos_r in forked worker processes (see \ref WorkerPool).
+   *
+   * The raw metadata of up to \a jobs_r repos are downloaded at the same time.
+   * Each download feeds a pool of cache building workers (one per CPU), so
+   * downloading and building overlap. The 'update' repos are downloaded before
+   * all others (bsc#1234752). The parent shows a single progress bar for all of them.
+   *
+   * Workers run non-interactive and quiet. A repo whose download failed is refreshed
+   * once more the classic way, unless we are non-interactive anyway. This way prompts
+   * (e.g. to trust a new key) are presented as usual. Otherwise the failed workers
+   * output is printed.
+   *
+   * \return The aliases of the repos which failed to refresh.
+   */
+  static std::set<std::string> refreshInParallel( Zypper & zypper, const std::list<zypp::RepoInfo> & repos_r, RefreshFlags flags_r, unsigned jobs_r );
+
   // ZypperBaseCommand interface
 protected:
   std::vector<BaseCommandConditionPtr> conditions() const override;
@@ -45,6 +67,7 @@ private:
   RefreshFlags _flags;
   std::vector<std::string> _repos;
   bool _services = false;
+  int _jobs = 0;	///< 0: use zypper.conf
 };
 ZYPP_DECLARE_OPERATORS_FOR_FLAGS(RefreshRepoCmd::RefreshFlags);
 
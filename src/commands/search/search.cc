@@ -5,13 +5,30 @@
 #include "commands/commonflags.h"
 #include "commands/commandhelpformatter.h"
 #include "commands/search/search-packages-hinthack.h"
+#include "output/OutXML.h"
+#include "output/OutJSON.h"
+#include "utils/SearchIndex.h"
+#include "utils/ReverseDependencyIndex.h"
 
 #include <zypp/base/Algorithm.h>
 #include <zypp/sat/Solvable.h>
 #include <zypp/Capability.h>
 #include <zypp/PoolQueryResult.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/base/StrMatcher.h>
+#include <zypp/base/Measure.h>
+#include <zypp/base/SerialNumber.h>
+#include <zypp-core/fs/PathInfo.h>
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <set>
 #include <unordered_map>
+#include <unordered_set>
+
+#include <strings.h>
 
 namespace zypp
 {
@@ -40,19 +57,184 @@ namespace zypp
 
 namespace
 {
+  /** The kinds a name search may find (all, unless restricted by --type). */
+  const std::vector<ResKind> & searchableKinds()
+  {
+    static const std::vector<ResKind> kinds { ResKind::package, ResKind::srcpackage, ResKind::patch, ResKind::pattern, ResKind::product, ResKind::application };
+    return kinds;
+  }
+
   // search helper
   inline bool poolExpectMatchFor( const std::string & name_r, const Edition & edition_r )
   {
-    for ( const auto & pi : ResPool::instance().byName( name_r ) )
+    for ( const ResKind & kind : searchableKinds() )
     {
-      if ( Edition::match( pi.edition(), edition_r ) == 0 )
-        return true;
+      for ( const auto & pi : ResPool::instance().byIdent( kind, name_r ) )
+      {
+        if ( Edition::match( pi.edition(), edition_r ) == 0 )
+          return true;
+      }
     }
     return false;
   }
+
+  /** The "N-V" and "N-V-R" interpretations of a search string \a name_r.
+   * Name must match exact, Version/Release must not be empty.
+   */
+  std::vector<std::pair<std::string,Edition>> nameEditionSplits( const std::string & name_r )
+  {
+    std::vector<std::pair<std::string,Edition>> ret;
+    std::string::size_type pos = name_r.find_last_of( "-" );
+    if ( pos != std::string::npos && pos != 0 && pos != name_r.size()-1 )
+    {
+      std::string r( name_r.substr(pos+1) );
+      ret.emplace_back( name_r.substr(0,pos), Edition( r ) );
+
+      std::string::size_type pos2 = name_r.find_last_of( "-", pos-1 );
+      if ( pos2 != std::string::npos && pos2 != 0 &&  pos2 != pos-1)
+        ret.emplace_back( name_r.substr(0,pos2), Edition( name_r.substr(pos2+1,pos-pos2-1), r ) );
+    }
+    return ret;
+  }
+
+  /** The idents in the pool by ASCII lowercased name (like Match::NOCASE).
+   * Built in one pass over the pool and kept until the pool changes, so a
+   * case insensitive --match-exact search just looks up its names.
+   */
+  const std::unordered_map<std::string,std::vector<IdString>> & identsByLowerName()
+  {
+    static std::optional<std::unordered_map<std::string,std::vector<IdString>>> _index;
+    static SerialNumberWatcher _poolWatcher;
+    if ( _poolWatcher.remember( sat::Pool::instance().serial() ) )
+      _index.reset();
+
+    if ( ! _index )
+    {
+      debug::Measure m( "identsByLowerName" );
+      _index.emplace();
+      std::unordered_set<sat::detail::IdType> seen;
+      for ( const sat::Solvable & slv : sat::Pool::instance().solvables() )
+      {
+        IdString ident { slv.ident() };
+        if ( seen.insert( ident.id() ).second )
+          (*_index)[str::toLower( slv.name() )].push_back( ident );
+      }
+    }
+    return *_index;
+  }
+
+  /** Rank of each of \a keys_r in the order \c Table::sort gives column \a column_r.
+   * The keys are sorted in a \ref Table, so the ranks agree with the collation
+   * the result table uses. Adjacent keys which may compare equal (ASCII case
+   * insensitive) share a rank, so a sort group never separates rows the table
+   * might order differently.
+   */
+  std::unordered_map<std::string,unsigned> tableSortRanks( const std::unordered_set<std::string> & keys_r, unsigned column_r )
+  {
+    Table tbl;
+    for ( const std::string & key : keys_r )
+    {
+      TableRow row( column_r + 1 );
+      for ( unsigned col = 0; col < column_r; ++col )
+        row << "";
+      row << key;
+      tbl << std::move(row);
+    }
+    tbl.sort( column_r );
+
+    std::unordered_map<std::string,unsigned> ret;
+    unsigned rank = 0;
+    const std::string * last = nullptr;
+    for ( const TableRow & row : tbl.rows() )
+    {
+      const std::string & key { row.columns()[column_r] };
+      if ( last && ::strcasecmp( last->c_str(), key.c_str() ) != 0 )
+        ++rank;
+      ret[key] = rank;
+      last = &key;
+    }
+    return ret;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class XmlSearchResultStream
+  /// \brief Write an XML search result in chunks of bounded size.
+  ///
+  /// The hits are ordered by the sort keys of the result table, ranked by
+  /// \ref tableSortRanks (cheap, as no rows are built) and passed to the table filling functor
+  /// in this order. Whenever the table holds enough rows and a new sort
+  /// group starts, the collected rows are sorted the way the complete table
+  /// would be, written and dropped. As a sort group is never split, the
+  /// output is the same as if the complete table had been sorted, but the
+  /// memory used for rows does not grow with the number of hits.
+  ///////////////////////////////////////////////////////////////////
+  class XmlSearchResultStream
+  {
+  public:
+    XmlSearchResultStream( Table & table_r, std::function<void(Table &)> sort_r )
+    : _table( table_r )
+    , _sort( std::move(sort_r) )
+    {}
+
+    /** Call before the rows of a new sort group are added. */
+    void nextGroup()
+    {
+      if ( _table.rows().size() >= SearchCmd::xmlChunkRows )
+        flush();
+    }
+
+    /** Write the remaining rows and close the element if rows were written.
+     * \returns The number of rows written.
+     */
+    unsigned finish()
+    {
+      flush();
+      if ( _written )
+        OutXML::searchResultEnd( cout );
+      return _written;
+    }
+
+  private:
+    void flush()
+    {
+      if ( _table.empty() )
+        return;
+
+      _sort( _table );
+      OutXML::sync( Zypper::instance().out() );
+      if ( ! _written )
+      {
+        cout << endl; //! \todo  out().separator()?
+        OutXML::searchResultBegin( cout );
+        _tags = OutXML::searchResultTags( _table.header() );
+      }
+      for ( const TableRow & row : _table.rows() )
+        OutXML::searchResultRow( cout, _tags, row );
+      _written += _table.rows().size();
+      _table.rows().clear();
+      cout.flush();
+    }
+
+  private:
+    Table & _table;
+    std::function<void(Table &)> _sort;
+    std::vector<std::string> _tags;
+    unsigned _written = 0;
+  };
+
+  /** The 'Repository' column of the detailed search result (see \ref FillSearchTableSolvable). */
+  inline std::string repositoryColumn( const sat::Solvable & solv_r )
+  {
+    return( solv_r.isSystem()
+          ? (std::string("(") + _("System Packages") + ")")
+          : solv_r.repository().asUserString() );
+  }
 }
 
 
+unsigned SearchCmd::xmlChunkRows = 1000;
+bool SearchCmd::exactNameLookup = true;
+
 SearchCmd::SearchCmd( std::vector<std::string> &&commandAliases_r )
 : ZypperBaseCommand( std::move( commandAliases_r ), std::string(), std::string(), std::string(), ResetRepoManager )
 {
@@ -231,6 +413,280 @@ void SearchCmd::doReset()
   _requestedTypes.clear();
 }
 
+std::vector<Repository> SearchCmd::searchedRepos( Zypper &zypper ) const
+{
+  std::set<std::string> repoFilter;
+  if ( InitRepoSettings::instance()._repoFilter.size() )
+  {
+    for ( const RepoInfo & repo : zypper.runtimeData().repos )
+      repoFilter.insert( repo.alias() );
+  }
+  bool uninstalledOnly = zypper.config().disable_system_resolvables || _notInstalledOpts._mode == SolvableFilterMode::ShowOnlyNotInstalled;
+
+  std::vector<Repository> ret;
+  for ( const Repository & repo : sat::Pool::instance().repos() )
+  {
+    if ( ! repoFilter.empty() && ! repoFilter.count( repo.alias() ) )
+      continue;
+    if ( uninstalledOnly && repo.isSystemRepo() )
+      continue;
+    ret.push_back( repo );
+  }
+  return ret;
+}
+
+bool SearchCmd::kindRequested( const sat::Solvable & slv_r ) const
+{
+  if ( _requestedTypes.empty() )
+    return true;
+  for ( const ResKind & knd : _requestedTypes )
+  {
+    if ( slv_r.isKind( knd ) )
+      return true;
+  }
+  return false;
+}
+
+bool SearchCmd::plainNameArgs( const std::vector<std::string> &positionalArgs_r ) const
+{
+  if ( positionalArgs_r.empty() || _verbose || _requestedReverseSearch.is_initialized()
+    || _requestedDeps != std::set<sat::SolvAttr>{ sat::SolvAttr::name } )
+    return false;
+
+  for ( const std::string & arg : positionalArgs_r )
+  {
+    CapDetail detail { Capability( arg ).detail() };
+    if ( ! detail.isSimple() || detail.isVersioned() || ! detail.arch().empty()
+      || ! ResKind::explicitBuiltin( arg ).empty() )
+      return false;
+  }
+  return true;
+}
+
+std::optional<std::vector<sat::Solvable>> SearchCmd::exactNameSearch( Zypper &zypper, const std::vector<std::string> &positionalArgs_r ) const
+{
+  if ( ! exactNameLookup || _mode != MatchMode::Exact || _searchDesc || ! plainNameArgs( positionalArgs_r ) )
+    return std::nullopt;
+
+  // The same as the PoolQuery built by execute(): Each argument must match
+  // the name exactly (case insensitive unless requested) or be a "N-V" or
+  // "N-V-R" with matching edition. The arguments are resolved to the
+  // matching idents first, so only their solvables are looked at (via the
+  // pools ident index) rather than the whole pool.
+  debug::Measure m( "exactNameSearch" );
+  using Editions = std::vector<std::optional<Edition>>;	// nullopt: any edition
+  std::vector<std::pair<std::string,std::optional<Edition>>> specs;
+  for ( const std::string & arg : positionalArgs_r )
+  {
+    CapDetail detail { Capability( arg ).detail() };
+    std::string name { detail.name().asString() };
+    if ( detail.isNamed() )
+    {
+      for ( auto & split : nameEditionSplits( name ) )
+        specs.emplace_back( std::move(split.first), std::move(split.second) );
+    }
+    specs.emplace_back( std::move(name), std::nullopt );
+  }
+
+  std::map<IdString,Editions> idents;
+  if ( _caseSensitive )
+  {
+    const std::vector<ResKind> & kinds { _requestedTypes.empty() ? searchableKinds() : std::vector<ResKind>( _requestedTypes.begin(), _requestedTypes.end() ) };
+    for ( const auto & spec : specs )
+    {
+      for ( const ResKind & kind : kinds )
+        idents[sat::Solvable::SplitIdent( kind, spec.first ).ident()].push_back( spec.second );
+    }
+  }
+  else
+  {
+    const auto & byLowerName { identsByLowerName() };
+    for ( const auto & spec : specs )
+    {
+      auto it = byLowerName.find( str::toLower( spec.first ) );
+      if ( it == byLowerName.end() )
+        continue;
+      for ( IdString ident : it->second )
+      {
+        if ( _requestedTypes.empty() || _requestedTypes.count( sat::Solvable::SplitIdent( ident ).kind() ) )
+          idents[ident].push_back( spec.second );
+      }
+    }
+  }
+
+  std::set<Repository::IdType> repos;
+  for ( const Repository & repo : searchedRepos( zypper ) )
+    repos.insert( repo.id() );
+
+  std::vector<sat::Solvable> ret;
+  for ( const auto & ident : idents )
+  {
+    for ( const PoolItem & pi : ResPool::instance().byIdent( ident.first ) )
+    {
+      if ( ! repos.count( pi.satSolvable().repository().id() ) )
+        continue;
+      for ( const std::optional<Edition> & edition : ident.second )
+      {
+        if ( ! edition || Edition::match( pi.edition(), *edition ) == 0 )
+        {
+          ret.push_back( pi.satSolvable() );
+          break;
+        }
+      }
+    }
+  }
+  // in the order the PoolQuery would deliver them
+  std::sort( ret.begin(), ret.end(), []( const sat::Solvable & lhs, const sat::Solvable & rhs ) { return lhs.id() < rhs.id(); } );
+  ret.erase( std::unique( ret.begin(), ret.end() ), ret.end() );
+  MIL << "Exact names: " << specs.size() << " names, " << idents.size() << " idents, " << ret.size() << " hits" << endl;
+  return ret;
+}
+
+std::optional<std::vector<sat::Solvable>> SearchCmd::indexedSearch( Zypper &zypper, const std::vector<std::string> &positionalArgs_r ) const
+{
+  // The index knows names, summaries and descriptions only.
+  if ( ! plainNameArgs( positionalArgs_r ) )
+    return std::nullopt;
+
+  // What execute() adds to the PoolQuery for each argument: The string matched
+  // against the name (and summary/description), and the "N-V" and "N-V-R"
+  // interpretations of the argument. Each needs a literal part the index can
+  // look up.
+  struct Alternative
+  {
+    StrMatcher _matcher;
+    std::vector<std::string> _literals;	///< must all be contained in a match
+    bool _text;				///< also match summary/description
+    std::optional<Edition> _edition;	///< "N-V"/"N-V-R": required edition
+  };
+  std::vector<Alternative> alternatives;
+
+  Match nocase { _caseSensitive ? Match() : Match::NOCASE };
+  for ( const std::string & arg : positionalArgs_r )
+  {
+    CapDetail detail { Capability( arg ).detail() };
+    std::string name { detail.name().asString() };
+
+    Match mode;
+    bool other = true;	// the PoolQuery default mode is used
+    switch ( _mode )
+    {
+      case MatchMode::Default:
+      case MatchMode::Substrings:
+        mode = Match::SUBSTRING;
+        break;
+      case MatchMode::Words:
+        return std::nullopt;	// PoolQuery post-processes the matches
+      case MatchMode::Exact:
+        mode = Match::STRING;
+        break;
+    }
+    if ( _mode == MatchMode::Default )
+    {
+      if ( name.size() >= 2 && *name.begin() == '/' && *name.rbegin() == '/' )
+        return std::nullopt;	// regex
+      else if ( name.find_first_of("?*") != std::string::npos )
+      {
+        if ( name.find_first_of("[\\") != std::string::npos )
+          return std::nullopt;	// not just literals and wildcards
+        mode = Match::GLOB;
+        other = false;
+      }
+    }
+
+    Alternative alt { StrMatcher( name, mode | nocase ), {}, _searchDesc, std::nullopt };
+    str::split( name, std::back_inserter( alt._literals ), "*?" );
+    alt._literals.erase( std::remove_if( alt._literals.begin(), alt._literals.end(), []( const std::string & l ) { return l.size() < 3; } ), alt._literals.end() );
+    if ( alt._literals.empty() )
+      return std::nullopt;
+    alternatives.push_back( std::move(alt) );
+
+    if ( other && detail.isNamed() )
+    {
+      for ( const auto & split : nameEditionSplits( name ) )
+      {
+        if ( split.first.size() < 3 )
+          return std::nullopt;
+        alternatives.push_back( Alternative{ StrMatcher( split.first, Match::STRING | nocase ), { split.first }, false, split.second } );
+      }
+    }
+  }
+
+  // The name without kind prefix, like the PoolQuery (Match::SKIP_KIND).
+  auto matches = [&]( const sat::Solvable & slv_r ) {
+    if ( ! kindRequested( slv_r ) )
+      return false;
+
+    const std::string & name { slv_r.name() };
+    for ( const Alternative & alt : alternatives )
+    {
+      if ( alt._edition )
+      {
+        if ( alt._matcher.doMatch( name.c_str() ) && Edition::match( slv_r.edition(), *alt._edition ) == 0 )
+          return true;
+      }
+      else if ( alt._matcher.doMatch( name.c_str() )
+        || ( alt._text && ( alt._matcher.doMatch( slv_r.lookupStrAttribute( sat::SolvAttr::summary ).c_str() )
+                         || alt._matcher.doMatch( slv_r.lookupStrAttribute( sat::SolvAttr::description ).c_str() ) ) ) )
+        return true;
+    }
+    return false;
+  };
+
+  auto idLess = []( const sat::Solvable & lhs, const sat::Solvable & rhs ) { return lhs.id() < rhs.id(); };
+
+  debug::Measure m( "indexedSearch" );
+  const Pathname & solvCachePath { zypper.config().rm_options.repoSolvCachePath };
+  std::vector<sat::Solvable> ret;
+  for ( const Repository & repo : searchedRepos( zypper ) )
+  {
+    // Repo indexes are built by refresh; the one of @System (and those of
+    // repos refreshed by other commands) here, if the cache is writable.
+    Pathname dir { SearchIndex::dir( solvCachePath, repo ) };
+    if ( ! SearchIndex::upToDate( dir ) && PathInfo( dir ).userMayW() )
+      SearchIndex::update( repo, dir );
+
+    SearchIndex index( repo, dir );
+    if ( ! index )
+    {
+      MIL << "No usable search index for " << repo.alias() << "; scanning the pool." << endl;
+      return std::nullopt;
+    }
+
+    std::vector<sat::Solvable> candidates;
+    for ( const Alternative & alt : alternatives )
+    {
+      std::vector<sat::Solvable> cand;
+      bool initial = true;
+      for ( const std::string & literal : alt._literals )
+      {
+        std::vector<sat::Solvable> lcand { *index.candidates( literal, alt._text ) };
+        if ( initial )
+        {
+          cand.swap( lcand );
+          initial = false;
+        }
+        else
+        {
+          std::vector<sat::Solvable> both;
+          std::set_intersection( cand.begin(), cand.end(), lcand.begin(), lcand.end(), std::back_inserter( both ), idLess );
+          cand.swap( both );
+        }
+      }
+      std::vector<sat::Solvable> all;
+      std::set_union( candidates.begin(), candidates.end(), cand.begin(), cand.end(), std::back_inserter( all ), idLess );
+      candidates.swap( all );
+    }
+
+    for ( const sat::Solvable & slv : candidates )
+    {
+      if ( matches( slv ) )
+        ret.push_back( slv );
+    }
+  }
+  return ret;
+}
+
 int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &positionalArgs_r )
 {
   // check args...
@@ -304,6 +760,13 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
   if ( _requestedDeps.empty() || _forceNameAttr )
     _requestedDeps.insert( sat::SolvAttr::name );
 
+  // A plain name/summary/description search may be answered by looking up the
+  // names (--match-exact) or from the repos search index rather than scanning
+  // the pool once per argument and attribute. The query is not needed then.
+  std::optional<std::vector<sat::Solvable>> indexed { exactNameSearch( zypper, positionalArgs_r ) };
+  if ( ! indexed )
+    indexed = indexedSearch( zypper, positionalArgs_r );
+
   bool details = _details || _verbose;
   // add argument strings and attributes to query
   for_( it, positionalArgs_r.begin(), positionalArgs_r.end() )
@@ -336,6 +799,20 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
     }
     // else: match mode explicitly requested by cli arg
 
+    if ( indexed )
+    {
+      // Just check whether "N-V" and "N-V-R" hits need details.
+      if ( matchmode == Match::OTHER && cap.detail().isNamed() )
+      {
+        for ( const auto & split : nameEditionSplits( name ) )
+        {
+          if ( poolExpectMatchFor( split.first, split.second ) )
+            details = true;	// show details if any search string includes an edition
+        }
+      }
+      continue;
+    }
+
     // NOTE: We use the  addDependency  overload taking a  matchmode  argument for ALL
     // kinds of attributes, not only for dependencies. A constraint on 'op version'
     // will automatically be applied to match a matching dependency or to match
@@ -360,28 +837,13 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
         if ( matchmode == Match::OTHER && cap.detail().isNamed() )
         {
           // ARG did not require a specific matchmode.
-          // Handle "N-V" and "N-V-R" cases. Name must match exact,
-          // Version/Release must not be empty. If versioned matches are
+          // Handle "N-V" and "N-V-R" cases. If versioned matches are
           // found, don't forget to show details.
-          std::string::size_type pos = name.find_last_of( "-" );
-          if ( pos != std::string::npos && pos != 0 && pos != name.size()-1 )
+          for ( const auto & split : nameEditionSplits( name ) )
           {
-            std::string n( name.substr(0,pos) );
-            std::string r( name.substr(pos+1) );
-            Edition e( r );
-            query.addDependency( sat::SolvAttr::name, n, Rel::EQ, e, Arch(cap.detail().arch()), Match::STRING );
-            if ( poolExpectMatchFor( n, e ) )
+            query.addDependency( sat::SolvAttr::name, split.first, Rel::EQ, split.second, Arch(cap.detail().arch()), Match::STRING );
+            if ( poolExpectMatchFor( split.first, split.second ) )
               details = true;	// show details if any search string includes an edition
-
-            std::string::size_type pos2 = name.find_last_of( "-", pos-1 );
-            if ( pos2 != std::string::npos && pos2 != 0 &&  pos2 != pos-1)
-            {
-              n = name.substr(0,pos2);
-              e = Edition( name.substr(pos2+1,pos-pos2-1), r );
-              query.addDependency( sat::SolvAttr::name, n, Rel::EQ, e, Arch(cap.detail().arch()), Match::STRING );
-              if ( poolExpectMatchFor( n, e ) )
-                details = true;	// show details if any search string includes an edition
-            }
           }
         }
       }
@@ -397,11 +859,42 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
   Table t;
   try
   {
+    auto forEachSolvable = [&]( auto && fnc_r ) {
+      if ( indexed )
+      {
+        for ( const auto & slv : *indexed )
+          fnc_r( slv );
+      }
+      else
+      {
+        for ( const auto slv : query )
+          fnc_r( slv );
+      }
+    };
+    auto forEachSelectable = [&]( auto && fnc_r ) {
+      if ( indexed )
+      {
+        // like PoolQuery::selectableBegin: in order of the 1st solvable, no duplicates
+        std::set<ui::Selectable::Ptr> seen;
+        for ( const auto & slv : *indexed )
+        {
+          ui::Selectable::Ptr sel { ui::Selectable::get( slv ) };
+          if ( sel && seen.insert( sel ).second )
+            fnc_r( sel );
+        }
+      }
+      else
+      {
+        for ( auto it = query.selectableBegin(); it != query.selectableEnd(); ++it )
+          fnc_r( *it );
+      }
+    };
+
     if ( _requestedReverseSearch.is_initialized() ) {
 
-      std::unordered_map< sat::Solvable, CapabilitySet > matchedSolvables;
       const auto reqSearchAttrib = _requestedReverseSearch.get();
 
+      std::unordered_set<sat::Solvable> providers;
       for ( const auto slv : query ) {
 
         bool isInstalled = slv.isSystem();
@@ -410,20 +903,12 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
         if ( !isInstalled && _notInstalledOpts._mode == SolvableFilterMode::ShowOnlyInstalled )
           continue;
 
-        sat::Queue q = sat::Pool::instance().whatMatchesSolvable( reqSearchAttrib, slv  );
-
-        for ( auto matchedSolvId : q ) {
-
-          sat::Solvable matchedSolv ( static_cast<sat::Solvable::IdType>(matchedSolvId) );
-          auto p = matchedSolvables.insert( make_pair( std::move(matchedSolv), CapabilitySet()) );
-
-          if ( _verbose ) {
-            CapabilitySet matchedCaps = matchedSolv.matchesSolvable( reqSearchAttrib, slv).second;
-            p.first->second.insert( matchedCaps.begin(), matchedCaps.end() );
-          }
-        }
+        providers.insert( slv );
       }
 
+      // one pass over the (cached) reverse dependencies for all query hits
+      std::unordered_map< sat::Solvable, CapabilitySet > matchedSolvables = ReverseDependencyIndex::get( reqSearchAttrib ).whatMatches( providers );
+
       if ( details ) {
         FillSearchTableSolvable callback( t, inst_notinst );
         std::for_each( matchedSolvables.begin(), matchedSolvables.end(), [&callback, verb = _verbose, &reqSearchAttrib ]( auto elem ){
@@ -441,6 +926,8 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
         std::for_each( res.selectableBegin(), res.selectableEnd(), callback);
       }
 
+    } else if ( zypper.out().type() == Out::TYPE_XML && ! _verbose ) {
+      // Streamed below; no need to collect the table rows.
     } else {
       if ( details )
       {
@@ -454,46 +941,129 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
         }
         else
         {
-          for ( const auto slv : query )
-            callback( slv );
+          forEachSolvable( callback );
         }
       }
       else
       {
         FillSearchTableSelectable callback( t, inst_notinst );
-        invokeOnEach( query.selectableBegin(), query.selectableEnd(), callback );
+        forEachSelectable( callback );
       }
     }
 
-    if ( t.empty() )
-    {
-      // translators: empty search result message
-      zypper.out().info(_("No matching items found."), Out::QUIET );
-      if ( !zypper.config().ignore_unknown ) {
-        zypper.setExitInfoCode( ZYPPER_EXIT_INF_CAP_NOT_FOUND );
-      }
-    }
-    else
-    {
-      cout << endl; //! \todo  out().separator()?
-
+    auto sortTable = [&]( Table & t_r ) {
       if ( _details )
       {
         if ( _sortOpts._mode == SortResultOptionSet::ByRepo )
-          t.sort( { 5, 1, Table::UserData } );
+          t_r.sort( { 5, 1, Table::UserData } );
         else
-          t.sort( { 1, Table::UserData } ); // sort by name
+          t_r.sort( { 1, Table::UserData } ); // sort by name
       }
       else
       {
         // sort by name (can't sort by repo)
-        t.sort( 1 );
+        t_r.sort( 1 );
         if ( !zypper.config().no_abbrev )
-          t.allowAbbrev( 2 );
+          t_r.allowAbbrev( 2 );
+      }
+    };
+
+    bool found = false;
+    if ( ! _requestedReverseSearch.is_initialized() && zypper.out().type() == Out::TYPE_XML && ! _verbose )
+    {
+      // Huge results (e.g. 'search -s' on many repos) are written in chunks.
+      // Hits are ordered by (repo and) name ahead, ranked in the collation of
+      // Table::sort, so the chunks are already in the final order.
+      XmlSearchResultStream stream( t, sortTable );
+      if ( details )
+      {
+        struct Hit
+        {
+          sat::Solvable _solv;
+          unsigned _repo;	///< rank of the 'Repository' column if sorted by repo
+          unsigned _name;	///< rank of the 'Name' column
+        };
+        const bool byRepo = _details && _sortOpts._mode == SortResultOptionSet::ByRepo;
+
+        std::vector<Hit> hits;
+        std::unordered_set<std::string> names;
+        std::map<sat::Repository::IdType, std::string> repoColumns;
+        forEachSolvable( [&]( const sat::Solvable & slv ) {
+          hits.push_back( Hit{ slv, 0, 0 } );
+          names.insert( slv.name() );
+          if ( byRepo && ! repoColumns.count( slv.repository().id() ) )
+            repoColumns[slv.repository().id()] = repositoryColumn( slv );
+        } );
+        // the columns sortTable sorts by: 5 'Repository', 1 'Name'
+        std::unordered_map<std::string,unsigned> nameRanks { tableSortRanks( names, 1 ) };
+        std::unordered_map<std::string,unsigned> repoRanks;
+        if ( byRepo )
+        {
+          std::unordered_set<std::string> repos;
+          for ( const auto & p : repoColumns )
+            repos.insert( p.second );
+          repoRanks = tableSortRanks( repos, 5 );
+        }
+        for ( Hit & hit : hits )
+        {
+          hit._name = nameRanks[hit._solv.name()];
+          if ( byRepo )
+            hit._repo = repoRanks[repoColumns[hit._solv.repository().id()]];
+        }
+
+        auto groupLess = []( const Hit & lhs, const Hit & rhs ) {
+          if ( lhs._repo != rhs._repo )
+            return lhs._repo < rhs._repo;
+          return lhs._name < rhs._name;
+        };
+        std::stable_sort( hits.begin(), hits.end(), groupLess );
+
+        FillSearchTableSolvable callback( t, inst_notinst );
+        for ( auto it = hits.begin(); it != hits.end(); ++it )
+        {
+          if ( it != hits.begin() && groupLess( *(it-1), *it ) )
+            stream.nextGroup();
+          callback( it->_solv );
+        }
       }
+      else
+      {
+        std::vector<ui::Selectable::Ptr> hits;
+        std::unordered_set<std::string> names;
+        forEachSelectable( [&]( const ui::Selectable::Ptr & sel ) { hits.push_back( sel ); names.insert( sel->name() ); } );
+        std::unordered_map<std::string,unsigned> nameRanks { tableSortRanks( names, 1 ) };	// sortTable sorts by 1 'Name'
+        auto groupLess = [&nameRanks]( const ui::Selectable::Ptr & lhs, const ui::Selectable::Ptr & rhs ) {
+          return nameRanks.at( lhs->name() ) < nameRanks.at( rhs->name() );
+        };
+        std::stable_sort( hits.begin(), hits.end(), groupLess );
 
+        FillSearchTableSelectable callback( t, inst_notinst );
+        for ( auto it = hits.begin(); it != hits.end(); ++it )
+        {
+          if ( it != hits.begin() && groupLess( *(it-1), *it ) )
+            stream.nextGroup();
+          callback( *it );
+        }
+      }
+      found = stream.finish();
+    }
+    else if ( ! t.empty() )
+    {
+      if ( ! OutJSON::typeJSON( zypper.out() ) )
+        cout << endl; //! \todo  out().separator()?
+      sortTable( t );
       //cout << t; //! \todo out().table()?
       zypper.out().searchResult( t );
+      found = true;
+    }
+
+    if ( ! found )
+    {
+      // translators: empty search result message
+      zypper.out().info(_("No matching items found."), Out::QUIET );
+      if ( !zypper.config().ignore_unknown ) {
+        zypper.setExitInfoCode( ZYPPER_EXIT_INF_CAP_NOT_FOUND );
+      }
     }
 
     if ( !_requestedReverseSearch.is_initialized() )
@@ -13,8 +13,12 @@
 
 
 #include <zypp/sat/SolvAttr.h>
+#include <zypp/sat/Solvable.h>
+#include <zypp/Repository.h>
 #include <boost/optional.hpp>
 
+#include <optional>
+
 class SearchCmd : public ZypperBaseCommand
 {
 public:
@@ -28,6 +32,16 @@ public:
 
   SearchCmd ( std::vector<std::string> &&commandAliases_r );
 
+  /** Max. rows of an XML search result collected before they are written
+   * (unless a sort group is bigger). Tests use small chunks.
+   */
+  static unsigned xmlChunkRows;
+
+  /** Whether a --match-exact name search looks up the names rather than
+   * running the PoolQuery. Tests compare both.
+   */
+  static bool exactNameLookup;
+
   void setMode(const MatchMode &mode_r );
   void addRequestedDependency ( const zypp::sat::SolvAttr &dep_r );
 
@@ -54,6 +68,27 @@ protected:
   void doReset() override;
   int execute(Zypper &zypper, const std::vector<std::string> &positionalArgs_r) override;
 
+private:
+  /** The repos the PoolQuery built by \ref execute would search. */
+  std::vector<zypp::Repository> searchedRepos( Zypper &zypper ) const;
+  /** Whether \a slv_r is of a requested kind (or no kinds were requested). */
+  bool kindRequested( const zypp::sat::Solvable & slv_r ) const;
+  /** Whether the query looks for plain names only (no deps, versions, archs or kind prefixes). */
+  bool plainNameArgs( const std::vector<std::string> &positionalArgs_r ) const;
+
+  /** Answer a --match-exact name search by looking up the matching idents.
+   * \returns The matching solvables in the order the PoolQuery would deliver them,
+   * or nothing if the query is not a plain exact name search.
+   */
+  std::optional<std::vector<zypp::sat::Solvable>> exactNameSearch( Zypper &zypper, const std::vector<std::string> &positionalArgs_r ) const;
+
+  /** Answer a plain name/summary/description search from the repos \ref SearchIndex.
+   * \returns The matching solvables in the order the PoolQuery would deliver them,
+   * or nothing if the query can not be answered from the indexes (options not
+   * supported, index missing or stale). The pool must be scanned then.
+   */
+  std::optional<std::vector<zypp::sat::Solvable>> indexedSearch( Zypper &zypper, const std::vector<std::string> &positionalArgs_r ) const;
+
   // ZypperBaseCommand interface
 public:
   std::string summary() const override;
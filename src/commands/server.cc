@@ -0,0 +1,690 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include "server.h"
+
+#include <iostream>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <locale.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <zypp-core/base/LogTools.h>
+#include <zypp-core/AutoDispose.h>
+#include <zypp-core/fs/PathInfo.h>
+#include <zypp/base/Measure.h>
+
+#include "Zypper.h"
+#include "Command.h"
+#include "repos.h"
+#include "global-settings.h"
+#include "output/OutNormal.h"
+#include "utils/messages.h"
+#include "utils/flags/flagtypes.h"
+
+using namespace zypp;
+
+namespace
+{
+  /** Upper limit for a forwarded command line. */
+  constexpr uint32_t maxRequestSize = 1024 * 1024;
+
+  /** The clients environment variables applied to the request (locale and terminal). */
+  constexpr const char * forwardedEnv[] = {
+    "LANG", "LANGUAGE", "LC_ALL", "LC_CTYPE", "LC_MESSAGES", "LC_NUMERIC", "LC_TIME", "LC_COLLATE",
+    "TERM", "COLUMNS",
+  };
+
+  bool isForwardedEnv( const std::string & name_r )
+  {
+    for ( const char * name : forwardedEnv )
+    {
+      if ( name_r == name )
+        return true;
+    }
+    return false;
+  }
+
+  bool recvAll( int fd_r, void * buf_r, size_t size_r )
+  {
+    char * buf = static_cast<char *>( buf_r );
+    while ( size_r )
+    {
+      ssize_t n = ::recv( fd_r, buf, size_r, 0 );
+      if ( n < 0 && errno == EINTR )
+        continue;
+      if ( n <= 0 )
+        return false;
+      buf += n;
+      size_r -= n;
+    }
+    return true;
+  }
+
+  bool sendAll( int fd_r, const void * buf_r, size_t size_r )
+  {
+    const char * buf = static_cast<const char *>( buf_r );
+    while ( size_r )
+    {
+      ssize_t n = ::send( fd_r, buf, size_r, MSG_NOSIGNAL );
+      if ( n < 0 && errno == EINTR )
+        continue;
+      if ( n <= 0 )
+        return false;
+      buf += n;
+      size_r -= n;
+    }
+    return true;
+  }
+
+  bool setSockaddr( struct sockaddr_un & addr_r, const std::string & path_r )
+  {
+    ::memset( &addr_r, 0, sizeof(addr_r) );
+    addr_r.sun_family = AF_UNIX;
+    if ( path_r.empty() || path_r.size() >= sizeof(addr_r.sun_path) )
+      return false;
+    ::strncpy( addr_r.sun_path, path_r.c_str(), sizeof(addr_r.sun_path) - 1 );
+    return true;
+  }
+
+  /** A socket connected to \a path_r or \c -1. */
+  int connectSocket( const std::string & path_r )
+  {
+    struct sockaddr_un addr;
+    if ( ! setSockaddr( addr, path_r ) )
+      return -1;
+
+    int fd = ::socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if ( fd < 0 )
+      return -1;
+    if ( ::connect( fd, reinterpret_cast<struct sockaddr *>( &addr ), sizeof(addr) ) != 0 )
+    {
+      ::close( fd );
+      return -1;
+    }
+    return fd;
+  }
+
+  /** A socket listening on \a path_r, accessible by the owner only; \c -1 and \a err_r on error. */
+  int listenSocket( const Pathname & path_r, std::string & err_r )
+  {
+    struct sockaddr_un addr;
+    if ( ! setSockaddr( addr, path_r.asString() ) )
+    {
+      err_r = _("Invalid socket path.");
+      return -1;
+    }
+
+    if ( PathInfo( path_r, PathInfo::LSTAT ).isExist() )
+    {
+      int probe = connectSocket( path_r.asString() );
+      if ( probe >= 0 )
+      {
+        ::close( probe );
+        err_r = _("Another server is already listening on this socket.");
+        return -1;
+      }
+      filesystem::unlink( path_r );	// stale
+    }
+    filesystem::assert_dir( path_r.dirname() );
+
+    int fd = ::socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if ( fd < 0 )
+    {
+      err_r = ::strerror( errno );
+      return -1;
+    }
+
+    mode_t omask = ::umask( 0077 );
+    int res = ::bind( fd, reinterpret_cast<struct sockaddr *>( &addr ), sizeof(addr) );
+    ::umask( omask );
+    if ( res != 0 || ::listen( fd, 16 ) != 0 )
+    {
+      err_r = ::strerror( errno );
+      ::close( fd );
+      return -1;
+    }
+    return fd;
+  }
+
+  /** The request: a uint32 size and our stdin/stdout/stderr, followed by the payload:
+   * the NUL terminated \ref forwardedEnv entries (\c NAME=value), an empty
+   * string and the NUL terminated args.
+   */
+  bool sendRequest( int sock_r, const std::string & payload_r )
+  {
+    uint32_t size = payload_r.size();
+    int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+
+    struct iovec iov = { &size, sizeof(size) };
+    union {
+      char buf[CMSG_SPACE( sizeof(fds) )];
+      struct cmsghdr align;
+    } control;
+    ::memset( &control, 0, sizeof(control) );
+
+    struct msghdr msg;
+    ::memset( &msg, 0, sizeof(msg) );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr * cmsg = CMSG_FIRSTHDR( &msg );
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN( sizeof(fds) );
+    ::memcpy( CMSG_DATA( cmsg ), fds, sizeof(fds) );
+
+    ssize_t n = 0;
+    while ( (n = ::sendmsg( sock_r, &msg, MSG_NOSIGNAL )) < 0 && errno == EINTR )
+    {;} // just loop
+    if ( n != sizeof(size) )
+      return false;
+    return sendAll( sock_r, payload_r.data(), payload_r.size() );
+  }
+
+  bool receiveRequest( int conn_r, int (&fds_r)[3], std::vector<std::string> & env_r, std::vector<std::string> & args_r )
+  {
+    uint32_t size = 0;
+    struct iovec iov = { &size, sizeof(size) };
+    union {
+      char buf[CMSG_SPACE( sizeof(fds_r) )];
+      struct cmsghdr align;
+    } control;
+
+    struct msghdr msg;
+    ::memset( &msg, 0, sizeof(msg) );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t n = 0;
+    while ( (n = ::recvmsg( conn_r, &msg, MSG_CMSG_CLOEXEC )) < 0 && errno == EINTR )
+    {;} // just loop
+
+    struct cmsghdr * cmsg = ( n > 0 ? CMSG_FIRSTHDR( &msg ) : nullptr );
+    if ( ! cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS )
+      return false;
+    if ( cmsg->cmsg_len != CMSG_LEN( sizeof(fds_r) ) )
+    {
+      // don't leak what we got
+      int * fds = reinterpret_cast<int *>( CMSG_DATA( cmsg ) );
+      for ( size_t i = 0; i < ( cmsg->cmsg_len - CMSG_LEN( 0 ) ) / sizeof(int); ++i )
+        ::close( fds[i] );
+      return false;
+    }
+    ::memcpy( fds_r, CMSG_DATA( cmsg ), sizeof(fds_r) );
+
+    std::string payload;
+    bool ok = ( n == sizeof(size) && size <= maxRequestSize );
+    if ( ok )
+    {
+      payload.resize( size );
+      ok = recvAll( conn_r, payload.data(), size );
+    }
+    if ( ! ok )
+    {
+      for ( int fd : fds_r )
+        ::close( fd );
+      return false;
+    }
+
+    env_r.clear();
+    args_r.clear();
+    bool inEnv = true;	// env entries are never empty; the 1st empty string ends them
+    std::string::size_type pos = 0;
+    while ( pos < payload.size() )
+    {
+      std::string::size_type end = payload.find( '\0', pos );
+      if ( end == std::string::npos )
+        end = payload.size();
+      if ( inEnv && end == pos )
+        inEnv = false;
+      else
+        ( inEnv ? env_r : args_r ).push_back( payload.substr( pos, end - pos ) );
+      pos = end + 1;
+    }
+    return ! inEnv;
+  }
+
+  bool sendReply( int conn_r, int exitcode_r )
+  {
+    int32_t reply = exitcode_r;
+    return sendAll( conn_r, &reply, sizeof(reply) );
+  }
+
+  /** Settings determining the content of the pool. A request using different
+   * ones can not be answered from the servers pool.
+   *
+   * \c --plus-repo and \c --plus-content are moved from the config to the
+   * runtime data when the command line is processed, so they are taken from there.
+   */
+  std::string poolSignature( Zypper & zypper_r )
+  {
+    const Config & config { zypper_r.config() };
+    const RepoManagerOptions & rmo { config.rm_options };
+    str::Str ret;
+    ret << config.root_dir << "|" << config.is_install_root << "|"
+    << rmo.knownReposPath << "|" << rmo.knownServicesPath << "|"
+    << rmo.repoCachePath << "|" << rmo.repoRawCachePath << "|" << rmo.repoSolvCachePath << "|" << rmo.repoPackagesCachePath << "|"
+    << config.disable_system_sources << "|" << config.disable_system_resolvables << "|"
+    << config.no_cd << "|" << config.no_remote;
+    for ( const RepoInfo & repo : zypper_r.runtimeData().temporary_repos )
+      ret << "|plus-repo:" << repo.url();
+    for ( const std::string & content : zypper_r.runtimeData().plusContentRepos )
+      ret << "|plus-content:" << content;
+    return ret;
+  }
+
+  /** Whether the request restricts the repos to use (\c -r, \c --repo, \c --from,
+   * or the repo arguments of the query commands like \c packages). The filter is
+   * applied when the repos are loaded, so the servers pool can not answer it.
+   */
+  bool usesRepoFilter( Zypper & zypper_r )
+  {
+    if ( ! InitRepoSettings::instance()._repoFilter.empty() )
+      return true;
+
+    switch ( zypper_r.command().toEnum() )
+    {
+      case ZypperCommand::PACKAGES_e:
+      case ZypperCommand::PATCHES_e:
+      case ZypperCommand::PATTERNS_e:
+      case ZypperCommand::PRODUCTS_e:
+        return ! zypper_r.command().commandObject()->positionalArguments().empty();
+
+      default:
+        return false;
+    }
+  }
+} // namespace
+
+ServerCmd::ServerCmd( std::vector<std::string> &&commandAliases_r ) :
+  ZypperBaseCommand (
+    std::move( commandAliases_r ),
+    // translators: command synopsis; do not translate the command 'name (abbreviations)' or '-option' names
+    _("server [OPTIONS]"),
+    // translators: command summary: server
+    _("Answer read-only queries from a preloaded pool."),
+    // translators: command description
+    _("Load repositories and installed packages once and answer read-only commands like search, info or list-updates forwarded by zypper processes having ZYPPER_SERVER_SOCKET set in their environment."),
+    DefaultSetup
+  )
+{ }
+
+const char * ServerCmd::defaultSocket()
+{ return "/run/zypper-server.sock"; }
+
+bool ServerCmd::mayServe( const ZypperCommand & command_r )
+{
+  switch ( command_r.toEnum() )
+  {
+    case ZypperCommand::SEARCH_e:
+    case ZypperCommand::INFO_e:
+    case ZypperCommand::RUG_PATCH_INFO_e:
+    case ZypperCommand::RUG_PATTERN_INFO_e:
+    case ZypperCommand::RUG_PRODUCT_INFO_e:
+    case ZypperCommand::PACKAGES_e:
+    case ZypperCommand::PATCHES_e:
+    case ZypperCommand::PATTERNS_e:
+    case ZypperCommand::PRODUCTS_e:
+    case ZypperCommand::WHAT_PROVIDES_e:
+    case ZypperCommand::LIST_UPDATES_e:
+    case ZypperCommand::LIST_PATCHES_e:
+    case ZypperCommand::PATCH_CHECK_e:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+zypp::ZyppFlags::CommandGroup ServerCmd::cmdOptions() const
+{
+  auto that = const_cast<ServerCmd *>(this);
+  return {{
+    { "socket", '\0', ZyppFlags::RequiredArgument, ZyppFlags::StringType( &that->_socket, boost::optional<const char *>(), "PATH" ),
+      // translators: --socket <PATH>
+      _("Listen on socket <PATH> instead of $ZYPPER_SERVER_SOCKET or the default.")
+    }
+  }};
+}
+
+void ServerCmd::doReset()
+{
+  _socket.clear();
+}
+
+int ServerCmd::earlyPositionalArgsCheck( Zypper &zypper, const std::vector<std::string> &positionalArgs )
+{
+  if ( !positionalArgs.empty() )
+  {
+    report_too_many_arguments( help() );
+    return ZYPPER_EXIT_ERR_INVALID_ARGS;
+  }
+  if ( zypper.runningShell() )
+  {
+    zypper.out().error(_("The server can not be started from within the zypper shell.") );
+    return ZYPPER_EXIT_ERR_INVALID_ARGS;
+  }
+  return ZYPPER_EXIT_OK;
+}
+
+int ServerCmd::systemSetup( Zypper &zypper )
+{
+  // The server does not hold the zypp lock, so it must not refresh repos.
+  // It picks up the caches built by 'zypper refresh' instead.
+  zypper.configNoConst().no_refresh = true;
+  return ZypperBaseCommand::systemSetup( zypper );
+}
+
+int ServerCmd::execute( Zypper &zypper, const std::vector<std::string> & )
+{
+  Pathname socket { _socket };
+  if ( socket.empty() )
+  {
+    const char * env = ::getenv( "ZYPPER_SERVER_SOCKET" );
+    socket = ( env && *env ) ? env : defaultSocket();
+  }
+
+  std::string err;
+  _listenFd = listenSocket( socket, err );
+  if ( _listenFd < 0 )
+  {
+    zypper.out().error( str::Format(_("Can not listen on socket '%s':")) % socket, err );
+    return ZYPPER_EXIT_ERR_ZYPP;
+  }
+
+  _poolSignature = poolSignature( zypper );
+
+  // Leave the loop on CTRL-C, don't exit immediately.
+  Zypper::SigExitGuard guard( Zypper::sigExitGuard() );
+
+  MIL << "Listening on " << socket << endl;
+  zypper.out().info( str::Format(_("Listening on '%s'.")) % socket );
+  while ( ! zypper.exitRequested() )
+  {
+    struct pollfd pfd = { _listenFd, POLLIN, 0 };
+    int res = ::poll( &pfd, 1, 500 );
+    if ( res <= 0 )
+      continue;	// timeout or EINTR; check for exit request
+
+    int conn = ::accept4( _listenFd, nullptr, nullptr, SOCK_CLOEXEC );
+    if ( conn < 0 )
+      continue;
+    serveConnection( zypper, conn );
+    ::close( conn );
+  }
+
+  ::close( _listenFd );
+  _listenFd = -1;
+  filesystem::unlink( socket );
+  MIL << "Server stopped" << endl;
+  zypper.requestExit( false );
+  return ZYPPER_EXIT_OK;
+}
+
+void ServerCmd::reloadIfChanged( Zypper &zypper )
+{
+  if ( repos_changed_since_load( zypper ) )
+  {
+    MIL << "Repositories changed: reloading" << endl;
+    debug::Measure m( "reload repos" );
+    unload_repos( zypper );
+    zypper.initRepoManager();
+    init_repos( zypper );
+    load_resolvables( zypper );	// the target is reloaded only if the rpmdb changed
+  }
+
+  if ( target_changed_since_load( zypper ) )
+  {
+    MIL << "rpm database changed: reloading target" << endl;
+    debug::Measure m( "reload target" );
+    load_target_resolvables( zypper );
+  }
+
+  // Errors are reported in the servers output; they must not stick to the requests.
+  zypper.setExitCode( ZYPPER_EXIT_OK );
+  zypper.clearExitInfoCode();
+}
+
+void ServerCmd::serveConnection( Zypper &zypper, int conn_r )
+{
+  struct ucred cred {};
+  socklen_t credlen = sizeof(cred);
+  if ( ::getsockopt( conn_r, SOL_SOCKET, SO_PEERCRED, &cred, &credlen ) != 0 || cred.uid != ::geteuid() )
+  {
+    WAR << "Rejecting connection from uid " << cred.uid << endl;
+    return;
+  }
+
+  int fds[3];
+  std::vector<std::string> env;
+  std::vector<std::string> args;
+  if ( ! receiveRequest( conn_r, fds, env, args ) )
+  {
+    WAR << "Bad request from pid " << cred.pid << endl;
+    return;
+  }
+  MIL << "Request from pid " << cred.pid << ": " << args << endl;
+
+  reloadIfChanged( zypper );
+
+  std::cout.flush();
+  std::cerr.flush();
+  ::fflush( nullptr );
+  pid_t pid = ::fork();
+  if ( pid == 0 )
+  {
+    //////////////////////////////////////////////////////////////////////
+    // Zyppers signal handler would clean up the servers tmpdir on exit.
+    ::signal( SIGINT,  SIG_DFL );
+    ::signal( SIGTERM, SIG_DFL );
+    ::signal( SIGPIPE, SIG_DFL );
+    ::close( _listenFd );
+
+    // Run in the clients locale and terminal settings.
+    for ( const char * name : forwardedEnv )
+      ::unsetenv( name );
+    for ( const std::string & entry : env )
+    {
+      std::string::size_type sep = entry.find( '=' );
+      if ( sep != std::string::npos && isForwardedEnv( entry.substr( 0, sep ) ) )
+        ::setenv( entry.substr( 0, sep ).c_str(), entry.c_str() + sep + 1, 1 );
+    }
+    ::setlocale( LC_ALL, "" );
+
+    // The pool was loaded with the servers --plus-repo/--plus-content. Forget
+    // them, so the requests own ones end up in the runtime data and can be
+    // compared (poolSignature).
+    zypper.runtimeData().temporary_repos.clear();
+    zypper.runtimeData().plusContentRepos.clear();
+
+    // Start like a new process would: options are only applied if present,
+    // so the servers own global options (-x, -q, -n, ...) would otherwise
+    // stick to the request. Whatever the servers output writer writes when
+    // it's replaced (e.g. the closing xml tag) is discarded.
+    std::cout.flush();
+    if ( int devnull = ::open( "/dev/null", O_WRONLY | O_CLOEXEC ); devnull >= 0 )
+    {
+      ::dup2( devnull, STDOUT_FILENO );
+      ::close( devnull );
+    }
+    zypper.configNoConst() = Config();
+    zypper.setOutputWriter( new OutNormal( zypper.config().verbosity ) );
+    std::cout.flush();
+
+    // Parsing the global options may already produce output (e.g. the xml
+    // header). Buffer it until we know the request is accepted.
+    FILE * buffer = ::tmpfile();
+    if ( buffer )
+    {
+      ::dup2( ::fileno( buffer ), STDOUT_FILENO );
+      ::dup2( ::fileno( buffer ), STDERR_FILENO );
+    }
+
+    std::vector<char *> argv;
+    argv.push_back( const_cast<char *>( "zypper" ) );
+    for ( std::string & arg : args )
+      argv.push_back( arg.data() );
+    argv.push_back( nullptr );
+
+    int ret = zypper.serverMain( argv.size() - 1, argv.data(), [&]() {
+      if ( ! mayServe( zypper.command() ) || poolSignature( zypper ) != _poolSignature || usesRepoFilter( zypper ) )
+        return false;
+
+      std::cout.flush();
+      std::cerr.flush();
+      ::fflush( nullptr );
+      for ( int i = 0; i < 3; ++i )
+        ::dup2( fds[i], i );
+
+      if ( buffer )
+      {
+        ::rewind( buffer );
+        char buf[4096];
+        size_t n = 0;
+        while ( (n = ::fread( buf, 1, sizeof(buf), buffer )) > 0 )
+        {
+          if ( ::write( STDOUT_FILENO, buf, n ) < 0 )
+            break;
+        }
+      }
+      return true;
+    } );
+
+    std::cout.flush();
+    std::cerr.flush();
+    ::fflush( nullptr );
+    ::_exit( sendReply( conn_r, ret ) ? 0 : 1 );
+    // No sense in returning! I am forked away!!
+    //////////////////////////////////////////////////////////////////////
+  }
+
+  for ( int fd : fds )
+    ::close( fd );
+
+  if ( pid < 0 )
+  {
+    ERR << "fork failed: " << ::strerror( errno ) << endl;
+    sendReply( conn_r, -1 );	// let the client do it
+    return;
+  }
+
+  // The client shuts down its end on CTRL-C or if it's gone.
+  bool killed = false;
+  int status = 0;
+  while ( true )
+  {
+    pid_t res = ::waitpid( pid, &status, WNOHANG );
+    if ( res == pid || ( res < 0 && errno != EINTR ) )
+      break;
+
+    struct pollfd pfd = { conn_r, POLLIN, 0 };
+    if ( ! killed && ( ::poll( &pfd, 1, 100 ) > 0 || zypper.exitRequested() ) )
+    {
+      MIL << "Request canceled: killing " << pid << endl;
+      ::kill( pid, SIGINT );
+      killed = true;
+    }
+    else if ( killed )
+      ::poll( nullptr, 0, 100 );
+  }
+
+  if ( WIFSIGNALED( status ) )
+  {
+    WAR << "Request " << pid << " killed by signal " << WTERMSIG( status ) << endl;
+    sendReply( conn_r, ZYPPER_EXIT_ON_SIGNAL );
+  }
+  else
+    DBG << "Request " << pid << " done" << endl;
+}
+
+std::optional<int> ServerCmd::forwardRequest( const std::string & socket_r, int argc, char ** argv )
+{
+  AutoFD sock { connectSocket( socket_r ) };
+  if ( sock < 0 )
+  {
+    DBG << "No server listening on " << socket_r << endl;
+    return std::nullopt;
+  }
+
+  std::string payload;
+  for ( const char * name : forwardedEnv )
+  {
+    if ( const char * val = ::getenv( name ) )
+    {
+      payload += name;
+      payload += '=';
+      payload += val;
+      payload += '\0';
+    }
+  }
+  payload += '\0';	// end of env
+  for ( int i = 1; i < argc; ++i )
+  {
+    payload += argv[i];
+    payload += '\0';
+  }
+  if ( payload.size() > maxRequestSize || ! sendRequest( sock, payload ) )
+  {
+    WAR << "Failed to send request to " << socket_r << endl;
+    return std::nullopt;
+  }
+
+  int32_t reply = 0;
+  char * buf = reinterpret_cast<char *>( &reply );
+  size_t got = 0;
+  bool interrupted = false;
+  while ( got < sizeof(reply) )
+  {
+    struct pollfd pfd = { sock, POLLIN, 0 };
+    int res = ::poll( &pfd, 1, 500 );
+    if ( res > 0 )
+    {
+      ssize_t n = ::recv( sock, buf + got, sizeof(reply) - got, 0 );
+      if ( n < 0 && errno == EINTR )
+        continue;
+      if ( n <= 0 )
+        break;
+      got += n;
+    }
+    else if ( res < 0 && errno != EINTR )
+      break;
+
+    if ( ! interrupted && Zypper::instance( true ).exitRequested() )
+    {
+      ::shutdown( sock, SHUT_WR );	// tell the server to cancel the request
+      interrupted = true;
+    }
+  }
+
+  if ( got < sizeof(reply) )
+  {
+    ERR << "Lost connection to server " << socket_r << endl;
+    std::cerr << _("Lost connection to the zypper server.") << std::endl;
+    return interrupted ? ZYPPER_EXIT_ON_SIGNAL : ZYPPER_EXIT_ERR_BUG;
+  }
+  if ( reply < 0 )
+  {
+    MIL << "Server refused request; executing it locally" << endl;
+    return std::nullopt;
+  }
+  MIL << "Request served by " << socket_r << ": " << reply << endl;
+  return reply;
+}
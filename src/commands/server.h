@@ -0,0 +1,62 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#ifndef ZYPPER_COMMANDS_SERVER_INCLUDED
+#define ZYPPER_COMMANDS_SERVER_INCLUDED
+
+#include <optional>
+
+#include "commands/basecommand.h"
+#include "utils/flags/zyppflags.h"
+
+struct ZypperCommand;
+
+/**
+ * Keep a loaded pool alive and answer read-only commands forwarded by
+ * zypper processes via a local socket (opt-in via ZYPPER_SERVER_SOCKET).
+ *
+ * Each request is executed in a forked child of the server, so it runs on
+ * a private copy of the pool and the servers state is never modified. Repos
+ * and the target are reloaded between requests only if their change stamps
+ * differ.
+ */
+class ServerCmd : public ZypperBaseCommand
+{
+public:
+  ServerCmd( std::vector<std::string> &&commandAliases_r );
+
+  /** The socket used if neither --socket nor ZYPPER_SERVER_SOCKET are set. */
+  static const char * defaultSocket();
+
+  /** Whether the server may answer \a command_r from its pool. */
+  static bool mayServe( const ZypperCommand & command_r );
+
+  /** Let the server listening on \a socket_r execute the command line.
+   * The server writes to our stdout/stderr directly.
+   * \returns The commands exit code, or nothing if there is no server or
+   * it refused to serve the command. Execute it on your own then.
+   */
+  static std::optional<int> forwardRequest( const std::string & socket_r, int argc, char ** argv );
+
+  // ZypperBaseCommand interface
+protected:
+  zypp::ZyppFlags::CommandGroup cmdOptions() const override;
+  void doReset() override;
+  int earlyPositionalArgsCheck( Zypper &zypper, const std::vector<std::string> &positionalArgs ) override;
+  int systemSetup( Zypper &zypper ) override;
+  int execute( Zypper &zypper, const std::vector<std::string> &positionalArgs ) override;
+
+private:
+  void serveConnection( Zypper &zypper, int conn_r );
+  void reloadIfChanged( Zypper &zypper );
+
+private:
+  std::string _socket;
+  int _listenFd = -1;
+  std::string _poolSignature;	///< settings the pool was loaded with
+};
+
+#endif
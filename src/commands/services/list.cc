@@ -5,6 +5,7 @@
 #include "Table.h"
 
 #include "utils/flags/flagtypes.h"
+#include "output/OutXML.h"
 
 using namespace zypp;
 
@@ -256,6 +257,7 @@ void ListServicesCmd::printXMLServiceList( Zypper &zypper )
 {
   ServiceList services = get_all_services( zypper );
 
+  OutXML::sync( zypper.out() );
   cout << "<service-list>" << endl;
 
   ServiceInfo_Ptr s_ptr;
@@ -6,6 +6,10 @@
 \*---------------------------------------------------------------------------*/
 
 #include <iostream>
+#include <chrono>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <zypp-core/base/LogTools.h>
 #include <zypp/Package.h>
@@ -18,6 +22,8 @@
 
 #include "utils/flags/flagtypes.h"
 #include "utils/messages.h"
+#include "utils/WorkerPool.h"
+#include "output/OutJSON.h"
 #include "Zypper.h"
 #include "PackageArgs.h"
 #include "Table.h"
@@ -50,6 +56,39 @@ namespace
   inline bool isPackageType( const sat::Solvable & slv_r )
   { return( slv_r.isKind<Package>() || slv_r.isKind<SrcPackage>() ); }
 
+  /** Whether \a name_r is matched literally by a glob PoolQuery. */
+  inline bool isExactName( const std::string & name_r )
+  { return name_r.find_first_of( "*?[" ) == std::string::npos; }
+
+  /** The not installed packages whose names are in \a names_r (lowercase).
+   * One pass over the pool instead of a PoolQuery per name. Like the glob
+   * PoolQuery it replaces, names are compared case insensitive. The result
+   * is keyed by the lowercase name, solvables are in pool order.
+   */
+  std::unordered_map<std::string,std::vector<sat::Solvable>> packagesByName( const std::unordered_set<std::string> & names_r )
+  {
+    std::unordered_map<std::string,std::vector<sat::Solvable>> ret;
+    if ( names_r.empty() )
+      return ret;
+
+    std::unordered_map<IdString::IdType,const std::string*> seen;	// ident -> requested name or nullptr
+    for ( const sat::Solvable & slv : sat::Pool::instance().solvables() )
+    {
+      if ( ! slv.isKind<Package>() || slv.isSystem() )
+        continue;
+
+      auto it = seen.find( slv.ident().id() );
+      if ( it == seen.end() )
+      {
+        auto name = names_r.find( str::toLower( slv.name() ) );
+        it = seen.emplace( slv.ident().id(), name == names_r.end() ? nullptr : &*name ).first;
+      }
+      if ( it->second )
+        ret[*it->second].push_back( slv );
+    }
+    return ret;
+  }
+
   // Valid for Package and SrcPackage
   bool isCached( const PoolItem & pi_r )
   { return ( pi_r.isKind<Package>() && pi_r->asKind<Package>()->isCached() )
@@ -83,6 +122,139 @@ namespace
     }
   }
 
+  inline void logJsonResult( const PoolItem & pi_r, const Pathname & localfile_r )
+  {
+    // {"event":"download-result","solvable":{...},"localfile":"/path/to.rpm"}
+    // "localfile":null on error
+    const sat::Solvable & slv { pi_r.satSolvable() };
+    jsonout::Object edition;
+    edition.add( "epoch", slv.edition().epoch() )
+           .add( "version", slv.edition().version() )
+           .add( "release", slv.edition().release() );
+    jsonout::Object repository;
+    repository.add( "name", slv.repository().name() )
+              .add( "alias", slv.repository().alias() );
+    jsonout::Object solvable;
+    solvable.add( "kind", slv.kind().asString() )
+            .add( "name", slv.name() )
+            .add( "edition", edition )
+            .add( "arch", slv.arch().asString() )
+            .add( "repository", repository );
+
+    jsonout::Object event;
+    event.add( "solvable", solvable );
+    if ( localfile_r.empty() )
+      event.addRaw( "localfile", "null" );
+    else
+      event.add( "localfile", localfile_r.asString() );
+    OutJSON::writeEvent( "download-result", event );
+  }
+
+  /** The \c download-result for machine readable output. */
+  inline void logResult( const PoolItem & pi_r, const Pathname & localfile_r )
+  {
+    const Out & out { Zypper::instance().out() };
+    if ( out.typeXML() )
+      logXmlResult( pi_r, localfile_r );
+    else if ( OutJSON::typeJSON( out ) )
+      logJsonResult( pi_r, localfile_r );
+  }
+
+  /** Download \a items_r using up to \a jobs_r worker processes, at most \a jobsPerHost_r
+   * of them retrieving packages from the same server.
+   *
+   * Each package is downloaded into the package cache by a forked worker (libzypp is
+   * not thread safe). The workers don't prompt, failed downloads are reported after all
+   * are done. A \c download-result node is written for each package as soon as its
+   * worker finished.
+   */
+  int downloadInParallel( Zypper & zypper, const std::vector<PoolItem> & items_r, unsigned jobs_r, unsigned jobsPerHost_r )
+  {
+    // One lane per server
+    std::map<std::string,unsigned> lanes;
+    std::vector<unsigned> itemLane;
+    ByteCount bytesTotal;
+    for ( const PoolItem & pi : items_r )
+    {
+      itemLane.push_back( lanes.emplace( pi.repoInfo().url().getHost(), lanes.size() ).first->second );
+      bytesTotal += pi.downloadSize();
+    }
+
+    WorkerPool pool( std::vector<unsigned>( lanes.size(), jobsPerHost_r ), jobs_r );
+    MIL << "Parallel download of " << items_r.size() << " packages (" << bytesTotal << ") from " << lanes.size()
+        << " servers using " << pool.maxTotal() << " jobs, " << jobsPerHost_r << " per server" << endl;
+
+    unsigned done = 0;
+    ByteCount bytesDone;
+    std::vector<std::pair<PoolItem,std::string>> failed;	// and the workers output
+    const auto start { std::chrono::steady_clock::now() };
+    auto throughput = [&]() -> ByteCount {
+      double secs = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      return ByteCount( secs > 0 ? ByteCount::SizeType( double(bytesDone) / secs ) : 0 );
+    };
+
+    {
+      Out::ProgressBar report( zypper.out(), "parallel-download", _("Downloading packages") );
+      report->range( items_r.size() );
+
+      for ( unsigned idx = 0; idx < items_r.size(); ++idx )
+      {
+        const PoolItem & pi { items_r[idx] };
+        pool.enqueue( [&zypper,pi]()->int {
+                        // Workers never prompt; errors are captured, the rest is not of interest.
+                        zypper.configNoConst().non_interactive = true;
+                        zypper.out().setVerbosity( Out::QUIET );
+                        target::CommitPackageCache packageCache;
+                        ManagedFile localfile { packageCache.get( pi ) };
+                        localfile.resetDispose();
+                        return localfile->empty() ? 1 : 0;
+                      },
+                      [&,pi]( int exitcode_r, const std::string & output_r ) {
+                        Pathname localfile;
+                        if ( exitcode_r == 0 && isCached( pi ) )
+                        {
+                          localfile = cachedLocation( pi );
+                          ++done;
+                          bytesDone += pi.downloadSize();
+                        }
+                        else
+                        {
+                          WAR << "Worker for " << pi << " returned " << exitcode_r << endl;
+                          failed.push_back( { pi, output_r } );
+                        }
+                        logResult( pi, localfile );
+
+                        report->incr();
+                        // translators: progress label; %1% and %2% are numbers of packages, %3% is a download rate like '1.5 MiB'
+                        report.print( str::Format(_("Downloading packages (%1% of %2%, %3%/s)")) % (done+failed.size()) % items_r.size() % throughput() );
+                      },
+                      itemLane[idx] );
+      }
+
+      while ( pool.waitOne() )
+      {
+        if ( zypper.exitRequested() )
+        {
+          pool.cancel();
+          report.error();
+          break;
+        }
+      }
+      if ( ! failed.empty() )
+        report.error();
+    }
+    MIL << "Parallel download: " << done << " packages (" << bytesDone << ") at " << throughput() << "/s, " << failed.size() << " failed" << endl;
+
+    for ( const auto & el : failed )
+      zypper.out().error( str::Format(_("Error downloading package '%s'.")) % el.first.asUserString(), str::trim( el.second ) );
+
+    if ( zypper.exitRequested() )
+      return ZYPPER_EXIT_ON_SIGNAL;
+
+    zypper.out().info( str::Format(_("Downloaded %1% packages (%2%, %3%/s).")) % done % bytesDone % throughput() );
+    return ZYPPER_EXIT_OK;
+  }
+
   /** Whether user may create \a dir_r or has rw-access to it. */
   inline bool userMayUseDir( const Pathname & dir_r )
   {
@@ -169,12 +341,22 @@ ZyppFlags::CommandGroup DownloadCmd::cmdOptions() const
         // translators: --from <ALIAS|#|URI>
         _("Select packages from the specified repository.")
       },
+      { "jobs", 'j', ZyppFlags::RequiredArgument, ZyppFlags::IntType( &that->_jobs ),
+        // translators: -j, --jobs <INTEGER>
+        _("Download up to this number of packages at the same time. Default is taken from zypper.conf (main.downloadJobs).")
+      },
+      { "jobs-per-host", '\0', ZyppFlags::RequiredArgument, ZyppFlags::IntType( &that->_jobsPerHost ),
+        // translators: --jobs-per-host <INTEGER>
+        _("Download at most this number of packages from the same server at the same time. Default is taken from zypper.conf (main.downloadJobsPerHost).")
+      },
   }};
 }
 
 void DownloadCmd::doReset()
 {
   _allMatches = false;
+  _jobs = 0;
+  _jobsPerHost = 0;
 }
 
 std::vector<BaseCommandConditionPtr> DownloadCmd::conditions() const
@@ -203,34 +385,78 @@ int DownloadCmd::execute( Zypper &zypper , const std::vector<std::string> &posit
     // parse package arguments
     PackageArgs::Options argopts;
     PackageArgs args( positionalArgs_r, ResKind::package, argopts );
+
+    // Exact names are looked up in one pass over the pool
+    std::unordered_set<std::string> exactNames;
+    for ( const auto & pkgspec : args.dos() )
+    {
+      const std::string & name { pkgspec.parsed_cap.detail().name().asString() };
+      if ( isExactName( name ) )
+        exactNames.insert( str::toLower( name ) );
+    }
+    const auto byName { packagesByName( exactNames ) };
+    MIL << "Resolving " << args.dos().size() << " arguments: " << exactNames.size() << " exact names, " << byName.size() << " found" << endl;
+
     for ( const auto & pkgspec : args.dos() )
     {
       const Capability & cap( pkgspec.parsed_cap );
       const CapDetail & capDetail( cap.detail() );
 
-      PoolQuery q;
-      q.setMatchGlob();
-      q.setUninstalledOnly();
-      q.addKind( ResKind::package );
-      if ( ! pkgspec.repo_alias.empty() )
-        q.addRepo( pkgspec.repo_alias );
-      //for_ ( it, repos.begin(), repos.end() ) q.addRepo(*it);
-      // try matching names first
-      q.addDependency( sat::SolvAttr::name,
-                       capDetail.name().asString(),
-                       capDetail.op(),			// defaults to Rel::ANY (NOOP) if no versioned cap
-                       capDetail.ed(),
-                       Arch( capDetail.arch() ) );	// defaults Arch_empty (NOOP) if no arch in cap
-
-      // no natch on names, do try provides
-      if ( q.empty() )
-        q.addDependency( sat::SolvAttr::dep_provides,
-                         capDetail.name().asString(),
-                         capDetail.op(),		// defaults to Rel::ANY (NOOP) if no versioned cap
-                         capDetail.ed(),
-                         Arch( capDetail.arch() ) );	// defaults Arch_empty (NOOP) if no arch in cap
-
-      if ( q.empty() || !isPackageType( *q.begin() ) )
+      std::vector<sat::Solvable> matches;
+      if ( isExactName( capDetail.name().asString() ) )
+      {
+        // try matching names first
+        auto it = byName.find( str::toLower( capDetail.name().asString() ) );
+        if ( it != byName.end() )
+        {
+          Arch arch( capDetail.arch() );	// defaults Arch_empty (NOOP) if no arch in cap
+          for ( const sat::Solvable & slv : it->second )
+          {
+            if ( ! pkgspec.repo_alias.empty() && slv.repository().alias() != pkgspec.repo_alias )
+              continue;
+            if ( capDetail.op() != Rel::ANY
+                 && ! overlaps( Edition::MatchRange( Rel::EQ, slv.edition() ), Edition::MatchRange( capDetail.op(), capDetail.ed() ) ) )
+              continue;
+            if ( ! arch.empty() && slv.arch() != arch )
+              continue;
+            matches.push_back( slv );
+          }
+        }
+      }
+
+      if ( matches.empty() )
+      {
+        PoolQuery q;
+        q.setMatchGlob();
+        q.setUninstalledOnly();
+        q.addKind( ResKind::package );
+        if ( ! pkgspec.repo_alias.empty() )
+          q.addRepo( pkgspec.repo_alias );
+        //for_ ( it, repos.begin(), repos.end() ) q.addRepo(*it);
+        // try matching names first (unless already done)
+        bool nameMatch = false;
+        if ( ! isExactName( capDetail.name().asString() ) )
+        {
+          q.addDependency( sat::SolvAttr::name,
+                           capDetail.name().asString(),
+                           capDetail.op(),		// defaults to Rel::ANY (NOOP) if no versioned cap
+                           capDetail.ed(),
+                           Arch( capDetail.arch() ) );	// defaults Arch_empty (NOOP) if no arch in cap
+          nameMatch = ! q.empty();
+        }
+
+        // no natch on names, do try provides
+        if ( ! nameMatch )
+          q.addDependency( sat::SolvAttr::dep_provides,
+                           capDetail.name().asString(),
+                           capDetail.op(),		// defaults to Rel::ANY (NOOP) if no versioned cap
+                           capDetail.ed(),
+                           Arch( capDetail.arch() ) );	// defaults Arch_empty (NOOP) if no arch in cap
+
+        matches.assign( q.begin(), q.end() );
+      }
+
+      if ( matches.empty() || !isPackageType( matches.front() ) )
       {
         // translators: Label text; is followed by ': cmdline argument'
         zypper.out().error( str::Str() << _("Argument resolves to no package") << ": " << pkgspec.orig_str );
@@ -240,9 +466,9 @@ int DownloadCmd::execute( Zypper &zypper , const std::vector<std::string> &posit
         continue;
       }
 
-      AvailableItemSet & avset( collect[(*q.begin()).ident()] );
+      AvailableItemSet & avset( collect[matches.front().ident()] );
       zypper.out().info( str::Str() << pkgspec.orig_str << ": ", Out::HIGH );
-      for ( const sat::Solvable & solvable : q )
+      for ( const sat::Solvable & solvable : matches )
       {
         avset.insert( PoolItem( solvable ) );
         zypper.out().info( str::Str() << "  " << solvable.asUserString(), Out::HIGH );
@@ -273,6 +499,10 @@ int DownloadCmd::execute( Zypper &zypper , const std::vector<std::string> &posit
       zypper.out().info( str::Str() << _("Not downloading anything...") << " (--dry-run)" );
     }
 
+    unsigned jobs = _jobs > 0 ? _jobs : zypper.config().download_jobs;
+    unsigned jobsPerHost = _jobsPerHost > 0 ? _jobsPerHost : zypper.config().download_jobsPerHost;
+    std::vector<PoolItem> toDownload;	// with --jobs: downloaded in parallel afterwards
+
     // Prepare the package cache. Pass all items requiring download.
     target::CommitPackageCache packageCache;
 
@@ -286,7 +516,11 @@ int DownloadCmd::execute( Zypper &zypper , const std::vector<std::string> &posit
 
         if ( ! isCached( pi ) )
         {
-          if ( !DryRunSettings::instance().isEnabled() )
+          if ( !DryRunSettings::instance().isEnabled() && jobs > 1 )
+          {
+            toDownload.push_back( pi );
+          }
+          else if ( !DryRunSettings::instance().isEnabled() )
           {
             ManagedFile localfile;
             try
@@ -317,8 +551,7 @@ int DownloadCmd::execute( Zypper &zypper , const std::vector<std::string> &posit
 
             //DBG << localfile << endl;
             localfile.resetDispose();
-            if ( zypper.out().typeXML() )
-              logXmlResult( pi, localfile );
+            logResult( pi, localfile );
 
             if ( zypper.exitRequested() )
               return ZYPPER_EXIT_ON_SIGNAL;
@@ -334,13 +567,15 @@ int DownloadCmd::execute( Zypper &zypper , const std::vector<std::string> &posit
         {
           const Pathname &  localfile( cachedLocation( pi ) );
           Out::ProgressBar report( zypper.out(), localfile.asString(), current, total );
-          if ( zypper.out().typeXML() )
-            logXmlResult( pi, localfile );
+          logResult( pi, localfile );
         }
 
         if ( !_allMatches )
           break;	// first==best version only.
       }
     }
+
+    if ( ! toDownload.empty() )
+      return downloadInParallel( zypper, toDownload, jobs, jobsPerHost );
     return ZYPPER_EXIT_OK;
 }
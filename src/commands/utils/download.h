@@ -45,6 +45,8 @@ private:
   DryRunOptionSet _dryRun { *this };
   InitReposOptionSet _initRepos { *this };
   bool _allMatches = false;
+  int _jobs = 0;		///< 0: use zypper.conf
+  int _jobsPerHost = 0;		///< 0: use zypper.conf
 
 
   // ZypperBaseCommand interface
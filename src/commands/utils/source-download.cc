@@ -7,6 +7,7 @@
 
 #include "source-download.h"
 #include <iostream>
+#include <map>
 
 #include <zypp-core/base/LogTools.h>
 #include <zypp/ResPool.h>
@@ -20,6 +21,7 @@
 #include "Table.h"
 #include "utils/flags/flagtypes.h"
 #include "utils/messages.h"
+#include "utils/WorkerPool.h"
 
 using namespace zypp;
 
@@ -28,6 +30,8 @@ const std::string SourceDownloadCmd::Options::_manifestName( "MANIFEST" );
 
 namespace Pimpl
 {
+  /** Suffix of a source package being stored in the download directory. */
+  const std::string partSuffix { ".part" };
 
   inline std::ostream & operator<<( std::ostream & str, const SourceDownloadCmd::Options & obj )
   {
@@ -147,6 +151,23 @@ namespace Pimpl
     /** Startup and build manifest. */
     void buildManifest();
 
+    /** Whether the required source packages in the download directory match the repositories checksum.
+     * Mismatching ones are marked as missing, so they are downloaded again.
+     */
+    void verifyDownloaded( unsigned jobs_r );
+
+    /** Download the missing source packages using up to \a jobs_r worker processes,
+     * at most \a jobsPerHost_r of them retrieving from the same server.
+     */
+    void downloadInParallel( unsigned jobs_r, unsigned jobsPerHost_r );
+
+    /** Hardlink/copy \a localfile_r into the download directory.
+     * The file is stored under a temporary name and renamed when complete, so an
+     * interrupted download does not leave a partial source package behind.
+     * \return \c 0 or the \c errno of the failed operation.
+     */
+    int storeSrcPackage( const Pathname & localfile_r, const SourcePkg & spkg_r ) const;
+
     std::ostream & dumpManifestSumary( std::ostream & str, Manifest::StatusMap & status );
     std::ostream & dumpManifestTable( std::ostream & str );
 
@@ -237,6 +258,15 @@ namespace Pimpl
         if ( file == _options._manifestName )
           continue;
 
+        if ( str::endsWith( file, partSuffix ) )
+        {
+          // left behind by an interrupted download
+          MIL << "Partial download " << file << endl;
+          if ( ! _options._dryrun )
+            filesystem::unlink( pi.path() / file );
+          continue;
+        }
+
         using target::rpm::RpmHeader;
         Pathname path( pi.path() / file );
         RpmHeader::constPtr pkg( RpmHeader::readPackage( path, RpmHeader::NOVERIFY ) );
@@ -402,9 +432,25 @@ namespace Pimpl
       _zypper.out().info( msg );
     }
 
+    // re-download packages not matching the repositories checksum
+
+    unsigned jobs = _options._jobs > 0 ? _options._jobs : _zypper.config().download_jobs;
+    unsigned jobsPerHost = _options._jobsPerHost > 0 ? _options._jobsPerHost : _zypper.config().download_jobsPerHost;
+
+    if ( status[SourcePkg::S_OK] )
+    {
+      verifyDownloaded( jobs );
+      _manifest.updateStatus( status );
+    }
+
     // download missing packages
 
-    if ( status[SourcePkg::S_MISSING] )
+    if ( status[SourcePkg::S_MISSING] && jobs > 1 )
+    {
+      _zypper.out().info(_("Downloading required source packages...") );
+      downloadInParallel( jobs, jobsPerHost );
+    }
+    else if ( status[SourcePkg::S_MISSING] )
     {
       _zypper.out().info(_("Downloading required source packages...") );
       repo::RepoMediaAccess access;
@@ -438,13 +484,12 @@ namespace Pimpl
             report.error( false );
           }
 
-          if ( filesystem::hardlinkCopy( localfile, _dnlDir / (spkg._longname+".rpm") ) != 0 )
+          if ( int err = storeSrcPackage( localfile, spkg ) )
           {
-            ERR << "Can't hardlink/copy " << localfile << " to " <<  (_dnlDir / spkg._longname) << endl;
             report.error();
             throw( Out::Error( ZYPPER_EXIT_ERR_BUG,
                                str::Format(_("Error downloading source package '%s'.")) % spkg._longname,
-                               Errno().asString() ) );
+                               Errno( err ).asString() ) );
           }
           spkg._localFile = spkg._longname;
         }
@@ -471,6 +516,195 @@ namespace Pimpl
       _zypper.out().info(_("No source packages to download.") );
     }
   }
+
+  int SourceDownloadImpl::storeSrcPackage( const Pathname & localfile_r, const SourcePkg & spkg_r ) const
+  {
+    Pathname target { _dnlDir / (spkg_r._longname+".rpm") };
+    Pathname part { target.extend( partSuffix ) };
+
+    // the filesystem functions return 0 or the errno
+    int err = filesystem::hardlinkCopy( localfile_r, part );
+    if ( err == 0 )
+    {
+      err = filesystem::rename( part, target );
+      if ( err == 0 )
+        return 0;
+      ERR << "Can't rename " << part << " to " << target << ": " << Errno( err ).asString() << endl;
+    }
+    else
+      ERR << "Can't hardlink/copy " << localfile_r << " to " << part << ": " << Errno( err ).asString() << endl;
+
+    filesystem::unlink( part );
+    return err;
+  }
+
+  void SourceDownloadImpl::verifyDownloaded( unsigned jobs_r )
+  {
+    std::vector<SourcePkg*> todo;
+    for ( auto & item : _manifest )
+    {
+      SourcePkg & spkg( item.second );
+      if ( spkg.status() == SourcePkg::S_OK && spkg.lookupSrcPackage()
+           && ! spkg._srcPackage->asKind<SrcPackage>()->checksum().empty() )
+        todo.push_back( &spkg );
+    }
+    if ( todo.empty() )
+      return;
+
+    // Reading all the files is I/O bound, so the workers just compute the checksums.
+    unsigned mismatch = 0;
+    {
+      Out::ProgressBar report( _zypper.out(), _("Verifying source packages in download directory") );
+      report->range( todo.size() );
+
+      auto verify = []( const Pathname & path_r, const CheckSum & cs_r )->int {
+        return filesystem::checksum( path_r, cs_r.type() ) == cs_r.checksum() ? 0 : 1;
+      };
+      auto verified = [&]( SourcePkg * spkg_r, int exitcode_r ) {
+        if ( exitcode_r != 0 )
+        {
+          WAR << "Checksum mismatch " << spkg_r->_localFile << " (" << spkg_r->_srcPackage << ")" << endl;
+          filesystem::unlink( _dnlDir / spkg_r->_localFile );
+          spkg_r->_localFile.clear();	// download it again
+          ++mismatch;
+        }
+        report->incr();
+      };
+
+      if ( jobs_r < 2 )
+      {
+        // no need to fork
+        for ( SourcePkg * spkg : todo )
+        {
+          verified( spkg, verify( _dnlDir/spkg->_localFile, spkg->_srcPackage->asKind<SrcPackage>()->checksum() ) );
+          if ( _zypper.exitRequested() )
+          {
+            report.error();
+            break;
+          }
+        }
+      }
+      else
+      {
+        WorkerPool pool( jobs_r );
+        for ( SourcePkg * spkg : todo )
+        {
+          pool.enqueue( [verify,path=_dnlDir/spkg->_localFile,cs=spkg->_srcPackage->asKind<SrcPackage>()->checksum()]()->int {
+                          return verify( path, cs );
+                        },
+                        [&verified,spkg]( int exitcode_r, const std::string & ) {
+                          verified( spkg, exitcode_r );
+                        } );
+        }
+
+        while ( pool.waitOne() )
+        {
+          if ( _zypper.exitRequested() )
+          {
+            pool.cancel();
+            report.error();
+            break;
+          }
+        }
+      }
+    }
+    if ( _zypper.exitRequested() )
+      throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
+
+    if ( mismatch )
+      _zypper.out().info( str::Format(PL_("%1% source package in the download directory does not match the repository and will be downloaded again.",
+                                          "%1% source packages in the download directory do not match the repository and will be downloaded again.",
+                                          mismatch)) % mismatch );
+  }
+
+  void SourceDownloadImpl::downloadInParallel( unsigned jobs_r, unsigned jobsPerHost_r )
+  {
+    // One lane per server
+    std::map<std::string,unsigned> lanes;
+    std::vector<SourcePkg*> todo;
+    std::vector<unsigned> todoLane;
+    for ( auto & item : _manifest )
+    {
+      SourcePkg & spkg( item.second );
+      if ( spkg.status() != SourcePkg::S_MISSING )
+        continue;
+
+      if ( ! spkg.lookupSrcPackage() )
+      {
+        _zypper.out().error( str::Format(_("Source package '%s' is not provided by any repository.")) % spkg._longname );
+        continue;
+      }
+      todo.push_back( &spkg );
+      todoLane.push_back( lanes.emplace( spkg._srcPackage.repoInfo().url().getHost(), lanes.size() ).first->second );
+    }
+    if ( todo.empty() )
+      return;
+
+    WorkerPool pool( std::vector<unsigned>( lanes.size(), jobsPerHost_r ), jobs_r );
+    MIL << "Parallel download of " << todo.size() << " source packages from " << lanes.size()
+        << " servers using " << pool.maxTotal() << " jobs, " << jobsPerHost_r << " per server" << endl;
+
+    unsigned done = 0;
+    std::vector<std::pair<SourcePkg*,std::string>> failed;	// and the workers output
+    {
+      Out::ProgressBar report( _zypper.out(), "parallel-source-download", _("Downloading required source packages") );
+      report->range( todo.size() );
+
+      for ( unsigned idx = 0; idx < todo.size(); ++idx )
+      {
+        SourcePkg * spkg { todo[idx] };
+        pool.enqueue( [this,spkg]()->int {
+                        // Workers never prompt; errors are captured, the rest is not of interest.
+                        _zypper.configNoConst().non_interactive = true;
+                        _zypper.out().setVerbosity( Out::QUIET );
+                        repo::RepoMediaAccess access;
+                        repo::SrcPackageProvider prov( access );
+                        ManagedFile localfile { prov.provideSrcPackage( spkg->_srcPackage->asKind<SrcPackage>() ) };
+                        if ( int err = storeSrcPackage( localfile, *spkg ) )
+                        {
+                          cerr << Errno( err ).asString() << endl;
+                          return 1;
+                        }
+                        return 0;
+                      },
+                      [&,spkg]( int exitcode_r, const std::string & output_r ) {
+                        if ( exitcode_r == 0 )
+                        {
+                          MIL << spkg->_srcPackage << endl;
+                          spkg->_localFile = spkg->_longname;
+                          ++done;
+                        }
+                        else
+                        {
+                          WAR << "Worker for " << spkg->_srcPackage << " returned " << exitcode_r << endl;
+                          failed.push_back( { spkg, output_r } );
+                        }
+                        report->incr();
+                        // translators: progress label; %1% and %2% are numbers of source packages
+                        report.print( str::Format(_("Downloading required source packages (%1% of %2%)")) % (done+failed.size()) % todo.size() );
+                      },
+                      todoLane[idx] );
+      }
+
+      while ( pool.waitOne() )
+      {
+        if ( _zypper.exitRequested() )
+        {
+          pool.cancel();
+          report.error();
+          break;
+        }
+      }
+      if ( ! failed.empty() )
+        report.error();
+    }
+
+    for ( const auto & el : failed )
+      _zypper.out().error( str::Format(_("Error downloading source package '%s'.")) % el.first->_longname, str::trim( el.second ) );
+
+    if ( _zypper.exitRequested() )
+      throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
+  }
 } // namespace
 
 SourceDownloadCmd::SourceDownloadCmd(std::vector<std::string> &&commandAliases_r) :
@@ -503,6 +737,14 @@ ZyppFlags::CommandGroup SourceDownloadCmd::cmdOptions() const
         "status", '\0', ZyppFlags::NoArgument, ZyppFlags::BoolType( &that->_opt._dryrun, ZyppFlags::StoreTrue ),
             // translators: --status
             _("Don't download any source rpms, but show which source rpms are missing or extraneous.")
+      }, {
+        "jobs", 'j', ZyppFlags::RequiredArgument, ZyppFlags::IntType( &that->_opt._jobs ),
+            // translators: -j, --jobs <INTEGER>
+            _("Download up to this number of source rpms at the same time. Default is taken from zypper.conf (main.downloadJobs).")
+      }, {
+        "jobs-per-host", '\0', ZyppFlags::RequiredArgument, ZyppFlags::IntType( &that->_opt._jobsPerHost ),
+            // translators: --jobs-per-host <INTEGER>
+            _("Download at most this number of source rpms from the same server at the same time. Default is taken from zypper.conf (main.downloadJobsPerHost).")
       },
   },
   {
@@ -518,6 +760,8 @@ void SourceDownloadCmd::doReset()
 //  _opt._manifest = true;
   _opt._delete = true;
   _opt._dryrun = false;
+  _opt._jobs = 0;
+  _opt._jobsPerHost = 0;
 }
 
 int SourceDownloadCmd::execute( Zypper &zypper, const std::vector<std::string> &positionalArgs_r )
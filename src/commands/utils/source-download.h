@@ -52,6 +52,8 @@ public:
   //   bool _manifest;                      //< Whether to write a MANIFEST file.
     bool _delete = true;                    //< Whether to delete extranous source rpms.
     bool _dryrun = false;                   //< Dryrun mode.
+    int _jobs = 0;                          //< Parallel downloads (0: zypper.conf).
+    int _jobsPerHost = 0;                   //< Parallel downloads per server (0: zypper.conf).
   };
 
   friend class Pimpl::SourceDownloadImpl;
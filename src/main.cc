@@ -18,6 +18,7 @@
 #include "callbacks/locks.h"
 #include "callbacks/job.h"
 #include "output/OutNormal.h"
+#include "commands/server.h"
 #include "utils/messages.h"
 
 namespace env
@@ -190,6 +191,14 @@ try {
   }
 
   int & exitcode { say_goodbye.exitcode };
+
+  // Opt-in: let a running 'zypper server' answer read-only commands from its preloaded pool.
+  if ( const char * serversocket = ::getenv( "ZYPPER_SERVER_SOCKET" ); serversocket && *serversocket )
+  {
+    if ( std::optional<int> served { ServerCmd::forwardRequest( serversocket, argc, argv ) } )
+      return exitcode = *served;
+  }
+
   exitcode = zypper.main( argc, argv );
   if ( !exitcode )
     exitcode = zypper.exitInfoCode();	// propagate refresh errors even if main action succeeded
@@ -0,0 +1,298 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <zypp-core/base/String.h>
+
+#include "OutJSON.h"
+#include "OutXML.h"
+#include "utils/misc.h"
+
+using std::cout;
+using std::endl;
+
+namespace jsonout
+{
+  namespace
+  {
+    /** Length of the valid UTF-8 sequence at \a str_r[pos_r] or \c 0. */
+    unsigned utf8SequenceLength( const std::string & str_r, std::string::size_type pos_r )
+    {
+      unsigned char ch = str_r[pos_r];
+      unsigned len = 0;
+      unsigned char min = 0x80;	// lower bound of the 2nd byte (overlong, surrogates)
+      unsigned char max = 0xBF;	// upper bound of the 2nd byte
+      if ( ch >= 0xC2 && ch <= 0xDF )
+        len = 2;
+      else if ( ch >= 0xE0 && ch <= 0xEF )
+      {
+        len = 3;
+        if ( ch == 0xE0 ) min = 0xA0;
+        if ( ch == 0xED ) max = 0x9F;
+      }
+      else if ( ch >= 0xF0 && ch <= 0xF4 )
+      {
+        len = 4;
+        if ( ch == 0xF0 ) min = 0x90;
+        if ( ch == 0xF4 ) max = 0x8F;
+      }
+      else
+        return 0;
+
+      if ( str_r.size() - pos_r < len )
+        return 0;
+      for ( unsigned i = 1; i < len; ++i )
+      {
+        unsigned char cont = str_r[pos_r+i];
+        if ( i == 1 ? ( cont < min || cont > max ) : ( cont < 0x80 || cont > 0xBF ) )
+          return 0;
+      }
+      return len;
+    }
+  } // namespace
+
+  std::string quote( const std::string & str_r )
+  {
+    std::string ret;
+    ret.reserve( str_r.size() + 2 );
+    ret += '"';
+    for ( std::string::size_type pos = 0; pos < str_r.size(); ++pos )
+    {
+      char ch = str_r[pos];
+      if ( (unsigned char)ch >= 0x80 )
+      {
+        // JSON must be valid UTF-8: invalid bytes become U+FFFD
+        if ( unsigned len = utf8SequenceLength( str_r, pos ) )
+        {
+          ret.append( str_r, pos, len );
+          pos += len - 1;
+        }
+        else
+          ret += "\xEF\xBF\xBD";
+        continue;
+      }
+      switch ( ch )
+      {
+        case '"':  ret += "\\\""; break;
+        case '\\': ret += "\\\\"; break;
+        case '\b': ret += "\\b"; break;
+        case '\f': ret += "\\f"; break;
+        case '\n': ret += "\\n"; break;
+        case '\r': ret += "\\r"; break;
+        case '\t': ret += "\\t"; break;
+        default:
+          if ( (unsigned char)ch < 0x20 )
+            ret += str::form( "\\u%04x", (unsigned char)ch );
+          else
+            ret += ch;
+          break;
+      }
+    }
+    ret += '"';
+    return ret;
+  }
+
+  Object & Object::addRaw( const std::string & key_r, const std::string & json_r )
+  {
+    if ( ! _body.empty() )
+      _body += ',';
+    _body += quote( key_r );
+    _body += ':';
+    _body += json_r;
+    return *this;
+  }
+
+  Array & Array::addRaw( const std::string & json_r )
+  {
+    if ( ! _body.empty() )
+      _body += ',';
+    _body += json_r;
+    return *this;
+  }
+} // namespace jsonout
+
+void OutJSON::writeEvent( const std::string & name_r, const jsonout::Object & event_r )
+{
+  // "event" goes first, so a consumer may dispatch on a prefix of the line
+  std::string members { event_r.str() };
+  cout << "{\"event\":" << jsonout::quote( name_r );
+  if ( ! event_r.empty() )
+    cout << ',' << members.substr( 1 );	// skip the '{'
+  else
+    cout << '}';
+  cout << endl;
+}
+
+OutJSON::OutJSON( Verbosity verbosity_r )
+: Out( TYPE_JSON, verbosity_r )
+{}
+
+OutJSON::~OutJSON()
+{}
+
+bool OutJSON::mine( Type type )
+{
+  // Messages for machine readable output are mine (TYPE_NORMAL is just decoration)
+  if ( type & Out::TYPE_XML || type & TYPE_JSON )
+    return true;
+  return false;
+}
+
+bool OutJSON::infoWarningFilter( Verbosity verbosity_r, Type mask )
+{
+  if ( !mine(mask) )
+    return true;
+  if ( verbosity() < verbosity_r )
+    return true;
+  return false;
+}
+
+void OutJSON::writeMessage( const std::string & type_r, const std::string & text_r, const std::string & hint_r )
+{
+  jsonout::Object event;
+  event.add( "type", type_r ).add( "text", text_r );
+  if ( ! hint_r.empty() )
+    event.add( "hint", hint_r );
+  writeEvent( "message", event );
+}
+
+void OutJSON::info( const std::string & msg, Verbosity verbosity_r, Type mask )
+{
+  if ( infoWarningFilter( verbosity_r, mask ) )
+    return;
+
+  writeMessage( "info", msg );
+}
+
+void OutJSON::warning( const std::string & msg, Verbosity verbosity_r, Type mask )
+{
+  if ( infoWarningFilter( verbosity_r, mask) )
+    return;
+
+  writeMessage( "warning", msg );
+}
+
+void OutJSON::error( const std::string & problem_desc, const std::string & hint )
+{
+  writeMessage( "error", problem_desc, hint );
+}
+
+void OutJSON::error( const zypp::Exception & e, const std::string & problem_desc, const std::string & hint )
+{
+  std::ostringstream s;
+  // problem
+  s << problem_desc << endl;
+  // cause
+  s << zyppExceptionReport( e );
+
+  writeMessage( "error", s.str(), hint );
+}
+
+void OutJSON::progressStart( const std::string & id, const std::string & label, bool has_range )
+{
+  if ( progressFilter() )
+    return;
+
+  jsonout::Object event;
+  event.add( "id", id ).add( "name", label );
+  if ( has_range )
+    event.add( "value", 0 );
+  writeEvent( "progress", event );
+}
+
+void OutJSON::progress( const std::string & id, const std::string & label, int value )
+{
+  if ( progressFilter() )
+    return;
+
+  jsonout::Object event;
+  event.add( "id", id ).add( "name", label );
+  // value only if it is known (percentage progress)
+  // missing value means 'is-alive' notification
+  if ( value >= 0 )
+    event.add( "value", value );
+  writeEvent( "progress", event );
+}
+
+void OutJSON::progressEnd( const std::string & id, const std::string & label, const std::string & /*donetag*/, bool error )
+{
+  if ( progressFilter() )
+    return;
+
+  writeEvent( "progress", jsonout::Object().add( "id", id ).add( "name", label ).add( "done", !error ) );
+}
+
+void OutJSON::dwnldProgressStart( const Url & uri )
+{
+  writeEvent( "download", jsonout::Object().add( "url", uri.asString() ).add( "percent", -1 ).add( "rate", -1 ) );
+}
+
+void OutJSON::dwnldProgress( const Url & uri, int value, long rate )
+{
+  writeEvent( "download", jsonout::Object().add( "url", uri.asString() ).add( "percent", value ).add( "rate", rate ) );
+}
+
+void OutJSON::dwnldProgressEnd( const Url & uri, long rate, TriBool error )
+{
+  writeEvent( "download", jsonout::Object().add( "url", uri.asString() ).add( "rate", rate ).add( "done", bool(!error) ) );
+}
+
+void OutJSON::searchResult( const Table & table_r )
+{
+  const Table::container & rows( table_r.rows() );
+  if ( rows.empty() )
+    return;
+
+  const std::vector<std::string> & tags( OutXML::searchResultTags( table_r.header() ) );
+  for ( const TableRow & row : rows )
+  {
+    jsonout::Object event;
+    unsigned cidx = 0;
+    for ( const std::string & col : row.columns() )
+    {
+      const std::string & tag { cidx < tags.size() ? tags[cidx] : "?" };
+      if ( cidx == 0 )
+      {
+        if ( col[0] == 'i' || col[0] == 'I' )	// test 1st char as locked is "iL"/"IL"
+          event.add( tag, "installed" );
+        else if ( col[0] == 'v' )	// test 1st char as locked is "vL"
+          event.add( tag, "other-version" );
+        else
+          event.add( tag, "not-installed" );
+      }
+      else
+        event.add( tag, col );
+      ++cidx;
+    }
+    writeEvent( "search-result", event );
+  }
+}
+
+void OutJSON::prompt( PromptId id, const std::string & prompt, const PromptOptions & poptions, const std::string & startdesc )
+{
+  jsonout::Object event;
+  event.add( "id", unsigned(id) );
+  if ( !startdesc.empty() )
+    event.add( "description", startdesc );
+  event.add( "text", prompt );
+
+  jsonout::Array options;
+  unsigned i = 0;
+  for ( PromptOptions::StrVector::const_iterator it = poptions.options().begin(); it != poptions.options().end(); ++it, ++i )
+  {
+    if ( poptions.isDisabled( i ) )
+      continue;
+    jsonout::Object option;
+    option.add( "value", *it ).add( "desc", poptions.optionHelp(i) );
+    if ( poptions.defaultOpt() == i )
+      option.add( "default", true );
+    options.add( option );
+  }
+  event.addRaw( "options", options.str() );
+  writeEvent( "prompt", event );
+}
+
+void OutJSON::promptHelp( const PromptOptions & poptions )
+{
+  // nothing to do here
+}
@@ -0,0 +1,143 @@
+#ifndef OUTJSON_H_
+#define OUTJSON_H_
+
+#include <string>
+#include <type_traits>
+
+#include "Out.h"
+#include "Table.h"
+
+namespace jsonout
+{
+  /** \a str_r as JSON string literal (quoted and escaped).
+   * Bytes not forming valid UTF-8 are replaced by U+FFFD.
+   */
+  std::string quote( const std::string & str_r );
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class Object
+  /// \brief Build a JSON object member by member.
+  /// \code
+  ///   jsonout::Object obj;
+  ///   obj.add( "name", "zypper" ).add( "size", 42 ).add( "ok", true );
+  ///   cout << obj.str() << endl;	// {"name":"zypper","size":42,"ok":true}
+  /// \endcode
+  class Object
+  {
+  public:
+    Object & add( const std::string & key_r, const std::string & val_r )
+    { return addRaw( key_r, quote( val_r ) ); }
+
+    Object & add( const std::string & key_r, const char * val_r )
+    { return addRaw( key_r, val_r ? quote( val_r ) : "null" ); }
+
+    Object & add( const std::string & key_r, bool val_r )
+    { return addRaw( key_r, val_r ? "true" : "false" ); }
+
+    template <class Tp, typename std::enable_if<std::is_arithmetic<Tp>::value && !std::is_same<Tp,bool>::value, int>::type = 0>
+    Object & add( const std::string & key_r, Tp val_r )
+    { return addRaw( key_r, std::to_string( val_r ) ); }
+
+    Object & add( const std::string & key_r, const Object & val_r )
+    { return addRaw( key_r, val_r.str() ); }
+
+    /** Add a member whose value \a json_r is already JSON (e.g. an array). */
+    Object & addRaw( const std::string & key_r, const std::string & json_r );
+
+    bool empty() const
+    { return _body.empty(); }
+
+    std::string str() const
+    { return "{" + _body + "}"; }
+
+  private:
+    std::string _body;
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class Array
+  /// \brief Build a JSON array element by element.
+  class Array
+  {
+  public:
+    Array & add( const Object & val_r )
+    { return addRaw( val_r.str() ); }
+
+    Array & add( const std::string & val_r )
+    { return addRaw( quote( val_r ) ); }
+
+    /** Add an element \a json_r which is already JSON. */
+    Array & addRaw( const std::string & json_r );
+
+    bool empty() const
+    { return _body.empty(); }
+
+    std::string str() const
+    { return "[" + _body + "]"; }
+
+  private:
+    std::string _body;
+  };
+} // namespace jsonout
+
+/// \brief JSON output writer (\c --jsonout).
+///
+/// Writes one JSON object per line (NDJSON), so the output can be processed
+/// while it is streamed. Each object has an \c "event" member telling its
+/// kind (\c message, \c progress, \c download, \c prompt, \c search-result,
+/// \c install-summary, \c commit-summary, \c download-result, \c gpgkey-info).
+///
+/// \ref Out::type is \ref TYPE_JSON, so code which writes XML or plain text
+/// to \c cout depending on the output type needs to check \ref typeJSON.
+/// Code writing terminal decoration should test \c typeNORMAL rather than
+/// \c !=TYPE_XML. ztui's \c typeNORMAL and \c typeXML are both false for
+/// \ref TYPE_JSON (see tests/OutJSON_test.cc).
+class OutJSON : public Out
+{
+public:
+  /** The output type (not one of ztui's \ref Out::TypeBit). */
+  static constexpr TypeBit TYPE_JSON = TypeBit( TYPE_XML << 1 );
+
+  /** Whether \a out_r is an \ref OutJSON. */
+  static bool typeJSON( const Out & out_r )
+  { return out_r.type() == TYPE_JSON; }
+
+  /** Write \a event_r as line to \c cout, adding the \c "event" member \a name_r first. */
+  static void writeEvent( const std::string & name_r, const jsonout::Object & event_r );
+
+public:
+  OutJSON( Verbosity verbosity );
+  ~OutJSON() override;
+
+public:
+  void info( const std::string & msg, Verbosity verbosity, Type mask ) override;
+  void warning( const std::string & msg, Verbosity verbosity, Type mask ) override;
+  void error( const std::string & problem_desc, const std::string & hint ) override;
+  void error( const zypp::Exception & e, const std::string & problem_desc, const std::string & hint ) override;
+
+  // progress
+  void progressStart( const std::string & id, const std::string & label, bool is_tick ) override;
+  void progress( const std::string & id, const std::string & label, int value ) override;
+  void progressEnd( const std::string & id, const std::string & label, const std::string & donetag, bool error ) override;
+
+  // progress with download rate
+  void dwnldProgressStart( const zypp::Url & uri ) override;
+  void dwnldProgress( const zypp::Url & uri, int value, long rate ) override;
+  void dwnldProgressEnd( const zypp::Url & uri, long rate, zypp::TriBool error ) override;
+
+  /** One \c search-result event per row; the members are named like the \ref OutXML attributes. */
+  void searchResult( const Table & table_r ) override;
+
+  void prompt( PromptId id, const std::string & prompt, const PromptOptions & poptions, const std::string & startdesc ) override;
+
+  void promptHelp( const PromptOptions & poptions ) override;
+
+protected:
+  bool mine( Type type ) override;
+
+private:
+  bool infoWarningFilter( Verbosity verbosity, Type mask );
+  void writeMessage( const std::string & type_r, const std::string & text_r, const std::string & hint_r = std::string() );
+};
+
+#endif /*OUTJSON_H_*/
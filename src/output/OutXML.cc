@@ -2,6 +2,8 @@
 #include <sstream>
 #include <vector>
 
+#include <pthread.h>
+
 #include <zypp-core/base/String.h>
 #include <zypp-core/base/String.h>
 
@@ -12,16 +14,143 @@
 using std::cout;
 using std::endl;
 
-OutXML::OutXML( Verbosity verbosity_r )
+OutXML * OutXML::_active = nullptr;
+
+OutXML::OutXML( Verbosity verbosity_r, unsigned progressInterval_r )
 : Out( TYPE_XML, verbosity_r)
+, _progressInterval( progressInterval_r )
 {
   cout << "<?xml version='1.0'?>" << endl;
   cout << "<stream>" << endl;
+  _flushed = Clock::now();
+
+  if ( _progressInterval.count() )
+  {
+    static int atfork __attribute__ ((__unused__)) = ::pthread_atfork( &atforkPrepare, &atforkParent, &atforkChild );
+    _flusher.reset( new std::thread( &OutXML::flusher, this ) );
+    _active = this;
+  }
 }
 
 OutXML::~OutXML()
 {
-  cout << "</stream>" << endl;
+  if ( _flusher )
+  {
+    {
+      Lock lock( _mutex );
+      _stop = true;
+    }
+    _stopFlusher.notify_all();
+    _flusher->join();
+  }
+  if ( _active == this )
+    _active = nullptr;
+
+  bufferPending();
+  _buffer += "</stream>\n";
+  flush();
+}
+
+void OutXML::sync( Out & out_r )
+{
+  if ( OutXML * xml = dynamic_cast<OutXML*>( &out_r ) )
+  {
+    Lock lock( xml->_mutex );
+    xml->bufferPending();
+    xml->flush();
+  }
+}
+
+void OutXML::flusher()
+{
+  std::unique_lock<std::mutex> lock( _mutex );
+  while ( ! _stop )
+  {
+    _stopFlusher.wait_for( lock, _progressInterval );
+    if ( _stop )
+      break;
+    bufferPending( true );
+    if ( ! _buffer.empty() && Clock::now() - _flushed >= _progressInterval )
+      flush();
+  }
+}
+
+void OutXML::atforkPrepare()
+{
+  if ( _active )
+  {
+    _active->_mutex.lock();
+    _active->bufferPending();
+    _active->flush();
+  }
+}
+
+void OutXML::atforkParent()
+{
+  if ( _active )
+    _active->_mutex.unlock();
+}
+
+void OutXML::atforkChild()
+{
+  if ( _active )
+  {
+    // The flusher thread is not forked along; the child writes on events only.
+    (void)_active->_flusher.release();
+    _active->_mutex.unlock();
+    _active = nullptr;
+  }
+}
+
+void OutXML::flush()
+{
+  cout << _buffer << std::flush;
+  _buffer.clear();
+  _flushed = Clock::now();
+}
+
+void OutXML::write( const std::string & str_r, bool flush_r )
+{
+  bufferPending();
+  _buffer += str_r;
+  if ( flush_r || Clock::now() - _flushed >= _progressInterval )
+    flush();
+}
+
+void OutXML::bufferPending( bool dueOnly_r )
+{
+  Clock::time_point now { Clock::now() };
+  for ( auto & el : _progress )
+  {
+    ProgressState & state { el.second };
+    if ( ! state._pending.empty() && ( ! dueOnly_r || now - state._written >= _progressInterval ) )
+    {
+      _buffer += state._pending;
+      state._pending.clear();
+      state._written = now;
+    }
+  }
+}
+
+void OutXML::writeProgress( const std::string & key_r, std::string tag_r )
+{
+  ProgressState & state { _progress[key_r] };
+  Clock::time_point now { Clock::now() };
+  if ( now - state._written >= _progressInterval )
+  {
+    state._pending.clear();
+    state._written = now;
+    _buffer += tag_r;
+    flush();	// rate limited already
+  }
+  else
+    state._pending = std::move(tag_r);
+}
+
+void OutXML::writeProgressEnd( const std::string & key_r, const std::string & tag_r )
+{
+  _progress.erase( key_r );	// a pending update is superseded
+  write( tag_r );
 }
 
 bool OutXML::mine( Type type )
@@ -46,8 +175,8 @@ void OutXML::info( const std::string & msg, Verbosity verbosity_r, Type mask )
   if ( infoWarningFilter( verbosity_r, mask ) )
     return;
 
-  cout << "<message type=\"info\">" << xml::escape( msg )
-       << "</message>" << endl;
+  Lock lock( _mutex );
+  write( "<message type=\"info\">" + xml::escape( msg ) + "</message>\n" );
 }
 
 void OutXML::warning( const std::string & msg, Verbosity verbosity_r, Type mask )
@@ -55,14 +184,14 @@ void OutXML::warning( const std::string & msg, Verbosity verbosity_r, Type mask
   if ( infoWarningFilter( verbosity_r, mask) )
     return;
 
-  cout << "<message type=\"warning\">" << xml::escape( msg )
-       << "</message>" << endl;
+  Lock lock( _mutex );
+  write( "<message type=\"warning\">" + xml::escape( msg ) + "</message>\n" );
 }
 
 void OutXML::error( const std::string & problem_desc, const std::string & hint )
 {
-  cout << "<message type=\"error\">" << xml::escape( problem_desc )
-       << "</message>" << endl;
+  Lock lock( _mutex );
+  write( "<message type=\"error\">" + xml::escape( problem_desc ) + "</message>\n", true );
   //! \todo hint
 }
 
@@ -78,22 +207,24 @@ void OutXML::error(const zypp::Exception &e, const std::string & problem_desc, c
   if ( !hint.empty() )
     s << hint << endl;
 
-  cout << "<message type=\"error\">" << xml::escape(s.str())
-       << "</message>" << endl;
+  Lock lock( _mutex );
+  write( "<message type=\"error\">" + xml::escape(s.str()) + "</message>\n", true );
 }
 
-void OutXML::writeProgressTag( const std::string & id, const std::string & label, int value, bool done, bool error )
+std::string OutXML::progressTag( const std::string & id, const std::string & label, int value, bool done, bool error ) const
 {
-  cout << "<progress";
-  cout << " id=\"" << xml::escape(id) << "\"";
-  cout << " name=\"" << xml::escape(label) << "\"";
+  str::Str ret;
+  ret << "<progress";
+  ret << " id=\"" << xml::escape(id) << "\"";
+  ret << " name=\"" << xml::escape(label) << "\"";
   if ( done )
-    cout << " done=\"" << !error << "\"";
+    ret << " done=\"" << !error << "\"";
   // print value only if it is known (percentage progress)
   // missing value means 'is-alive' notification
   else if ( value >= 0 )
-    cout << " value=\"" << value << "\"";
-  cout << "/>" << endl;
+    ret << " value=\"" << value << "\"";
+  ret << "/>\n";
+  return ret;
 }
 
 void OutXML::progressStart( const std::string & id, const std::string & label, bool has_range )
@@ -102,7 +233,9 @@ void OutXML::progressStart( const std::string & id, const std::string & label, b
     return;
 
   //! \todo there is a bug in progress data which returns has_range false incorrectly
-  writeProgressTag( id, label, has_range ? 0 : -1, false );
+  Lock lock( _mutex );
+  _progress.erase( id );
+  writeProgress( id, progressTag( id, label, has_range ? 0 : -1, false ) );
 }
 
 void OutXML::progress( const std::string & id, const std::string& label, int value )
@@ -110,7 +243,8 @@ void OutXML::progress( const std::string & id, const std::string& label, int val
   if ( progressFilter() )
     return;
 
-  writeProgressTag( id, label, value, false );
+  Lock lock( _mutex );
+  writeProgress( id, progressTag( id, label, value, false ) );
 }
 
 void OutXML::progressEnd( const std::string & id, const std::string& label, const std::string & /*donetag*/, bool error )
@@ -118,103 +252,130 @@ void OutXML::progressEnd( const std::string & id, const std::string& label, cons
   if ( progressFilter() )
     return;
 
-  writeProgressTag( id, label, 100, true, error );
+  Lock lock( _mutex );
+  writeProgressEnd( id, progressTag( id, label, 100, true, error ) );
 }
 
 void OutXML::dwnldProgressStart( const Url & uri )
 {
-  cout << "<download"
-    << " url=\"" << xml::escape(uri.asString()) << "\""
-    << " percent=\"-1\""
-    << " rate=\"-1\""
-    << "/>" << endl;
+  const std::string & url { xml::escape(uri.asString()) };
+  Lock lock( _mutex );
+  _progress.erase( "download " + url );
+  writeProgress( "download " + url, str::Str() << "<download"
+                                 << " url=\"" << url << "\""
+                                 << " percent=\"-1\""
+                                 << " rate=\"-1\""
+                                 << "/>\n" );
 }
 
 void OutXML::dwnldProgress( const Url & uri, int value, long rate )
 {
-  cout << "<download"
-    << " url=\"" << xml::escape(uri.asString()) << "\""
-    << " percent=\"" << value << "\""
-    << " rate=\"" << rate << "\""
-    << "/>" << endl;
+  const std::string & url { xml::escape(uri.asString()) };
+  Lock lock( _mutex );
+  writeProgress( "download " + url, str::Str() << "<download"
+                                 << " url=\"" << url << "\""
+                                 << " percent=\"" << value << "\""
+                                 << " rate=\"" << rate << "\""
+                                 << "/>\n" );
 }
 
 void OutXML::dwnldProgressEnd( const Url & uri, long rate, TriBool error )
 {
-  cout << "<download"
-    << " url=\"" << xml::escape(uri.asString()) << "\""
-    << " rate=\"" << rate << "\""
-    << " done=\"" << bool(!error) << "\""
-    << "/>" << endl;
+  const std::string & url { xml::escape(uri.asString()) };
+  Lock lock( _mutex );
+  writeProgressEnd( "download " + url, str::Str() << "<download"
+                                    << " url=\"" << url << "\""
+                                    << " rate=\"" << rate << "\""
+                                    << " done=\"" << bool(!error) << "\""
+                                    << "/>\n" );
 }
 
-void OutXML::searchResult(const Table &table_r )
+std::vector<std::string> OutXML::searchResultTags( const TableHeader & header_r )
 {
-  cout << "<search-result version=\"0.0\">" << endl;
-  cout << "<solvable-list>" << endl;
+  //
+  // *** CAUTION: It's a mess, but must match the header list defined
+  //              in FillSearchTableSolvable ctor (search.cc)
+  // We derive the XML tag from the header, applying some translation
+  // hence and there.
+  std::vector<std::string> header;
+  for_( it, header_r.columnsNoTr().begin(), header_r.columnsNoTr().end() )
+  {
+    if ( *it == "S" )
+      header.push_back( "status" );
+    else if ( *it == "Type" )
+      header.push_back( "kind" );
+    else if ( *it == "Version" )
+      header.push_back( "edition" );
+    else
+      header.push_back( str::toLower( *it ) );
+  }
+  return header;
+}
 
-  const Table::container & rows( table_r.rows() );
-  if ( ! rows.empty() )
+void OutXML::searchResultBegin( std::ostream & str )
+{
+  str << "<search-result version=\"0.0\">" << endl;
+  str << "<solvable-list>" << endl;
+}
+
+void OutXML::searchResultRow( std::ostream & str, const std::vector<std::string> & tags_r, const TableRow & row_r )
+{
+  str << "<solvable";
+  const TableRow::container & cols( row_r.columns() );
+  unsigned cidx = 0;
+  for_( cit, cols.begin(), cols.end() )
   {
-    //
-    // *** CAUTION: It's a mess, but must match the header list defined
-    //              in FillSearchTableSolvable ctor (search.cc)
-    // We derive the XML tag from the header, applying some translation
-    // hence and there.
-    std::vector<std::string> header;
+    str << ' ' << (cidx < tags_r.size() ? tags_r[cidx] : "?" ) << "=\"";
+    if ( cidx == 0 )
     {
-      const TableHeader & theader( table_r.header() );
-      for_( it, theader.columnsNoTr().begin(), theader.columnsNoTr().end() )
-      {
-        if ( *it == "S" )
-          header.push_back( "status" );
-        else if ( *it == "Type" )
-          header.push_back( "kind" );
-        else if ( *it == "Version" )
-          header.push_back( "edition" );
-        else
-          header.push_back( str::toLower( *it ) );
-      }
+      if ( (*cit)[0] == 'i' || (*cit)[0] == 'I' )	// test 1st char as locked is "iL"/"IL"
+        str << "installed\"";
+      else if ( (*cit)[0] == 'v' )	// test 1st char as locked is "vL"
+        str << "other-version\"";
+      else
+        str << "not-installed\"";
     }
-
-    for_( it, rows.begin(), rows.end() )
+    else
     {
-      cout << "<solvable";
-      const TableRow::container & cols( it->columns() );
-      unsigned cidx = 0;
-      for_( cit, cols.begin(), cols.end() )
-      {
-        cout << ' ' << (cidx < header.size() ? header[cidx] : "?" ) << "=\"";
-        if ( cidx == 0 )
-        {
-          if ( (*cit)[0] == 'i' || (*cit)[0] == 'I' )	// test 1st char as locked is "iL"/"IL"
-            cout << "installed\"";
-          else if ( (*cit)[0] == 'v' )	// test 1st char as locked is "vL"
-            cout << "other-version\"";
-          else
-            cout << "not-installed\"";
-        }
-        else
-        {
-          cout << xml::escape(*cit) << '"';
-        }
-        ++cidx;
-      }
-      cout << "/>" << endl;
+      str << xml::escape(*cit) << '"';
     }
+    ++cidx;
+  }
+  str << "/>" << endl;
+}
+
+void OutXML::searchResultEnd( std::ostream & str )
+{
+  str << "</solvable-list>" << endl;
+  str << "</search-result>" << endl;
+}
+
+void OutXML::searchResult(const Table &table_r )
+{
+  Lock lock( _mutex );
+  bufferPending();
+  flush();
+  searchResultBegin( cout );
+
+  const Table::container & rows( table_r.rows() );
+  if ( ! rows.empty() )
+  {
+    const std::vector<std::string> & tags( searchResultTags( table_r.header() ) );
+    for_( it, rows.begin(), rows.end() )
+      searchResultRow( cout, tags, *it );
   }
     //Out::searchResult( table_r );
 
-  cout << "</solvable-list>" << endl;
-  cout << "</search-result>" << endl;
+  searchResultEnd( cout );
 }
 
 void OutXML::prompt( PromptId id, const std::string & prompt, const PromptOptions & poptions, const std::string & startdesc )
 {
-  cout << "<prompt id=\"" << id << "\">" << endl;
+  str::Str str;
+  str << "<prompt id=\"" << id << "\">\n";
   if ( !startdesc.empty() )
-    cout << "<description>" << xml::escape(startdesc) << "</description>" << endl;
-  cout << "<text>" << xml::escape(prompt) << "</text>" << endl;
+    str << "<description>" << xml::escape(startdesc) << "</description>\n";
+  str << "<text>" << xml::escape(prompt) << "</text>\n";
 
   unsigned i = 0;
   for ( PromptOptions::StrVector::const_iterator it = poptions.options().begin(); it != poptions.options().end(); ++it, ++i )
@@ -222,14 +383,17 @@ void OutXML::prompt( PromptId id, const std::string & prompt, const PromptOption
     if ( poptions.isDisabled(  i) )
       continue;
     std::string option = *it;
-    cout << "<option";
+    str << "<option";
     if ( poptions.defaultOpt() == i )
-      cout << " default=\"1\"";
-    cout << " value=\"" << xml::escape(option) << "\"";
-    cout << " desc=\"" << xml::escape(poptions.optionHelp(i)) << "\"";
-    cout << "/>" << endl;
+      str << " default=\"1\"";
+    str << " value=\"" << xml::escape(option) << "\"";
+    str << " desc=\"" << xml::escape(poptions.optionHelp(i)) << "\"";
+    str << "/>\n";
   }
-  cout << "</prompt>" << endl;
+  str << "</prompt>\n";
+
+  Lock lock( _mutex );
+  write( str, true );
 }
 
 void OutXML::promptHelp( const PromptOptions & poptions )
@@ -1,15 +1,48 @@
 #ifndef OUTXML_H_
 #define OUTXML_H_
 
+#include <chrono>
+#include <condition_variable>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "Out.h"
 #include "Table.h"
 
+/// \brief XML output writer (\c --xmlout).
+///
+/// Progress updates (\c <progress>, \c <download>) of the same task are
+/// coalesced: they are written at most every \c progressInterval_r ms,
+/// intermediate values are dropped. A pending value of a task is written
+/// before any other element, unless the task's end supersedes it.
+///
+/// All other elements are buffered. The buffer is written and \c cout
+/// flushed along with a progress update, on errors and prompts, by \ref sync,
+/// and if the interval passed since it was written last.
+///
+/// A flusher thread writes pending progress updates and the buffer once the
+/// interval passed, even if no further element follows. All output is done
+/// holding \c _mutex. Before a \c fork the buffer is written, so the child
+/// does not write the parents output again.
+///
+/// Code writing XML to \c cout directly must call \ref sync first, so
+/// nothing pending is written into or after it.
+///
+/// A \c progressInterval_r of \c 0 writes everything immediately.
 class OutXML : public Out
 {
 public:
-  OutXML( Verbosity verbosity );
+  OutXML( Verbosity verbosity, unsigned progressInterval_r = 0 );
   ~OutXML() override;
 
+  /** If \a out_r is an \ref OutXML, write its buffer and pending progress updates. */
+  static void sync( Out & out_r );
+
 public:
   void info( const std::string & msg, Verbosity verbosity, Type mask ) override;
   void warning( const std::string & msg, Verbosity verbosity, Type mask ) override;
@@ -28,6 +61,21 @@ public:
 
   void searchResult( const Table & table_r ) override;
 
+  /** \name Building blocks of \ref searchResult.
+   * Allow writing a search result row by row, without collecting
+   * the whole \ref Table first (see \ref SearchCmd).
+   */
+  //@{
+  /** The XML attribute names for the columns in \a header_r. */
+  static std::vector<std::string> searchResultTags( const TableHeader & header_r );
+  /** Open the \c search-result element. */
+  static void searchResultBegin( std::ostream & str );
+  /** Write \a row_r as \c solvable element using the attribute names \a tags_r. */
+  static void searchResultRow( std::ostream & str, const std::vector<std::string> & tags_r, const TableRow & row_r );
+  /** Close the \c search-result element. */
+  static void searchResultEnd( std::ostream & str );
+  //@}
+
   void prompt( PromptId id, const std::string & prompt, const PromptOptions & poptions, const std::string & startdesc ) override;
 
   void promptHelp( const PromptOptions & poptions ) override;
@@ -36,8 +84,47 @@ protected:
   bool mine( Type type ) override;
 
 private:
+  using Clock = std::chrono::steady_clock;
+  using Lock = std::lock_guard<std::mutex>;
+
   bool infoWarningFilter( Verbosity verbosity, Type mask );
-  void writeProgressTag( const std::string & id, const std::string & label, int value, bool done, bool error = false );
+  std::string progressTag( const std::string & id, const std::string & label, int value, bool done, bool error = false ) const;
+
+  /** Write an update of progress \a key_r or remember it until the interval passed. */
+  void writeProgress( const std::string & key_r, std::string tag_r );
+  /** Buffer the final tag of progress \a key_r, dropping a pending update. */
+  void writeProgressEnd( const std::string & key_r, const std::string & tag_r );
+  /** Buffer the pending progress updates (if \a dueOnly_r only those whose interval passed). */
+  void bufferPending( bool dueOnly_r = false );
+  /** Buffer \a str_r after all pending progress updates; flush if \a flush_r or the interval passed. */
+  void write( const std::string & str_r, bool flush_r = false );
+  /** Write the buffer and flush \c cout. */
+  void flush();
+
+  /** The flusher thread. */
+  void flusher();
+
+  static void atforkPrepare();
+  static void atforkParent();
+  static void atforkChild();
+
+private:
+  struct ProgressState
+  {
+    Clock::time_point _written;	///< when the last update was written
+    std::string _pending;	///< newer update not yet written
+  };
+  std::chrono::milliseconds _progressInterval;
+  std::map<std::string,ProgressState> _progress;	///< by id
+  std::string _buffer;		///< elements not yet written
+  Clock::time_point _flushed;	///< when the buffer was written last
+
+  std::mutex _mutex;			///< guards all of the above and \c cout
+  std::condition_variable _stopFlusher;
+  bool _stop = false;
+  std::unique_ptr<std::thread> _flusher;	///< unless progressInterval_r is 0
+
+  static OutXML * _active;	///< the instance running a flusher (for fork)
 };
 
 #endif /*OUTXML_H_*/
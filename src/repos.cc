@@ -7,20 +7,27 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <iterator>
 #include <list>
 
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
 #include <zypp/ZYpp.h>
 #include <zypp-core/base/Logger.h>
 #include <zypp-core/base/IOStream.h>
 #include <zypp-core/base/String.h>
 #include <zypp-core/base/Flags.h>
+#include <zypp/base/Measure.h>
 
 #include <zypp/RepoManager.h>
 #include <zypp/repo/RepoException.h>
 #include <zypp-core/parser/ParseException>
 #include <zypp-media/MediaException>
 #include <zypp/target/rpm/RpmHeader.h>
+#include <zypp/target/rpm/RpmDb.h>
 
 #include "output/Out.h"
 #include "main.h"
@@ -29,6 +36,7 @@
 #include "utils/messages.h"
 #include "utils/misc.h"
 #include "utils/prompt.h"
+#include "utils/SearchIndex.h"
 #include "repos.h"
 #include "global-settings.h"
 
@@ -199,6 +207,61 @@ void repoPrioSummary( Zypper & zypper )
 
 // ----------------------------------------------------------------------------
 
+RepoManager::RefreshCheckStatus check_refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo )
+{
+  RepoManager::RefreshCheckStatus stat = RepoManager::REPO_UP_TO_DATE;
+  if ( repo.baseUrlsEmpty() )
+    return stat;
+
+  RepoManager & manager = zypper.repoManager();
+  const auto &repoOrigins = repo.repoOrigins();
+  for ( auto it = repoOrigins.begin(); it != repoOrigins.end(); )
+  {
+    try
+    {
+      stat = manager.checkIfToRefreshMetadata( repo, *it,
+            zypper.command() == ZypperCommand::REFRESH ||
+            zypper.command() == ZypperCommand::REFRESH_SERVICES ?
+              RepoManager::RefreshIfNeededIgnoreDelay :
+              RepoManager::RefreshIfNeeded );
+
+      if ( stat != RepoManager::REFRESH_NEEDED
+        && ( zypper.command() == ZypperCommand::REFRESH || zypper.command() == ZypperCommand::REFRESH_SERVICES ) )
+      {
+        switch ( stat )
+        {
+        case RepoManager::REPO_UP_TO_DATE:
+        {
+          TermLine outstr( TermLine::SF_SPLIT | TermLine::SF_EXPAND );
+          outstr.lhs << str::Format(_("Repository '%s' is up to date.")) % repo.asUserString();
+          //outstr.rhs << repoGpgCheckStatus( repo );
+          zypper.out().infoLine( outstr );
+        }
+        break;
+        case RepoManager::REPO_CHECK_DELAYED:
+          zypper.out().info( str::Format(_("The up-to-date check of '%s' has been delayed.")) % repo.asUserString(),
+                             Out::HIGH );
+        break;
+        default:
+          WAR << "new item in enum, which is not covered" << endl;
+        }
+      }
+      break; // don't check all the urls, just the first successful.
+    }
+    catch ( const Exception & e )
+    {
+      ZYPP_CAUGHT( e );
+      std::vector<OriginEndpoint> badurls( it->begin(), it->end() );
+      if ( ++it == repoOrigins.end() )
+        ZYPP_RETHROW( e );
+      ERR << badurls << " doesn't look good. Trying another url (" << *it << ")." << endl;
+    }
+  }
+  return stat;
+}
+
+// ----------------------------------------------------------------------------
+
 bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_download )
 {
   RuntimeData & gData( zypper.runtimeData() );
@@ -225,53 +288,7 @@ bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_do
       // print a message
       zypper.out().info( str::Format(_("Checking whether to refresh metadata for %s")) % repo.asUserString(),
                          Out::HIGH );
-      if ( !repo.baseUrlsEmpty() )
-      {
-        const auto &repoOrigins = repo.repoOrigins();
-        for ( auto it = repoOrigins.begin(); it != repoOrigins.end(); )
-        {
-          try
-          {
-            RepoManager::RefreshCheckStatus stat = manager.checkIfToRefreshMetadata( repo, *it,
-                  zypper.command() == ZypperCommand::REFRESH ||
-                  zypper.command() == ZypperCommand::REFRESH_SERVICES ?
-                    RepoManager::RefreshIfNeededIgnoreDelay :
-                    RepoManager::RefreshIfNeeded );
-
-            do_refresh = ( stat == RepoManager::REFRESH_NEEDED );
-            if ( !do_refresh
-              && ( zypper.command() == ZypperCommand::REFRESH || zypper.command() == ZypperCommand::REFRESH_SERVICES ) )
-            {
-              switch ( stat )
-              {
-              case RepoManager::REPO_UP_TO_DATE:
-              {
-                TermLine outstr( TermLine::SF_SPLIT | TermLine::SF_EXPAND );
-                outstr.lhs << str::Format(_("Repository '%s' is up to date.")) % repo.asUserString();
-                //outstr.rhs << repoGpgCheckStatus( repo );
-                zypper.out().infoLine( outstr );
-              }
-              break;
-              case RepoManager::REPO_CHECK_DELAYED:
-                zypper.out().info( str::Format(_("The up-to-date check of '%s' has been delayed.")) % repo.asUserString(),
-                                   Out::HIGH );
-              break;
-              default:
-                WAR << "new item in enum, which is not covered" << endl;
-              }
-            }
-            break; // don't check all the urls, just the first successful.
-          }
-          catch ( const Exception & e )
-          {
-            ZYPP_CAUGHT( e );
-            std::vector<OriginEndpoint> badurls( it->begin(), it->end() );
-            if ( ++it == repoOrigins.end() )
-              ZYPP_RETHROW( e );
-            ERR << badurls << " doesn't look good. Trying another url (" << *it << ")." << endl;
-          }
-        }
-      }
+      do_refresh = ( check_refresh_raw_metadata( zypper, repo ) == RepoManager::REFRESH_NEEDED );
     }
     else
     {
@@ -419,12 +436,28 @@ bool build_cache( Zypper & zypper, const RepoInfo & repo, bool force_build )
     // version of satsolver-tools. If there's a version mismatch or some other
     // problem, the solv file will be rebuilt even though the cookie files
     // indicate the solv file is up to date with raw metadata (bnc #456718)
-    if ( !force_build
-      // only do this if the refresh commands are running
-      // this function is also used when loading repos for other commands
-      && ( zypper.command() == ZypperCommand::REFRESH || zypper.command() == ZypperCommand::REFRESH_SERVICES) )
+    // only do this if the refresh commands are running
+    // this function is also used when loading repos for other commands
+    bool refreshing = ( zypper.command() == ZypperCommand::REFRESH || zypper.command() == ZypperCommand::REFRESH_SERVICES );
+    bool loaded = false;
+    if ( !force_build && refreshing )
     {
       manager.loadFromCache( repo );
+      loaded = true;
+    }
+
+    // Keep the search index in sync with the solv file. It is built from
+    // the loaded repo, so refresh does it. Other commands would load the
+    // repo twice (and may not be allowed to write the cache); 'search'
+    // builds missing indexes itself if it can.
+    const Pathname & dir { zypper.config().rm_options.repoSolvCachePath / repo.escaped_alias() };
+    if ( refreshing && ! SearchIndex::upToDate( dir ) )
+    {
+      if ( ! loaded )
+        manager.loadFromCache( repo );
+      Repository robj = sat::Pool::instance().reposFind( repo.alias() );
+      if ( robj != Repository::noRepository )
+        SearchIndex::update( robj, dir );
     }
   }
   catch ( const parser::ParseException & e )
@@ -818,6 +851,12 @@ void do_init_repos( Zypper & zypper )
       ++it;
   }
 
+  // main.refreshJobs: root may refresh repos in parallel. Repos subject to the
+  // --plus-content check after refresh are not deferred, as the check needs the
+  // content keywords RepoManager updates in the refreshing process.
+  unsigned jobs = ( geteuid() == 0 ? zypper.config().repo_refreshJobs : 1 );
+  std::list<std::list<RepoInfo>::iterator> torefresh;
+
   unsigned skip_count = 0;
   for ( std::list<RepoInfo>::iterator it = gData.repos.begin(); it !=  gData.repos.end(); ++it )
   {
@@ -858,7 +897,12 @@ void do_init_repos( Zypper & zypper )
       MIL << "calling refresh for " << repo.alias() << endl;
 
       // handle root user differently
-      if ( geteuid() == 0 )
+      if ( jobs > 1 && !postContentcheck )
+      {
+        torefresh.push_back( it );
+        continue;
+      }
+      else if ( geteuid() == 0 )
       {
         if ( refresh_raw_metadata( zypper, repo, false ) || build_cache( zypper, repo, false ) )
         {
@@ -937,6 +981,26 @@ void do_init_repos( Zypper & zypper )
     }
   }
 
+  if ( ! torefresh.empty() )
+  {
+    std::list<RepoInfo> repos;
+    for ( const auto & it : torefresh )
+      repos.push_back( *it );
+
+    const std::set<std::string> & failed { RefreshRepoCmd::refreshInParallel( zypper, repos, RefreshRepoCmd::Default, jobs ) };
+    for ( const auto & it : torefresh )
+    {
+      if ( failed.count( it->alias() ) )
+      {
+        WAR << "Skipping repository '" << it->alias() << "' because of the above error." << endl;
+        zypper.out().warning( str::Format(_("Skipping repository '%s' because of the above error.")) % it->asUserString(),
+                              Out::QUIET );
+        it->setEnabled( false );	// in gData!
+        ++skip_count;
+      }
+    }
+  }
+
   if ( skip_count )
   {
     zypper.out().error(_("Some of the repositories have not been refreshed because of an error.") );
@@ -957,17 +1021,26 @@ void do_init_repos( Zypper & zypper )
  * Initialize the repositories
  * \sa InitRepoSettings
  */
+namespace
+{
+  // Cleared by unload_repos, so zypper shell/server can reload changed repos.
+  bool initReposDone = false;
+  bool loadResolvablesDone = false;
+
+  // What the pool was loaded from; see *_changed_since_load.
+  std::string loadedReposStamp;
+  Date loadedTargetStamp;
+} // namespace
+
 void init_repos( Zypper & zypper )
 {
-  static bool done = false;
-  //! \todo this has to be done so that it works in zypper shell
-  if ( done )
+  if ( initReposDone )
     return;
 
   if ( !zypper.config().disable_system_sources )
     do_init_repos( zypper );
 
-  done = true;
+  initReposDone = true;
 }
 
 // ----------------------------------------------------------------------------
@@ -1740,10 +1813,9 @@ void checkIfToAutoRefreshServices(Zypper & zypper, RepoManager::RefreshServiceFl
 
 void load_resolvables( Zypper & zypper )
 {
-  static bool done = false;
   // don't call this function more than once for a single ZYpp instance
-  // (e.g. in shell)
-  if ( done )
+  // (e.g. in shell) unless unload_repos was called.
+  if ( loadResolvablesDone )
     return;
 
   MIL << "Going to load resolvables" << endl;
@@ -1752,12 +1824,114 @@ void load_resolvables( Zypper & zypper )
   if ( !zypper.config().disable_system_resolvables )
     load_target_resolvables( zypper );
 
-  done = true;
+  loadResolvablesDone = true;
   MIL << "Done loading resolvables" << endl;
 }
 
+void unload_repos( Zypper & zypper )
+{
+  MIL << "Unloading repositories" << endl;
+  std::vector<Repository> toerase;
+  for ( const Repository & repo : sat::Pool::instance().repos() )
+  {
+    if ( ! repo.isSystemRepo() )
+      toerase.push_back( repo );
+  }
+  for ( Repository & repo : toerase )
+    repo.eraseFromPool();
+
+  zypper.runtimeData().repos.clear();
+  initReposDone = false;
+  loadResolvablesDone = false;
+  loadedReposStamp.clear();
+}
+
 // ---------------------------------------------------------------------------
 
+namespace
+{
+  /** Append the mtimes of \a dir_r and its entries (or of the file \a file_r
+   * within each entry) to \a stamp_r. Entries starting with \c @ are skipped.
+   */
+  void stampDir( std::ostream & stamp_r, const Pathname & dir_r, const std::string & file_r = std::string() )
+  {
+    std::list<std::string> entries;
+    if ( filesystem::readdir( entries, dir_r, /*dots*/false ) != 0 )
+    {
+      stamp_r << dir_r << ":-;";
+      return;
+    }
+    entries.sort();
+
+    stamp_r << dir_r << ":" << PathInfo( dir_r ).mtime() << ";";
+    for ( const std::string & entry : entries )
+    {
+      if ( entry[0] == '@' )
+        continue;	// e.g. @System in the solv cache
+      Pathname path { dir_r / entry };
+      if ( ! file_r.empty() )
+        path /= file_r;
+      stamp_r << entry << ":" << PathInfo( path ).mtime() << ";";
+    }
+  }
+} // namespace
+
+std::string repos_change_stamp( Zypper & zypper )
+{
+  const RepoManagerOptions & opts { zypper.config().rm_options };
+  std::ostringstream stamp;
+  stampDir( stamp, opts.knownReposPath );
+  stampDir( stamp, opts.knownServicesPath );
+  stampDir( stamp, opts.repoSolvCachePath, "solv" );
+  return stamp.str();
+}
+
+Date target_change_stamp( Zypper & zypper )
+{
+  if ( ! God || ! God->getTarget() )
+    return Date();
+  return God->target()->rpmDb().timestamp();
+}
+
+bool repos_changed_since_load( Zypper & zypper )
+{
+  return ! loadedReposStamp.empty() && repos_change_stamp( zypper ) != loadedReposStamp;
+}
+
+bool target_changed_since_load( Zypper & zypper )
+{
+  return loadedTargetStamp != Date() && target_change_stamp( zypper ) != loadedTargetStamp;
+}
+
+// ---------------------------------------------------------------------------
+
+namespace
+{
+  /** Let the kernel read the solv files of all enabled \a repos_r in advance.
+   * Adding the solv files to the sat::Pool must be done one after the other,
+   * but reading them from disk need not. On a cold cache the readahead for the
+   * remaining repos runs in the background while the current one is parsed.
+   */
+  void prefetchSolvFiles( Zypper & zypper, const std::list<RepoInfo> & repos_r )
+  {
+    const Pathname & solvCachePath { zypper.config().rm_options.repoSolvCachePath };
+    for ( const RepoInfo & repo : repos_r )
+    {
+      if ( ! repo.enabled() )
+        continue;
+
+      Pathname solvfile { solvCachePath / repo.escaped_alias() / "solv" };
+      int fd = ::open( solvfile.c_str(), O_RDONLY | O_CLOEXEC );
+      if ( fd < 0 )
+        continue;	// not (yet) cached
+      int res = ::posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED );
+      if ( res != 0 )
+        DBG << "posix_fadvise " << solvfile << ": " << ::strerror( res ) << endl;
+      ::close( fd );
+    }
+  }
+} // namespace
+
 void load_repo_resolvables( Zypper & zypper )
 {
   RepoManager & manager = zypper.repoManager();
@@ -1767,6 +1941,8 @@ void load_repo_resolvables( Zypper & zypper )
   if ( gData.repos.empty() )
     zypper.out().warning(_("No repositories defined. Operating only with the installed resolvables. Nothing can be installed.") );
 
+  prefetchSolvFiles( zypper, gData.repos );
+
   bool hintExpired = false;
   for_( it, gData.repos.begin(), gData.repos.end() )
   {
@@ -1815,7 +1991,10 @@ void load_repo_resolvables( Zypper & zypper )
         }
       }
 
-      manager.loadFromCache( repo );
+      {
+        debug::Measure m( "loadFromCache " + repo.alias() );
+        manager.loadFromCache( repo );
+      }
 
       // check that the metadata is not outdated
       // feature #301904
@@ -1842,6 +2021,8 @@ void load_repo_resolvables( Zypper & zypper )
       zypper.out().info( str::Format(_("Resolvables from '%s' not loaded because of error.")) % repo.asUserString() );
     }
   }
+  loadedReposStamp = repos_change_stamp( zypper );
+
   if ( hintExpired ) {
     Zypper::instance().out().warningPar( 4, _("Repository metadata expired: "
     "Check if 'autorefresh' is turned on (zypper lr), otherwise manually refresh the repository (zypper ref). "
@@ -1861,6 +2042,7 @@ void load_target_resolvables(Zypper & zypper)
   try
   {
     God->target()->load();
+    loadedTargetStamp = target_change_stamp( zypper );
   }
   catch ( const Exception & e )
   {
@@ -206,6 +206,38 @@ void load_target_resolvables( Zypper & zypper );
  */
 void load_repo_resolvables( Zypper & zypper );
 
+/**
+ * Erase all but the system repo from the pool and forget about the loaded
+ * repositories, so the next \ref init_repos and \ref load_resolvables
+ * re-read them (e.g. in zypper shell after repos were modified).
+ */
+void unload_repos( Zypper & zypper );
+
+/**
+ * A stamp changing whenever repo or service definitions change or a repos
+ * solv cache is rebuilt. Compare it to decide whether \ref unload_repos
+ * is needed.
+ */
+std::string repos_change_stamp( Zypper & zypper );
+
+/**
+ * The timestamp of the targets rpm database; a default constructed \c Date
+ * if the target is not initialized.
+ */
+Date target_change_stamp( Zypper & zypper );
+
+/**
+ * Whether repo or service definitions or the solv caches changed since
+ * \ref load_repo_resolvables loaded them. \c false if no repos were loaded.
+ */
+bool repos_changed_since_load( Zypper & zypper );
+
+/**
+ * Whether the rpm database changed since \ref load_target_resolvables
+ * loaded it. \c false if the target was not loaded.
+ */
+bool target_changed_since_load( Zypper & zypper );
+
 ColorString repoPriorityNumber( unsigned prio_r, int width_r = 0 );
 ColorString repoPriorityNumberAnnotated( unsigned prio_r, int width_r = 0 );
 
@@ -216,6 +248,11 @@ bool repo_cmp_alias_urls( const RepoInfo & lhs, const RepoInfo & rhs );
 
 void repoPrioSummary( Zypper & zypper );
 
+/** Whether the raw metadata of \a repo need to be refreshed (the up-to-date check of \ref refresh_raw_metadata).
+ * Throws if no url of \a repo can be checked.
+ */
+RepoManager::RefreshCheckStatus check_refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo );
+
 bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_download );
 
 bool build_cache( Zypper & zypper, const RepoInfo & repo, bool force_build );
@@ -17,6 +17,7 @@
 #include "main.h"
 #include "utils/misc.h"
 #include "global-settings.h"
+#include "output/OutXML.h"
 
 #include "search.h"
 
@@ -269,6 +270,7 @@ void list_patches( Zypper & zypper )
 
 static void list_patterns_xml( Zypper & zypper, SolvableFilterMode mode_r )
 {
+  OutXML::sync( zypper.out() );
   cout << "<pattern-list>" << endl;
 
   bool repofilter =  InitRepoSettings::instance()._repoFilter.size() ;	// suppress @System if repo filter is on
@@ -477,6 +479,7 @@ void list_products_xml( Zypper & zypper, SolvableFilterMode mode_r, const std::v
   bool installed_only = mode_r == SolvableFilterMode::ShowOnlyInstalled;
   bool notinst_only = mode_r == SolvableFilterMode::ShowOnlyNotInstalled;
 
+  OutXML::sync( zypper.out() );
   cout << "<product-list>" << endl;
   for ( const auto & pi : God->pool().byKind<Product>() )
   {
@@ -13,11 +13,14 @@
 #include <zypp-core/base/Logger.h>
 #include <zypp-core/TriBool.h>
 #include <zypp/FileChecker.h>
+#include <zypp/PoolItem.h>
+#include <zypp/base/Measure.h>
+#include <zypp/sat/LookupAttr.h>
+#include <zypp/sat/Pool.h>
 #include <zypp-core/base/InputStream>
 #include <zypp-core/base/IOStream.h>
 
 #include <zypp-media/MediaException>
-#include <zypp/misc/CheckAccessDeleted.h>
 
 #include "misc.h"		// confirm_licenses
 #include "repos.h"		// get_repo - used in dist_upgrade
@@ -25,8 +28,12 @@
 #include "utils/prompt.h"	// Continue? and solver problem prompt
 #include "utils/pager.h"	// to view the summary
 #include "utils/messages.h"
+#include "utils/DeletedFilesScan.h"
 #include "global-settings.h"
 #include "CommitSummary.h"
+#include "CommitPrefetcher.h"
+#include "output/OutJSON.h"
+#include "output/OutXML.h"
 
 #include "solve-commit.h"
 #include "commands/needs-rebooting.h"
@@ -610,18 +617,57 @@ SolveAndCommitPolicy & SolveAndCommitPolicy::downloadMode( DownloadMode dlMode )
 DownloadMode SolveAndCommitPolicy::downloadMode() const
 { return _zyppCommitPolicy.downloadMode(); }
 
+SolveAndCommitPolicy & SolveAndCommitPolicy::pipelinedDownload( bool enable )
+{
+  _pipelinedDownload = enable;
+  if ( enable )
+    downloadMode( DownloadAsNeeded );
+  return *this;
+}
+
+bool SolveAndCommitPolicy::pipelinedDownload() const
+{ return _pipelinedDownload && _zyppCommitPolicy.downloadMode() == DownloadAsNeeded; }
+
+/** The libraries and executables of installed packages which are to be removed or
+ * replaced (upgrade, downgrade, reinstall). Processes may have mapped them.
+ */
+static DeletedFilesScan::FileFilter libsAndBinsReplacedByCommit()
+{
+  debug::Measure m( "libsAndBinsReplacedByCommit" );
+  DeletedFilesScan::FileFilter ret;
+  for ( const sat::Solvable & slv : sat::Pool::instance().systemRepo().solvables() )
+  {
+    if ( ! PoolItem( slv ).status().isToBeUninstalled() )
+      continue;
+
+    sat::LookupAttr filelist( sat::SolvAttr::filelist, slv );
+    for ( auto it = filelist.begin(); it != filelist.end(); ++it )
+    {
+      std::string file { it.asString() };
+      if ( DeletedFilesScan::isLibOrBin( file ) )
+        ret.insert( std::move(file) );
+    }
+  }
+  MIL << ret.size() << " libraries and executables replaced by the commit" << endl;
+  return ret;
+}
+
 /** fate #300763
  * This is called after each commit to notify user about running processes that
  * use libraries or other files that have been removed since their execution.
  */
-static void notify_processes_using_deleted_files( Zypper & zypper )
+static void notify_processes_using_deleted_files( Zypper & zypper, const std::optional<DeletedFilesScan::FileFilter> & replacedFiles_r )
 {
   if ( ! zypper.config().psCheckAccessDeleted ) {
     zypper.out().info( str::form(_("Check for running processes using deleted libraries is disabled in zypper.conf. Run '%s' to check manually."),
                                  "zypper ps -s" ) );
+  } else if ( replacedFiles_r && replacedFiles_r->empty() ) {
+    MIL << "No libraries or executables replaced; skip check for running processes using deleted files." << endl;
   } else {
     zypper.out().info(_("Checking for running processes using deleted libraries..."), Out::HIGH );
-    CheckAccessDeleted checker( false ); // wait for explicit call to check()
+    DeletedFilesScan checker( false ); // wait for explicit call to check()
+    if ( replacedFiles_r )
+      checker.setFileFilter( *replacedFiles_r );
     try
     {
       checker.check();
@@ -773,11 +819,19 @@ void solve_and_commit ( Zypper &zypper, SolveAndCommitPolicy policy )
     if ( policy.zyppCommitPolicy().dryRun() )
       summary.setDryRun( true );
 
-    // show the summary
-    if ( zypper.out().type() == Out::TYPE_XML )
-      summary.dumpAsXmlTo( cout );
-    else
-      summary.dumpTo( cout );
+    // show the summary (again after toggling a view option)
+    auto dumpSummary = [&zypper,&summary]() {
+      if ( zypper.out().type() == Out::TYPE_XML )
+      {
+        OutXML::sync( zypper.out() );
+        summary.dumpAsXmlTo( cout );
+      }
+      else if ( OutJSON::typeJSON( zypper.out() ) )
+        summary.dumpAsJsonTo( cout );
+      else
+        summary.dumpTo( cout );
+    };
+    dumpSummary();
 
 
     if ( summary.packagesToGetAndInstall()
@@ -880,31 +934,31 @@ void solve_and_commit ( Zypper &zypper, SolveAndCommitPolicy policy )
         case 3: // v - show version
         {
           summary.toggleViewOption( Summary::SHOW_VERSION );
-          summary.dumpTo( cout );
+          dumpSummary();
           break;
         }
         case 4: // a - show arch
         {
           summary.toggleViewOption( Summary::SHOW_ARCH );
-          summary.dumpTo( cout );
+          dumpSummary();
           break;
         }
         case 5: // r - show repos
         {
           summary.toggleViewOption( Summary::SHOW_REPO );
-          summary.dumpTo( cout );
+          dumpSummary();
           break;
         }
         case 6: // m - show vendor
         {
           summary.toggleViewOption( Summary::SHOW_VENDOR );
-          summary.dumpTo( cout );
+          dumpSummary();
           break;
         }
         case 7: // d - show details (all attributes)
         {
           summary.toggleViewOption( Summary::DETAILS );
-          summary.dumpTo( cout );
+          dumpSummary();
           break;
         }
         case 8: // g - view in pager
@@ -939,6 +993,15 @@ void solve_and_commit ( Zypper &zypper, SolveAndCommitPolicy policy )
           return;
         }
 
+        // Remember the libraries and executables the commit will replace or remove,
+        // so the post commit check needs to look for them only (the pool is not
+        // up to date after the commit).
+        bool checkDeletedFiles = !( zypper.config().changedRoot || dryRunEtc )
+                                 && ( summary.packagesToRemove() || summary.packagesToUpgrade() || summary.packagesToDowngrade() );
+        std::optional<DeletedFilesScan::FileFilter> replacedFiles;
+        if ( checkDeletedFiles && zypper.config().psCheckAccessDeleted && ! zypper.config().psCheckAccessDeletedSystemWide )
+          replacedFiles = libsAndBinsReplacedByCommit();
+
         std::optional<ZYppCommitResult> result;
         try
         {
@@ -966,7 +1029,19 @@ void solve_and_commit ( Zypper &zypper, SolveAndCommitPolicy policy )
           PatchRebootRulesWatchdog guard { summary.hasViewOption( Summary::PATCH_REBOOT_RULES ) && not summary.needMachineReboot() };
 
           MIL << "Using commit policy: " << policy.zyppCommitPolicy() << endl;
-          result = God->commit( policy.zyppCommitPolicy() );
+          {
+            // --download pipelined: keep downloading ahead while libzypp installs (DownloadAsNeeded).
+            std::optional<CommitPrefetcher> prefetcher;
+            if ( policy.pipelinedDownload() && ! policy.zyppCommitPolicy().dryRun() )
+            {
+              CommitPrefetcher::Window window;
+              window.packages = zypper.config().commit_pipelineWindow;
+              window.size = ByteCount( zypper.config().commit_pipelineWindowSize, ByteCount::MB );
+              window.jobs = zypper.config().commit_pipelineJobs;
+              prefetcher.emplace( std::move(window) );
+            }
+            result = God->commit( policy.zyppCommitPolicy() );
+          }
 
           gData.entered_commit = false;
 
@@ -1060,7 +1135,12 @@ void solve_and_commit ( Zypper &zypper, SolveAndCommitPolicy policy )
 
             // show the summary
             if ( zypper.out().type() == Out::TYPE_XML )
+            {
+              OutXML::sync( zypper.out() );
               cSummary.dumpAsXmlTo( cout );
+            }
+            else if ( OutJSON::typeJSON( zypper.out() ) )
+              cSummary.dumpAsJsonTo( cout );
             else
               cSummary.dumpTo( cout );
 
@@ -1101,10 +1181,9 @@ void solve_and_commit ( Zypper &zypper, SolveAndCommitPolicy policy )
         }
 
         // check for running services (fate #300763)
-        if ( !( zypper.config().changedRoot || dryRunEtc )
-          && ( summary.packagesToRemove() || summary.packagesToUpgrade() || summary.packagesToDowngrade() ) )
+        if ( checkDeletedFiles )
         {
-          notify_processes_using_deleted_files( zypper );
+          notify_processes_using_deleted_files( zypper, replacedFiles );
         }
       }
     }
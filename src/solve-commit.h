@@ -56,12 +56,20 @@ struct SolveAndCommitPolicy {
   SolveAndCommitPolicy &downloadMode(DownloadMode dlMode);
   DownloadMode downloadMode() const;
 
+  /*!
+   * Download packages in the background while installing (\c DownloadAsNeeded
+   * plus a \ref CommitPrefetcher).
+   */
+  SolveAndCommitPolicy &pipelinedDownload( bool enable );
+  bool pipelinedDownload() const;
+
   /** Information collected in SolveAndCommit which is to be shown in the Summary. */
   SummaryHints summaryHints;
 
 private:
   bool _forceCommit = false;
   bool _skipNotApplicablePatches = false;
+  bool _pipelinedDownload = false;
   Summary::ViewOptions _summaryOptions = Summary::DEFAULT;
   ZYppCommitPolicy _zyppCommitPolicy;
 };
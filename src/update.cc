@@ -1,13 +1,20 @@
 #include <iostream> // for xml and table output
 #include <sstream>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
 
 #include <zypp-core/base/LogTools.h>
 #include <zypp/ZYppFactory.h>
 #include <zypp/base/Algorithm.h>
+#include <zypp/base/Measure.h>
+#include <zypp/base/SerialNumber.h>
+#include <zypp/sat/Pool.h>
 #include <zypp-core/base/Iterable.h>
 #include <zypp/PoolQuery.h>
 
 #include <zypp/Patch.h>
+#include <zypp/VendorAttr.h>
 
 #include "SolverRequester.h"
 #include "Table.h"
@@ -15,13 +22,15 @@
 #include "main.h"
 #include "global-settings.h"
 #include "utils/misc.h"
+#include "utils/IssueIndex.h"
+#include "output/OutXML.h"
 
 using namespace zypp;
 typedef std::set<PoolItem> Candidates;
 
 extern ZYpp::Ptr God;
 
-static void find_updates( const ResKindSet & kinds, Candidates & candidates, bool all_r );
+static void find_updates( const ResKindSet & kinds, Candidates & candidates, bool all_r, UpdateMode mode_r );
 
 ///////////////////////////////////////////////////////////////////
 /// will go into next libzypp
@@ -41,12 +50,127 @@ namespace
   inline bool patchIsApplicable( const PoolItem & pi )	///< Default content for all patch lists: applicable (needed, optional, unwanted)
   { return pi.isBroken(); }
 
-  inline bool patchIsNeededRestartSuggested( const PoolItem & pi )	///< Needed update stack pack; installed first!
+  ///////////////////////////////////////////////////////////////////
+  /// \class PatchTable
+  /// \brief The pools patches and the attributes the patch lists need.
+  ///
+  /// Built in one pass over the pool and kept until the pool changes (e.g.
+  /// in the shell). The patch lists and patch-check walk all patches, some
+  /// of them several times, and need the Patch object, its category, severity
+  /// and timestamp for each. On systems with many thousand patches creating
+  /// these objects and parsing the strings once instead of per pass and filter
+  /// saves most of the time.
+  ///
+  /// The status is not part of the table, it's always taken from the pool.
+  ///////////////////////////////////////////////////////////////////
+  class PatchTable
+  {
+  public:
+    struct Entry
+    {
+      PoolItem pi;
+      Patch::constPtr patch;
+      Date timestamp;
+      Patch::Category category;
+      std::string categoryLC;	///< lowercased for CliMatchPatch
+      std::string severityLC;	///< lowercased for CliMatchPatch
+      bool restartSuggested;
+
+      bool isApplicable() const
+      { return patchIsApplicable( pi ); }
+
+      bool isNeededRestartSuggested() const	///< Needed update stack pack; installed first!
+      {
+        return pi.isBroken()
+        && ! pi.isUnwanted()
+        && ! ( Zypper::instance().config().exclude_optional_patches && category == Patch::CAT_OPTIONAL )
+        && restartSuggested;
+      }
+
+      bool matches( const CliMatchPatch & cliMatchPatch_r ) const
+      { return cliMatchPatch_r( timestamp, categoryLC, severityLC ); }
+    };
+
+    using const_iterator = std::vector<Entry>::const_iterator;
+
+  public:
+    /** The table of the current pool. */
+    static const PatchTable & instance()
+    {
+      static PatchTable _table;
+      static SerialNumberWatcher _poolWatcher;
+      if ( _poolWatcher.remember( sat::Pool::instance().serial() ) )
+        _table = PatchTable( God->pool() );
+      return _table;
+    }
+
+    const_iterator begin() const	{ return _entries.begin(); }
+    const_iterator end() const		{ return _entries.end(); }
+
+    /** The entry of patch \a solv_r or \c nullptr. */
+    const Entry * find( const sat::Solvable & solv_r ) const
+    {
+      auto it = _index.find( solv_r );
+      return it == _index.end() ? nullptr : &_entries[it->second];
+    }
+
+    /** Whether some patch isNeededRestartSuggested. */
+    bool haveNeededRestartSuggested() const
+    {
+      for ( const Entry & entry : _entries )
+      {
+        if ( entry.isNeededRestartSuggested() )
+          return true;
+      }
+      return false;
+    }
+
+  private:
+    PatchTable()
+    {}
+
+    explicit PatchTable( const ResPool & pool_r )
+    {
+      debug::Measure m( "PatchTable" );
+      for_( it, pool_r.byKindBegin(ResKind::patch), pool_r.byKindEnd(ResKind::patch) )
+      {
+        const PoolItem & pi( *it );
+        Patch::constPtr patch { pi->asKind<Patch>() };
+        _index[pi.satSolvable()] = _entries.size();
+        _entries.push_back( Entry{ pi, patch, patch->timestamp(), patch->categoryEnum(),
+                                   str::toLower( patch->category() ), str::toLower( patch->severity() ),
+                                   patch->restartSuggested() } );
+      }
+      MIL << "PatchTable: " << _entries.size() << " patches" << endl;
+    }
+
+  private:
+    std::vector<Entry> _entries;
+    std::unordered_map<sat::Solvable, unsigned> _index;	///< position in _entries
+  };
+
+  /** The best update of \a sel_r's installed package from an equivalent vendor, for
+   * \c --candidates-only if \c updateCandidateObj is empty because the overall best
+   * candidate comes from a different vendor (like doUpdate, which keeps the vendor).
+   */
+  PoolItem vendorKeepingUpdateCandidate( const ui::Selectable::Ptr & sel_r )
   {
-    return pi.isBroken()
-    && ! pi.isUnwanted()
-    && ! ( Zypper::instance().config().exclude_optional_patches && pi->asKind<Patch>()->categoryEnum() == Patch::CAT_OPTIONAL )
-    && pi->asKind<Patch>()->restartSuggested();
+    PoolItem installed { sel_r->installedObj() };
+    PoolItem best { sel_r->candidateObj() };
+    if ( ! installed || ! best || sel_r->multiversionInstall()
+      || VendorAttr::instance().equivalent( best->vendor(), installed->vendor() ) )
+      return PoolItem();
+
+    for ( const PoolItem & pi : sel_r->available() )	// best first
+    {
+      if ( ! VendorAttr::instance().equivalent( pi->vendor(), installed->vendor() ) )
+        continue;
+      if ( pi->arch() != installed->arch() && pi->arch() != Arch_noarch && installed->arch() != Arch_noarch )
+        continue;
+      if ( pi->edition() > installed->edition() )
+        return pi;
+    }
+    return PoolItem();
   }
 
   std::string stripLastDotSegment( const std::string & rel )
@@ -193,7 +317,8 @@ namespace
 // The following scenarios are handled distinctly:
 // * -t patch (default), no arguments
 // * -t package, no arguments
-//   - uses Resolver::doUpdate()
+//   - uses Resolver::doUpdate() (UpdateMode::Solver)
+//   - or the selectables update candidate (UpdateMode::Candidates)
 // * -t {other}, no arguments
 // * -t patch foo
 // * -t package foo
@@ -233,19 +358,39 @@ namespace
     {}
 
     /** Optionally track total amount of applicable patches */
-    bool visit( const PoolItem & pi_r )
-    { bool ret = pi_r.isBroken(); if ( ret ) ++_visited; return ret; }
+    bool visit( const PatchTable::Entry & entry_r )
+    { bool ret = entry_r.isApplicable(); if ( ret ) ++_visited; return ret; }
 
     /** Optionally track total amount of applicable patches */
     void visit()
     { ++_visited; }
 
     /** Contributing to the stats */
-    void collect( const PoolItem & pi_r )
+    void collect( const PatchTable::Entry & entry_r )
     {
-      Patch::constPtr patch( pi_r->asKind<Patch>() );
-      if ( patch )
-      { collect( pi_r, patch ); }
+      ++_collected;
+      Level level = entry_r.pi.isUnwanted() ? PatchCheckStats::kLOCKED
+                                            : ( entry_r.restartSuggested ? PatchCheckStats::kUSTACK
+                                                                         : PatchCheckStats::kNEEDED );
+
+      Patch::Category cat = entry_r.category;
+      if ( level == kLOCKED )
+        ++_locked;
+      else if ( _excludeOptionalPatches && cat == Patch::CAT_OPTIONAL )
+        ++_optional;
+      else
+      {
+        ++_needed;
+        if ( cat == Patch::CAT_SECURITY )
+          ++_security;
+      }
+
+      // detailed stats:
+      Stats & detail( _stats[cat] );
+      ++detail[level];
+      const std::string & ctgry( entry_r.patch->category() );	// on the fly remember aliases, e.g. 'feature' == 'optional'
+      if ( asString( cat ) != ctgry )
+        detail._aka.insert( ctgry );
     }
 
     unsigned visited() const	{ return _visited; }
@@ -309,33 +454,6 @@ namespace
     typedef std::map<Patch::Category, Stats, CategorySort> StatsMap;
 
   private:
-    void collect( const PoolItem & pi_r, const Patch::constPtr & patch_r )
-    {
-      ++_collected;
-      Level level = pi_r.isUnwanted() ? PatchCheckStats::kLOCKED
-                                      : ( patch_r->restartSuggested() ? PatchCheckStats::kUSTACK
-                                                                      : PatchCheckStats::kNEEDED );
-
-      Patch::Category cat = patch_r->categoryEnum();
-      if ( level == kLOCKED )
-        ++_locked;
-      else if ( _excludeOptionalPatches && cat == Patch::CAT_OPTIONAL )
-        ++_optional;
-      else
-      {
-        ++_needed;
-        if ( cat == Patch::CAT_SECURITY )
-          ++_security;
-      }
-
-      // detailed stats:
-      Stats & detail( _stats[cat] );
-      ++detail[level];
-      const std::string & ctgry( patch_r->category() );	// on the fly remember aliases, e.g. 'feature' == 'optional'
-      if ( asString( cat ) != ctgry )
-        detail._aka.insert( ctgry );
-    }
-
     std::string renderCounter( const Counter & counter_r ) const
     { return counter_r ? asString(counter_r) : "-"; }
 
@@ -469,18 +587,17 @@ void patch_check( bool updatestackOnly )
   DBG << "patch check" << endl;
 
   PatchCheckStats stats( zypper.config().exclude_optional_patches );
-  for_( it, God->pool().byKindBegin(ResKind::patch), God->pool().byKindEnd(ResKind::patch) )
+  for ( const PatchTable::Entry & entry : PatchTable::instance() )
   {
-    const PoolItem & pi( *it );
-    if ( ! stats.visit( pi ) )	// count total applicable patches
+    if ( ! stats.visit( entry ) )	// count total applicable patches
       continue;
 
     // filter out by cli options
-    if ( updatestackOnly && !pi->asKind<Patch>()->restartSuggested() )
+    if ( updatestackOnly && ! entry.restartSuggested )
       continue;
 
     // remaining: collect stats
-    stats.collect( pi );
+    stats.collect( entry );
   }
 
   // render output
@@ -495,31 +612,20 @@ void patch_check( bool updatestackOnly )
 // returns true if NEEDED! restartSuggested() patches are available
 static bool xml_list_patches (Zypper & zypper, bool all_r, const PatchHistoryData & patchHistoryData_r )
 {
-  const ResPool& pool = God->pool();
+  const PatchTable & patches { PatchTable::instance() };
 
   // check whether there are packages affecting the update stack
-  bool pkg_mgr_available = false;
-  for_( it, pool.byKindBegin(ResKind::patch), pool.byKindEnd(ResKind::patch) )
-  {
-    if ( patchIsNeededRestartSuggested( *it ) )
-    {
-      pkg_mgr_available = true;
-      break;
-    }
-  }
+  bool pkg_mgr_available = patches.haveNeededRestartSuggested();
 
   unsigned patchcount = 0;
-  for_( it, pool.byKindBegin(ResKind::patch), pool.byKindEnd(ResKind::patch) )
+  for ( const PatchTable::Entry & entry : patches )
   {
-    if ( all_r || patchIsApplicable( *it ) )
+    if ( all_r || entry.isApplicable() )
     {
-      const PoolItem & pi( *it );
-      Patch::constPtr patch = pi->asKind<Patch>();
-
       // if updates stack patches are available, show only those
-      if ( all_r || !pkg_mgr_available || patchIsNeededRestartSuggested( pi ) )
+      if ( all_r || !pkg_mgr_available || entry.isNeededRestartSuggested() )
       {
-        xmlPrintPatchUpdateOn( cout, pi, patchHistoryData_r );
+        xmlPrintPatchUpdateOn( cout, entry.pi, patchHistoryData_r );
       }
     }
     ++patchcount;
@@ -537,15 +643,10 @@ static bool xml_list_patches (Zypper & zypper, bool all_r, const PatchHistoryDat
     if ( ! all_r )
     {
     cout << "<blocked-update-list>" << endl;
-    for_( it, pool.byKindBegin(ResKind::patch), pool.byKindEnd(ResKind::patch) )
+    for ( const PatchTable::Entry & entry : patches )
     {
-      if ( patchIsApplicable( *it ) )
-      {
-        const PoolItem & pi( *it );
-        Patch::constPtr patch = pi->asKind<Patch>();
-        if ( ! patchIsNeededRestartSuggested( pi ) )
-          xmlPrintPatchUpdateOn( cout, pi, patchHistoryData_r );
-      }
+      if ( entry.isApplicable() && ! entry.isNeededRestartSuggested() )
+        xmlPrintPatchUpdateOn( cout, entry.pi, patchHistoryData_r );
     }
     cout << "</blocked-update-list>" << endl;
     }
@@ -556,10 +657,10 @@ static bool xml_list_patches (Zypper & zypper, bool all_r, const PatchHistoryDat
 
 // ----------------------------------------------------------------------------
 
-static void xml_list_updates(const ResKindSet & kinds, bool all_r, VersionChangeFilter vcFilter_r )
+static void xml_list_updates(const ResKindSet & kinds, bool all_r, UpdateMode mode_r, VersionChangeFilter vcFilter_r )
 {
   Candidates candidates;
-  find_updates( kinds, candidates, all_r );
+  find_updates( kinds, candidates, all_r, mode_r );
 
   for( const PoolItem & pi : candidates )
   {
@@ -588,26 +689,22 @@ static bool list_patch_updates( Zypper & zypper, bool all_r, const PatchSelector
   PatchCheckStats stats( zypper.config().exclude_optional_patches );
   CliMatchPatch cliMatchPatch( zypper, sel._requestedPatchDates, sel._requestedPatchCategories, sel._requestedPatchSeverity );
 
-  const ResPool& pool = God->pool();
-  for_( it, pool.byKindBegin(ResKind::patch), pool.byKindEnd(ResKind::patch) )
+  for ( const PatchTable::Entry & entry : PatchTable::instance() )
   {
-    const PoolItem & pi( *it );
-    Patch::constPtr patch = asKind<Patch>(pi);
+    bool tostat = stats.visit( entry );	// count total applicable patches
 
-    bool tostat = stats.visit( pi );	// count total applicable patches
-
-    if ( ! cliMatchPatch( patch ) )
+    if ( ! entry.matches( cliMatchPatch ) )
       continue;
 
     if ( tostat )	// exclude cliMatchPatch filtered but include undisplayed ones
-      stats.collect( pi );
+      stats.collect( entry );
 
-    if ( all_r || patchIsApplicable( pi ) )
+    if ( all_r || entry.isApplicable() )
     {
-      if ( ! all_r && patchIsNeededRestartSuggested( pi ) )
-        intoPMTbl( pi );
+      if ( ! all_r && entry.isNeededRestartSuggested() )
+        intoPMTbl( entry.pi );
       else
-        intoTbl( pi );
+        intoTbl( entry.pi );
     }
   }
 
@@ -657,14 +754,37 @@ static bool list_patch_updates( Zypper & zypper, bool all_r, const PatchSelector
  * Find all available updates of given kind.
  */
 static void
-find_updates( const ResKind & kind, Candidates & candidates, bool all_r )
+find_updates( const ResKind & kind, Candidates & candidates, bool all_r, UpdateMode mode_r )
 {
   const ResPool& pool = God->pool();
   DBG << "Looking for update candidates of kind " << kind << endl;
 
+  // package update candidates without a solver run: per installed selectable
+  // the best available version libzypp would choose for an update (respecting
+  // arch and vendor changes), no matter whether its dependencies can be met.
+  if (kind == ResKind::package && !all_r && mode_r == UpdateMode::Candidates)
+  {
+    debug::Measure m( "find_updates (candidates)" );
+    for ( const ui::Selectable::Ptr & sel : pool.proxy().byKind( kind ) )
+    {
+      if ( ! sel->hasInstalledObj() || sel->locked() )
+        continue;	// doUpdate would not touch locked ones either
+
+      PoolItem candidate = sel->updateCandidateObj();
+      if ( ! candidate && ! ( candidate = vendorKeepingUpdateCandidate( sel ) ) )
+        continue;
+
+      DBG << "candidate: " << candidate << endl;
+      candidates.insert( candidate );
+    }
+    MIL << "Update candidates (no solver run): " << candidates.size() << endl;
+    return;
+  }
+
   // package updates
   if (kind == ResKind::package && !all_r)
   {
+    debug::Measure m( "find_updates (solver)" );
     God->resolver()->doUpdate();
     ResPool::const_iterator
       it = God->pool().begin(),
@@ -713,10 +833,10 @@ find_updates( const ResKind & kind, Candidates & candidates, bool all_r )
  * Find all available updates of given kinds.
  */
 void
-find_updates(const ResKindSet & kinds, Candidates & candidates , bool all_r)
+find_updates(const ResKindSet & kinds, Candidates & candidates , bool all_r, UpdateMode mode_r)
 {
   for (ResKindSet::const_iterator kit = kinds.begin(); kit != kinds.end(); ++kit)
-    find_updates( *kit, candidates, all_r );
+    find_updates( *kit, candidates, all_r, mode_r );
 
   if (kinds.empty())
     WAR << "called with empty kinds set" << endl;
@@ -740,16 +860,37 @@ std::string i18n_kind_updates(const ResKind & kind)
 
 // ----------------------------------------------------------------------------
 
+const char * asString( UpdateMode mode_r )
+{
+  switch ( mode_r )
+  {
+    case UpdateMode::Solver:		return "solver";
+    case UpdateMode::Candidates:	return "candidates";
+  }
+  return "?";
+}
+
+// ----------------------------------------------------------------------------
+
 // FIXME rewrite this function so that first the list of updates is collected and later correctly presented (bnc #523573)
 
-void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort, bool all_r, const PatchSelector &patchSel_r, VersionChangeFilter vcFilter_r )
+void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort, bool all_r, const PatchSelector &patchSel_r, VersionChangeFilter vcFilter_r, UpdateMode mode_r )
 {
   PatchHistoryData patchHistoryData;	// commonly used by all tables
 
+  // whether package updates are computed according to mode_r
+  bool reportMode = !all_r && kinds.count( ResKind::package );
+  if ( reportMode )
+    MIL << "Package updates mode: " << asString( mode_r ) << endl;
+
   if (zypper.out().type() == Out::TYPE_XML)
   {
     // TODO: go for XmlNode
-    cout << "<update-status version=\"0.6\">" << endl;
+    OutXML::sync( zypper.out() );
+    cout << "<update-status version=\"0.6\"";
+    if ( reportMode )
+      cout << " mode=\"" << asString( mode_r ) << "\"";
+    cout << ">" << endl;
     cout << "<update-list>" << endl;
   }
 
@@ -788,7 +929,7 @@ void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort, b
   {
     if (!affects_pkgmgr)
     {
-      xml_list_updates( localkinds, all_r, vcFilter_r );
+      xml_list_updates( localkinds, all_r, mode_r, vcFilter_r );
       cout << "</update-list>" << endl;		// otherwise closed in xml_list_patches
     }
     cout << "</update-status>" << endl;
@@ -832,7 +973,7 @@ void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort, b
     ResPoolProxy uipool( ResPool::instance().proxy() );
 
     Candidates candidates;
-    find_updates( *it, candidates, all_r );
+    find_updates( *it, candidates, all_r, mode_r );
 
     for ( const PoolItem & pi : candidates )
     {
@@ -876,7 +1017,15 @@ void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort, b
     if (tbl.empty())
       zypper.out().info(_("No updates found."));
     else
+    {
       cout << tbl;
+      if ( reportMode && *it == ResKind::package && mode_r == UpdateMode::Candidates )
+      {
+        zypper.out().gap();
+        // translators: note below the list-updates table if --candidates-only was used
+        zypper.out().info(_("Update candidates were listed without resolving dependencies. Some of them may not be installable."));
+      }
+    }
   }
 }
 
@@ -893,51 +1042,64 @@ void list_patches_by_issue( Zypper & zypper, bool all_r, const PatchSelector & s
                                sel_r._requestedPatchSeverity );
 
 
+  const PatchTable & patches { PatchTable::instance() };
+
   // pass1 finding PoolItems and their matching issues (pi,itype,iid)
   std::vector<const Issue*> pass2; // on the fly remember anyType issues for pass2
   std::map<PoolItem,std::map<std::string,std::set<std::string>>> iresult;
-  for ( const Issue & issue : sel_r._requestedIssues )
   {
-    PoolQuery q;
-    q.setMatchSubstring();
-    q.setCaseSensitive( false );
-    q.addKind( ResKind::patch );
-    // PoolQuery ORs attributes but we need AND.
-    // Post processing the match must assert correct type of specific IDs!
-    if ( issue.specificType() && issue.anyId() )
-    { q.addAttribute(sat::SolvAttr::updateReferenceType, issue.type() ); }
-    else
-    {
-      q.addAttribute( sat::SolvAttr::updateReferenceId, issue.id() );
-      if ( issue.anyType() && issue.specificId() ) 				// remember for pass2
+    auto remember = [&]( const Issue & issue, const IssueIndex::RefList & refs ) {
+      for ( const IssueIndex::Ref * ref : refs )
       {
-        q.addAttribute( sat::SolvAttr::updateReferenceType, issue.id() );	// bnc#941309: let '--issue=bugzilla' also match the type
-        pass2.push_back( &issue );
-      }
-    }
+        const PatchTable::Entry * entry { patches.find( ref->patch ) };
+        if ( ! entry )
+          continue;
 
-    for_( it, q.begin(), q.end() )
-    {
-      PoolItem pi { *it };
+        if ( only_needed && ! entry->isApplicable() )
+          continue;
 
-      if ( only_needed && ! patchIsApplicable( pi ) )
-        continue;
+        if ( ! entry->matches( cliMatchPatch ) )
+        {
+          DBG << entry->pi.ident() << " skipped. (not matching CLI filter)" << endl;
+          continue;
+        }
 
-      if ( ! cliMatchPatch( pi ) )
-      {
-        DBG << pi.ident() << " skipped. (not matching CLI filter)" << endl;
-        continue;
+        if ( issue.specificType() && ref->type != issue.type() )
+          continue;	// assert correct type of specific IDs
+        // remember....
+        iresult[entry->pi][ref->type].insert( ref->id );
       }
+    };
 
-      for_( d, it.matchesBegin(), it.matchesEnd() )
+    // All issue ids are looked up in one pass over the index.
+    const IssueIndex & issueIndex { IssueIndex::instance() };
+    std::vector<const Issue*> byId;
+    std::vector<std::string> needles;
+    for ( const Issue & issue : sel_r._requestedIssues )
+    {
+      if ( issue.specificType() && issue.anyId() )
+        remember( issue, issueIndex.containing( { issue.type() }, /*types*/true )[0] );	// like the PoolQuery did; remember asserts the type
+      else
       {
-        std::string itype { d->subFind( sat::SolvAttr::updateReferenceType ).asString() };
-        if ( issue.specificType() && itype != issue.type() )
-          continue;	// assert correct type of specific IDs
-        // remember....
-        iresult[std::move(pi)][std::move(itype)].insert( d->subFind( sat::SolvAttr::updateReferenceId ).asString() );
+        byId.push_back( &issue );
+        needles.push_back( issue.id() );
+        if ( issue.anyType() && issue.specificId() )	// remember for pass2
+          pass2.push_back( &issue );
       }
     }
+
+    std::vector<IssueIndex::RefList> idMatches { issueIndex.containing( needles, /*types*/false ) };
+    std::vector<IssueIndex::RefList> typeMatches;
+    if ( ! pass2.empty() )
+      typeMatches = issueIndex.containing( needles, /*types*/true );	// bnc#941309: let '--issue=bugzilla' also match the type
+
+    for ( unsigned idx = 0; idx < byId.size(); ++idx )
+    {
+      const Issue & issue { *byId[idx] };
+      remember( issue, idMatches[idx] );
+      if ( issue.anyType() && issue.specificId() )
+        remember( issue, typeMatches[idx] );
+    }
   }
 
   //pass2 (summary/description)
@@ -954,12 +1116,15 @@ void list_patches_by_issue( Zypper & zypper, bool all_r, const PatchSelector & s
 
     for_( it, q.begin(), q.end() )
     {
-      PoolItem pi { *it };
+      const PatchTable::Entry * entry { patches.find( *it ) };
+      if ( ! entry )
+        continue;
+      PoolItem pi { entry->pi };
 
-      if ( only_needed && ! patchIsApplicable( pi ) )
+      if ( only_needed && ! entry->isApplicable() )
         continue;
 
-      if ( ! cliMatchPatch( pi ) )
+      if ( ! entry->matches( cliMatchPatch ) )
       {
         DBG << pi.ident() << " skipped. (not matching CLI filter)" << endl;
         continue;
@@ -1034,47 +1199,41 @@ void list_patches_by_issue( Zypper & zypper, bool all_r, const PatchSelector & s
 
 void mark_updates_by_issue( Zypper & zypper, const std::set<Issue> &issues, SolverRequester::Options srOpts )
 {
+  const PatchTable & patches { PatchTable::instance() };
+  const IssueIndex & issueIndex { IssueIndex::instance() };
   for ( const Issue & issue : issues )
   {
-    PoolQuery q;
-    q.setMatchExact();
-    q.setCaseSensitive( false );
-    q.addKind( ResKind::patch );
-    // PoolQuery ORs attributes but we need AND.
-    // Post processing the match must assert correct type of specific IDs!
-    if ( issue.specificType() && issue.anyId() )
-    { q.addAttribute(sat::SolvAttr::updateReferenceType, issue.type() ); }
-    else
-    { q.addAttribute( sat::SolvAttr::updateReferenceId, issue.id() ); }
+    // ids match exactly (case insensitive), types by substring like in
+    // list_patches_by_issue; the type is asserted below. The references
+    // of one (lowercased) id or type are listed in pool order.
+    IssueIndex::RefList refs { ( issue.specificType() && issue.anyId() ) ? issueIndex.containing( { issue.type() }, /*types*/true )[0]
+                                                                          : issueIndex.byId( issue.id() ) };
 
     SolverRequester sr( srOpts );
     bool found = false;
 
-    for_( it, q.begin(), q.end() )
+    for ( const IssueIndex::Ref * ref : refs )
     {
-      PoolItem pi( *it );
-      Patch::constPtr patch = asKind<Patch>(pi);
+      const PatchTable::Entry * entry { patches.find( ref->patch ) };
+      if ( ! entry )
+        continue;
+      const PoolItem & pi { entry->pi };
 
       if ( !pi.isBroken() ) // not needed
         continue;
 
       // CliMatchPatch not needed, it's fed into srOpts!
 
-      DBG << "got: " << *it << endl;
+      DBG << "got: " << pi << endl;
 
-      for_( d, it.matchesBegin(), it.matchesEnd() )
-      {
-        const std::string & itype = d->subFind( sat::SolvAttr::updateReferenceType ).asString();
+      if ( issue.specificType() && ref->type != issue.type() )
+        continue;	// assert correct type of specific IDs
 
-        if ( issue.specificType() && itype != issue.type() )
-          continue;	// assert correct type of specific IDs
-
-        if ( sr.installPatch( pi ) )
-          found = true;
-        else
-          DBG << str::form("fix for %s issue number %s was not marked.",
-                           issue.type().c_str(), issue.id().c_str() );
-      }
+      if ( sr.installPatch( pi ) )
+        found = true;
+      else
+        DBG << str::form("fix for %s issue number %s was not marked.",
+                         issue.type().c_str(), issue.id().c_str() );
     }
 
     sr.printFeedback( zypper.out() );
@@ -15,6 +15,15 @@ enum VersionChangeFilter {
   VCF_Package = 2,
 };
 
+/** How \ref list_updates computes the package updates. */
+enum class UpdateMode {
+  Solver,	///< run the solver (Resolver::doUpdate): installable updates only
+  Candidates,	///< the best update candidate per installed package; installability is not checked
+};
+
+/** The mode as shown in the output. */
+const char * asString( UpdateMode mode_r );
+
 struct PatchSelector {
   std::set<Issue> _requestedIssues;
   std::set<std::string> _requestedPatchCategories;
@@ -35,13 +44,15 @@ void patch_check(bool updatestackOnly);
  *
  * \param kind  resolvable type
  * \param best_effort
+ * \param mode_r  how package updates are computed (unless \a all)
  */
 void list_updates(Zypper & zypper,
                   const ResKindSet & kinds,
                   bool best_effort,
                   bool all,
                   const PatchSelector &patchSel_r = PatchSelector(),
-                  VersionChangeFilter vcFilter_r = VCF_None );
+                  VersionChangeFilter vcFilter_r = VCF_None,
+                  UpdateMode mode_r = UpdateMode::Solver );
 
 /**
  * List available fixes to all issues or issues specified in --bugzilla
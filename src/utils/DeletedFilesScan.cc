@@ -0,0 +1,458 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string_view>
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pwd.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <zypp-core/base/Logger.h>
+#include <zypp-core/base/Exception.h>
+#include <zypp-core/base/String.h>
+#include <zypp/base/Measure.h>
+
+#include "WorkerPool.h"
+#include "DeletedFilesScan.h"
+
+using namespace zypp;
+
+namespace
+{
+  /** Forking a worker pays off for at least this number of processes. */
+  constexpr unsigned minPidsPerJob = 256;
+  /** Max. number of workers. */
+  constexpr unsigned maxJobs = 8;
+
+  /** Suffix the kernel appends to deleted files in /proc. */
+  constexpr std::string_view deletedTag { " (deleted)" };
+
+  using ProcInfo = DeletedFilesScan::ProcInfo;
+  using FileFilter = DeletedFilesScan::FileFilter;
+
+  /** Buffer for reading /proc files, reused for all processes of a scan. */
+  class ProcBuffer
+  {
+  public:
+    /** Read \a path_r; \c false if it's not readable (process gone or no permission). */
+    bool read( const std::string & path_r )
+    {
+      _size = 0;
+      int fd = ::open( path_r.c_str(), O_RDONLY | O_CLOEXEC );
+      if ( fd < 0 )
+        return false;
+
+      if ( _data.empty() )
+        _data.resize( 64 * 1024 );
+      bool ret = true;
+      while ( true )
+      {
+        if ( _size == _data.size() )
+          _data.resize( 2 * _data.size() );
+        ssize_t n = ::read( fd, _data.data() + _size, _data.size() - _size );
+        if ( n > 0 )
+          _size += n;
+        else if ( n == 0 )
+          break;
+        else if ( errno != EINTR )
+        {
+          ret = false;
+          break;
+        }
+      }
+      ::close( fd );
+      return ret;
+    }
+
+    std::string_view view() const
+    { return std::string_view( _data.data(), _size ); }
+
+  private:
+    std::vector<char> _data;
+    size_t _size = 0;
+  };
+
+  /** The target of the symlink \a path_r or an empty string. */
+  std::string readLink( const std::string & path_r )
+  {
+    char buf[PATH_MAX];
+    ssize_t n = ::readlink( path_r.c_str(), buf, sizeof(buf) );
+    return std::string( buf, n > 0 ? n : 0 );
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// Whether a process runs in a container (as CheckAccessDeleted
+  /// decides it): Some file it has mapped is not the same file
+  /// when looked up from our root.
+  enum class Root { IGNORE, HOST, CONTAINER };
+
+  Root inOurRoot( const std::string & link_r )
+  {
+    struct stat procStat;
+    if ( ::stat( link_r.c_str(), &procStat ) != 0 || procStat.st_nlink == 0 )
+      return Root::IGNORE;	// not accessible or unlinked: try the next one
+
+    std::string target { readLink( link_r ) };
+    if ( target.empty() || target[0] != '/' )
+      return Root::IGNORE;	// pipe, socket or anon_inode (bsc#1218291)
+
+    struct stat linkStat;
+    if ( ::stat( target.c_str(), &linkStat ) != 0 )
+      return Root::CONTAINER;	// not reachable by us
+    if ( linkStat.st_ino != procStat.st_ino || linkStat.st_dev != procStat.st_dev )
+      return Root::CONTAINER;
+    return Root::HOST;
+  }
+
+  bool runsInContainer( const std::string & procDir_r )
+  {
+    Root res = inOurRoot( procDir_r + "/exe" );
+    if ( res != Root::IGNORE )
+      return res == Root::CONTAINER;
+
+    std::string mapFilesDir { procDir_r + "/map_files" };
+    DIR * dir = ::opendir( mapFilesDir.c_str() );
+    if ( ! dir )
+      return false;
+    while ( struct dirent * ent = ::readdir( dir ) )
+    {
+      if ( ent->d_type != DT_LNK )
+        continue;
+      res = inOurRoot( mapFilesDir + "/" + ent->d_name );
+      if ( res != Root::IGNORE )
+        break;
+    }
+    ::closedir( dir );
+    return res == Root::CONTAINER;
+  }
+  ///////////////////////////////////////////////////////////////////
+
+  /** Fill \a info_r if process \a pid_r uses deleted files (passing \a filter_r). */
+  bool scanProcess( const std::string & pid_r, const FileFilter & filter_r, ProcBuffer & buf_r, ProcInfo & info_r )
+  {
+    const std::string procDir { "/proc/" + pid_r };
+    std::vector<std::string> & files { info_r.files };
+    files.clear();
+
+    auto addIf = [&]( std::string_view path_r ) {
+      if ( ! DeletedFilesScan::isLibOrBin( path_r ) )
+        return;
+      std::string file { path_r };
+      if ( filter_r.empty() || filter_r.count( file ) )
+        files.push_back( std::move(file) );
+    };
+
+    // Mapped files (lsof: mem/DEL)
+    if ( buf_r.read( procDir + "/maps" ) )
+    {
+      std::string_view maps { buf_r.view() };
+      while ( ! maps.empty() )
+      {
+        size_t eol = maps.find( '\n' );
+        std::string_view line { maps.substr( 0, eol ) };
+        maps.remove_prefix( eol == std::string_view::npos ? maps.size() : eol + 1 );
+
+        std::string_view path { DeletedFilesScan::deletedMapping( line ) };
+        if ( ! path.empty() )
+          addIf( path );
+      }
+    }
+
+    // The executable (lsof: txt)
+    std::string exe { readLink( procDir + "/exe" ) };
+    {
+      std::string_view path { exe };
+      if ( DeletedFilesScan::stripDeletedTag( path ) )
+        addIf( path );
+    }
+
+    if ( files.empty() )
+      return false;
+
+    std::sort( files.begin(), files.end() );
+    files.erase( std::unique( files.begin(), files.end() ), files.end() );
+
+    if ( runsInContainer( procDir ) )
+    {
+      DBG << "Skip " << pid_r << " running in a container" << std::endl;
+      return false;
+    }
+
+    // pid (comm) state ppid ...; comm may contain anything, so look for the last ')'
+    info_r.pid = pid_r;
+    info_r.ppid.clear();
+    info_r.command.clear();
+    if ( buf_r.read( procDir + "/stat" ) )
+    {
+      std::string_view stat { buf_r.view() };
+      size_t lpar = stat.find( '(' );
+      size_t rpar = stat.rfind( ')' );
+      if ( lpar != std::string_view::npos && rpar != std::string_view::npos && lpar < rpar )
+      {
+        info_r.command = stat.substr( lpar+1, rpar-lpar-1 );
+        std::string_view rest { stat.substr( rpar+1 ) };	// " S ppid ..."
+        size_t ppid = rest.find_first_of( "0123456789" );
+        if ( ppid != std::string_view::npos )
+        {
+          rest.remove_prefix( ppid );
+          info_r.ppid = rest.substr( 0, rest.find( ' ' ) );
+        }
+      }
+    }
+    // the command name is truncated; complete it from the executable if it fits
+    if ( info_r.command.size() == 15 )
+    {
+      std::string_view path { exe };
+      DeletedFilesScan::stripDeletedTag( path );
+      std::string_view name { path.substr( path.rfind( '/' ) + 1 ) };
+      if ( name.substr( 0, 15 ) == info_r.command )
+        info_r.command = name;
+    }
+
+    struct stat procStat;
+    info_r.puid = ( ::stat( procDir.c_str(), &procStat ) == 0 ? str::numstring( procStat.st_uid ) : std::string() );
+    info_r.login.clear();	// resolved by the parent
+    return true;
+  }
+
+  void scanPids( std::vector<std::string>::const_iterator begin_r, std::vector<std::string>::const_iterator end_r,
+                 const FileFilter & filter_r, std::vector<ProcInfo> & result_r )
+  {
+    ProcBuffer buf;
+    ProcInfo info;
+    for ( ; begin_r != end_r; ++begin_r )
+    {
+      if ( scanProcess( *begin_r, filter_r, buf, info ) )
+      {
+        result_r.push_back( std::move(info) );
+        info = ProcInfo();
+      }
+    }
+  }
+} // namespace
+
+bool DeletedFilesScan::isLibOrBin( std::string_view path_r )
+{
+  auto isLibDir = []( std::string_view name_r ) {
+    if ( name_r.substr( 0, 3 ) != "lib" )
+      return false;
+    name_r.remove_prefix( 3 );
+    return name_r.empty() || name_r == "32" || name_r == "64" || name_r == "x32" || name_r == "exec";
+  };
+
+  while ( true )
+  {
+    size_t sep = path_r.find( '/' );
+    if ( sep == std::string_view::npos )	// the file name
+      return path_r.substr( 0, 3 ) == "lib" && path_r.find( ".so" ) != std::string_view::npos;
+
+    std::string_view dir { path_r.substr( 0, sep ) };
+    if ( dir == "bin" || dir == "sbin" || isLibDir( dir ) )
+      return true;
+    path_r.remove_prefix( sep + 1 );
+  }
+}
+
+bool DeletedFilesScan::stripDeletedTag( std::string_view & path_r )
+{
+  if ( path_r.size() <= deletedTag.size() || path_r.substr( path_r.size() - deletedTag.size() ) != deletedTag )
+    return false;
+  path_r.remove_suffix( deletedTag.size() );
+  return true;
+}
+
+std::string_view DeletedFilesScan::deletedMapping( std::string_view line_r )
+{
+  // address perms offset dev inode pathname; only lines ending with the tag need a closer look.
+  if ( ! stripDeletedTag( line_r ) )
+    return std::string_view();
+  size_t path = line_r.find( '/' );
+  if ( path == std::string_view::npos )
+    return std::string_view();
+  return line_r.substr( path );
+}
+
+void DeletedFilesScan::serialize( const ProcInfo & info_r, std::string & out_r )
+{
+  auto field = [&out_r]( char tag_r, const std::string & value_r ) {
+    out_r += tag_r;
+    for ( char ch : value_r )
+    {
+      if ( ch == '\0' )
+        out_r += "\\0";
+      else if ( ch == '\\' )
+        out_r += "\\\\";
+      else
+        out_r += ch;
+    }
+    out_r += '\0';
+  };
+  field( 'p', info_r.pid );
+  field( 'R', info_r.ppid );
+  field( 'u', info_r.puid );
+  field( 'c', info_r.command );
+  for ( const std::string & file : info_r.files )
+    field( 'n', file );
+}
+
+void DeletedFilesScan::deserialize( std::string_view in_r, std::vector<ProcInfo> & result_r )
+{
+  std::string value;
+  while ( ! in_r.empty() )
+  {
+    size_t end = in_r.find( '\0' );
+    if ( end == std::string_view::npos )
+      break;	// incomplete field
+    char tag = in_r[0];
+    value.clear();
+    for ( size_t pos = 1; pos < end; ++pos )
+    {
+      if ( in_r[pos] == '\\' && pos+1 < end )
+        value += ( in_r[++pos] == '0' ? '\0' : in_r[pos] );
+      else
+        value += in_r[pos];
+    }
+    in_r.remove_prefix( end + 1 );
+
+    if ( tag == 'p' )
+    {
+      result_r.push_back( ProcInfo() );
+      result_r.back().pid = value;
+      continue;
+    }
+    if ( result_r.empty() )
+      continue;
+    ProcInfo & info { result_r.back() };
+    switch ( tag )
+    {
+      case 'R': info.ppid = value;			break;
+      case 'u': info.puid = value;			break;
+      case 'c': info.command = value;			break;
+      case 'n': info.files.push_back( value );	break;
+    }
+  }
+}
+
+DeletedFilesScan::FileFilter DeletedFilesScan::resolveDirs( const FileFilter & filter_r )
+{
+  FileFilter ret { filter_r };
+  std::map<std::string,std::string> dirs;
+  for ( const std::string & file : filter_r )
+  {
+    std::string::size_type sep = file.rfind( '/' );
+    if ( sep == std::string::npos || sep == 0 )
+      continue;
+
+    std::string dir { file.substr( 0, sep ) };
+    auto it = dirs.find( dir );
+    if ( it == dirs.end() )
+    {
+      char buf[PATH_MAX];
+      it = dirs.emplace( dir, ::realpath( dir.c_str(), buf ) ? buf : dir.c_str() ).first;
+    }
+    if ( it->second != dir )
+      ret.insert( it->second + file.substr( sep ) );
+  }
+  return ret;
+}
+
+DeletedFilesScan::size_type DeletedFilesScan::check()
+{
+  debug::Measure m( "DeletedFilesScan" );
+  _data.clear();
+
+  std::vector<std::string> pids;
+  DIR * dir = ::opendir( "/proc" );
+  if ( ! dir )
+    ZYPP_THROW( Exception( str::Str() << "Can not read /proc: " << ::strerror( errno ) ) );
+  while ( struct dirent * ent = ::readdir( dir ) )
+  {
+    if ( ::isdigit( ent->d_name[0] ) )
+      pids.push_back( ent->d_name );
+  }
+  ::closedir( dir );
+  // numerically, like lsof lists them
+  std::sort( pids.begin(), pids.end(), []( const std::string & lhs, const std::string & rhs ) {
+    return lhs.size() < rhs.size() || ( lhs.size() == rhs.size() && lhs < rhs );
+  } );
+
+  long cpus = ::sysconf( _SC_NPROCESSORS_ONLN );
+  unsigned jobs = std::min( { maxJobs, unsigned( cpus > 0 ? cpus : 1 ), unsigned( pids.size() / minPidsPerJob ) } );
+  MIL << "Scanning " << pids.size() << " processes for deleted files (" << ( jobs > 1 ? jobs : 1 ) << " jobs, "
+      << ( _fileFilter.empty() ? std::string("any file") : str::numstring( _fileFilter.size() ) + " files of interest" ) << ")" << std::endl;
+  const FileFilter filter { resolveDirs( _fileFilter ) };
+
+  if ( jobs < 2 )
+  {
+    scanPids( pids.begin(), pids.end(), filter, _data );
+  }
+  else
+  {
+    // Contiguous slices, so the results just need to be joined in order.
+    std::vector<std::vector<ProcInfo>> results( jobs );
+    bool failed = false;
+    std::string error;
+    size_t slice = ( pids.size() + jobs - 1 ) / jobs;
+
+    WorkerPool workers( jobs );
+    for ( unsigned idx = 0; idx < jobs; ++idx )
+    {
+      auto begin = pids.cbegin() + std::min( idx * slice, pids.size() );
+      auto end   = pids.cbegin() + std::min( (idx+1) * slice, pids.size() );
+      workers.enqueue(
+        [&filter,begin,end]() {
+          std::vector<ProcInfo> found;
+          scanPids( begin, end, filter, found );
+          std::string out;
+          for ( const ProcInfo & info : found )
+            DeletedFilesScan::serialize( info, out );
+          std::cout.write( out.data(), out.size() );
+          return 0;
+        },
+        [&results,&failed,&error,idx]( int exitcode_r, const std::string & output_r ) {
+          if ( exitcode_r != 0 )
+          {
+            failed = true;
+            error = output_r;
+          }
+          else
+            deserialize( output_r, results[idx] );
+        } );
+    }
+    workers.waitAll();
+
+    if ( failed )
+      ZYPP_THROW( Exception( str::Str() << "Scanning /proc failed: " << error ) );
+
+    for ( std::vector<ProcInfo> & result : results )
+      std::move( result.begin(), result.end(), std::back_inserter( _data ) );
+  }
+
+  std::map<std::string,std::string> logins;
+  for ( ProcInfo & info : _data )
+  {
+    auto it = logins.find( info.puid );
+    if ( it == logins.end() )
+    {
+      unsigned uid = str::strtonum<unsigned>( info.puid );
+      struct passwd * pw = info.puid.empty() ? nullptr : ::getpwuid( uid );
+      it = logins.emplace( info.puid, pw ? pw->pw_name : "" ).first;
+    }
+    info.login = it->second;
+  }
+
+  MIL << "Found " << _data.size() << " processes using deleted files" << std::endl;
+  return _data.size();
+}
@@ -0,0 +1,101 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#ifndef ZYPPER_UTILS_DELETEDFILESSCAN_H
+#define ZYPPER_UTILS_DELETEDFILESSCAN_H
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <zypp/misc/CheckAccessDeleted.h>
+
+/// \brief Find running processes using deleted executables or libraries by scanning /proc.
+///
+/// Drop-in for \c zypp::CheckAccessDeleted which does not run \c lsof, but reads
+/// \c /proc/<pid>/maps and \c /proc/<pid>/exe itself. On hosts with many processes
+/// the scan is split across forked \ref WorkerPool jobs. The result is the same:
+/// deleted files mapped as text or memory, processes running in a container are
+/// skipped and the \c ProcInfo are sorted by pid, their files by name. Unlike
+/// \c CheckAccessDeleted, which looks for \c /lib or \c bin/ anywhere in the
+/// name, \ref isLibOrBin matches path components.
+///
+/// A \ref fileFilter restricts the result to the given files (e.g. the ones
+/// replaced by a commit). The filter may use paths below symlinked directories
+/// (like \c /lib64 on a \c usrmerge system), they are resolved before the scan.
+///
+/// \code
+///   DeletedFilesScan checker;
+///   for ( const auto & procInfo : checker )
+///     cout << procInfo.pid << " " << procInfo.service() << endl;
+/// \endcode
+class DeletedFilesScan
+{
+public:
+  using ProcInfo       = zypp::CheckAccessDeleted::ProcInfo;
+  using size_type      = size_t;
+  using value_type     = ProcInfo;
+  using const_iterator = std::vector<ProcInfo>::const_iterator;
+  using FileFilter     = std::unordered_set<std::string>;
+
+public:
+  /** Whether \a path_r is checked at all: a file below a \c bin, \c sbin, \c lib,
+   * \c lib32, \c lib64, \c libx32 or \c libexec directory, or a shared library
+   * \c lib*.so* anywhere.
+   */
+  static bool isLibOrBin( std::string_view path_r );
+
+  /** \name Building blocks of \ref check.
+   * Public for testing.
+   */
+  //@{
+  /** Strip the \c " (deleted)" tag the kernel appends to deleted files from \a path_r;
+   * \c false if there is none.
+   */
+  static bool stripDeletedTag( std::string_view & path_r );
+  /** The deleted file mapped in the \c /proc/<pid>/maps line \a line_r or an empty view. */
+  static std::string_view deletedMapping( std::string_view line_r );
+  /** Append \a info_r to \a out_r as NUL terminated fields, tagged like \c lsof \c -F0 does.
+   * This is how the workers pass their result; \c NUL and \c \\ in values are escaped.
+   */
+  static void serialize( const ProcInfo & info_r, std::string & out_r );
+  /** Append the \c ProcInfo \ref serialize wrote to \a in_r to \a result_r. */
+  static void deserialize( std::string_view in_r, std::vector<ProcInfo> & result_r );
+  /** \a filter_r plus the files with their directory resolved (the kernel reports real paths). */
+  static FileFilter resolveDirs( const FileFilter & filter_r );
+  //@}
+
+public:
+  /** Ctor; scans unless \a doCheck_r is \c false.
+   * \throws Exception if /proc can not be read.
+   */
+  explicit DeletedFilesScan( bool doCheck_r = true )
+  { if ( doCheck_r ) check(); }
+
+  /** Scan /proc; returns the number of processes found.
+   * \throws Exception if /proc can not be read or a worker failed.
+   */
+  size_type check();
+
+  /** Report only these files; empty: all deleted libraries and executables. */
+  const FileFilter & fileFilter() const
+  { return _fileFilter; }
+
+  void setFileFilter( FileFilter filter_r )
+  { _fileFilter = std::move(filter_r); }
+
+  bool empty() const		{ return _data.empty(); }
+  size_type size() const	{ return _data.size(); }
+  const_iterator begin() const	{ return _data.begin(); }
+  const_iterator end() const	{ return _data.end(); }
+
+private:
+  FileFilter _fileFilter;
+  std::vector<ProcInfo> _data;
+};
+
+#endif // ZYPPER_UTILS_DELETEDFILESSCAN_H
@@ -0,0 +1,103 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+#include <zypp-core/base/Logger.h>
+#include <zypp/base/Measure.h>
+#include <zypp/base/SerialNumber.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/Patch.h>
+
+#include "IssueIndex.h"
+#include "NeedleMatcher.h"
+
+using namespace zypp;
+using std::endl;
+
+namespace
+{
+  using KeyMap = std::unordered_map<std::string, std::vector<unsigned>>;
+
+  std::vector<std::pair<std::string, std::vector<unsigned>>> sorted( KeyMap && map_r )
+  {
+    std::vector<std::pair<std::string, std::vector<unsigned>>> ret( std::make_move_iterator( map_r.begin() ), std::make_move_iterator( map_r.end() ) );
+    std::sort( ret.begin(), ret.end(), []( const auto & lhs, const auto & rhs ) { return lhs.first < rhs.first; } );
+    return ret;
+  }
+} // namespace
+
+const IssueIndex & IssueIndex::instance()
+{
+  static IssueIndex _index;
+  static SerialNumberWatcher _poolWatcher;
+  if ( _poolWatcher.remember( sat::Pool::instance().serial() ) )
+    _index = IssueIndex( ResPool::instance() );
+  return _index;
+}
+
+IssueIndex::IssueIndex( const ResPool & pool_r )
+{
+  debug::Measure m( "IssueIndex" );
+  KeyMap ids;
+  KeyMap types;
+  for_( pit, pool_r.byKindBegin(ResKind::patch), pool_r.byKindEnd(ResKind::patch) )
+  {
+    Patch::constPtr patch { (*pit)->asKind<Patch>() };
+    for_( it, patch->referencesBegin(), patch->referencesEnd() )
+    {
+      unsigned ref = _refs.size();
+      _refs.push_back( Ref{ patch->satSolvable(), it.type(), it.id() } );
+      ids[str::toLower( _refs.back().id )].push_back( ref );
+      types[str::toLower( _refs.back().type )].push_back( ref );
+    }
+  }
+  _ids = sorted( std::move(ids) );
+  _types = sorted( std::move(types) );
+  MIL << "IssueIndex: " << _refs.size() << " references, " << _ids.size() << " ids, " << _types.size() << " types" << endl;
+}
+
+std::vector<IssueIndex::RefList> IssueIndex::containing( const std::vector<std::string> & needles_r, bool types_r ) const
+{
+  std::vector<RefList> ret( needles_r.size() );
+  std::vector<std::string> needles;	// the keys are lowercased
+  std::vector<unsigned> empty;
+  for ( unsigned idx = 0; idx < needles_r.size(); ++idx )
+  {
+    needles.push_back( str::toLower( needles_r[idx] ) );
+    if ( needles_r[idx].empty() )
+      empty.push_back( idx );
+  }
+  NeedleMatcher matcher( needles );
+
+  std::vector<unsigned> found;
+  for ( const auto & [key, refs] : ( types_r ? _types : _ids ) )
+  {
+    found = empty;
+    matcher.scan( key, [&found]( unsigned idx_r ) { found.push_back( idx_r ); } );
+    std::sort( found.begin(), found.end() );
+    found.erase( std::unique( found.begin(), found.end() ), found.end() );
+    for ( unsigned idx : found )
+      for ( unsigned ref : refs )
+        ret[idx].push_back( &_refs[ref] );
+  }
+  return ret;
+}
+
+IssueIndex::RefList IssueIndex::lookup( const KeyIndex & index_r, const std::string & key_r ) const
+{
+  RefList ret;
+  auto it = std::lower_bound( index_r.begin(), index_r.end(), key_r,
+                              []( const auto & lhs, const std::string & rhs ) { return lhs.first < rhs; } );
+  if ( it != index_r.end() && it->first == key_r )
+  {
+    for ( unsigned ref : it->second )
+      ret.push_back( &_refs[ref] );
+  }
+  return ret;
+}
@@ -0,0 +1,79 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#ifndef ZYPPER_UTILS_ISSUEINDEX_H
+#define ZYPPER_UTILS_ISSUEINDEX_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <zypp-core/base/String.h>
+#include <zypp/sat/Solvable.h>
+#include <zypp/ResPool.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class IssueIndex
+/// \brief The patches references (issue type and id) indexed by lowercased id and type.
+///
+/// Built from the pools patches and kept until the pool changes. Replaces a
+/// PoolQuery per requested issue: exact (case insensitive) lookups are a binary
+/// search, substring lookups of many issues at once a single \ref NeedleMatcher
+/// pass over the distinct ids.
+///////////////////////////////////////////////////////////////////
+class IssueIndex
+{
+public:
+  /** A patch reference. */
+  struct Ref
+  {
+    zypp::sat::Solvable patch;
+    std::string type;
+    std::string id;
+  };
+
+  using RefList = std::vector<const Ref *>;
+
+public:
+  /** The index of the current pool (rebuilt if the pool changed). */
+  static const IssueIndex & instance();
+
+  /** Index the references of the patches in \a pool_r. */
+  explicit IssueIndex( const zypp::ResPool & pool_r );
+
+  /** References whose id equals \a id_r (case insensitive). */
+  RefList byId( const std::string & id_r ) const
+  { return lookup( _ids, zypp::str::toLower( id_r ) ); }
+
+  /** References whose type equals \a type_r (case insensitive). */
+  RefList byType( const std::string & type_r ) const
+  { return lookup( _types, zypp::str::toLower( type_r ) ); }
+
+  /** For each of \a needles_r the references whose id (or type if \a types_r)
+   * contains it (case insensitive). An empty needle matches all references.
+   */
+  std::vector<RefList> containing( const std::vector<std::string> & needles_r, bool types_r ) const;
+
+  /** Number of references. */
+  unsigned size() const
+  { return _refs.size(); }
+
+private:
+  /** Lowercased key and the indices of its references in _refs, sorted by key. */
+  using KeyIndex = std::vector<std::pair<std::string, std::vector<unsigned>>>;
+
+  IssueIndex()
+  {}
+
+  RefList lookup( const KeyIndex & index_r, const std::string & key_r ) const;
+
+private:
+  std::vector<Ref> _refs;	///< in pool order
+  KeyIndex _ids;
+  KeyIndex _types;
+};
+
+#endif // ZYPPER_UTILS_ISSUEINDEX_H
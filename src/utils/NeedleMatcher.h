@@ -0,0 +1,93 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#ifndef ZYPPER_UTILS_NEEDLEMATCHER_H
+#define ZYPPER_UTILS_NEEDLEMATCHER_H
+
+#include <map>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////
+/// \class NeedleMatcher
+/// \brief Find which of a set of needles a string contains, in one pass (Aho-Corasick).
+///////////////////////////////////////////////////////////////////
+class NeedleMatcher
+{
+public:
+  /** Ctor; empty needles are ignored. */
+  explicit NeedleMatcher( const std::vector<std::string> & needles_r )
+  {
+    _nodes.emplace_back();	// root
+    for ( unsigned idx = 0; idx < needles_r.size(); ++idx )
+    {
+      if ( needles_r[idx].empty() )
+        continue;
+      unsigned node = 0;
+      for ( unsigned char ch : needles_r[idx] )
+      {
+        auto it = _nodes[node].next.find( ch );
+        if ( it == _nodes[node].next.end() )
+        {
+          _nodes.emplace_back();
+          it = _nodes[node].next.emplace( ch, _nodes.size()-1 ).first;
+        }
+        node = it->second;
+      }
+      _nodes[node].out.push_back( idx );
+    }
+
+    // failure links, breadth first
+    std::queue<unsigned> todo;
+    for ( const auto & [ch, child] : _nodes[0].next )
+      todo.push( child );
+    while ( ! todo.empty() )
+    {
+      unsigned node = todo.front();
+      todo.pop();
+      for ( const auto & [ch, child] : _nodes[node].next )
+      {
+        unsigned fail = _nodes[node].fail;
+        while ( fail && ! _nodes[fail].next.count( ch ) )
+          fail = _nodes[fail].fail;
+        auto it = _nodes[fail].next.find( ch );
+        _nodes[child].fail = ( it != _nodes[fail].next.end() && it->second != child ) ? it->second : 0;
+        const std::vector<unsigned> & inherited { _nodes[_nodes[child].fail].out };
+        _nodes[child].out.insert( _nodes[child].out.end(), inherited.begin(), inherited.end() );
+        todo.push( child );
+      }
+    }
+  }
+
+  /** Call \a fnc_r with the index of each needle \a haystack_r contains (once per occurrence). */
+  template <class TFnc>
+  void scan( std::string_view haystack_r, TFnc && fnc_r ) const
+  {
+    unsigned node = 0;
+    for ( unsigned char ch : haystack_r )
+    {
+      while ( node && ! _nodes[node].next.count( ch ) )
+        node = _nodes[node].fail;
+      auto it = _nodes[node].next.find( ch );
+      node = ( it == _nodes[node].next.end() ? 0 : it->second );
+      for ( unsigned idx : _nodes[node].out )
+        fnc_r( idx );
+    }
+  }
+
+private:
+  struct Node
+  {
+    std::map<unsigned char,unsigned> next;
+    unsigned fail = 0;
+    std::vector<unsigned> out;	///< needles ending here
+  };
+  std::vector<Node> _nodes;
+};
+
+#endif // ZYPPER_UTILS_NEEDLEMATCHER_H
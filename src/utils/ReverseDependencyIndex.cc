@@ -0,0 +1,96 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <map>
+
+#include <zypp-core/base/Logger.h>
+#include <zypp/base/Measure.h>
+#include <zypp/base/SerialNumber.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/WhatProvides.h>
+#include <zypp/ZConfig.h>
+
+#include "ReverseDependencyIndex.h"
+
+using namespace zypp;
+using std::endl;
+
+const ReverseDependencyIndex & ReverseDependencyIndex::get( const sat::SolvAttr & attr_r )
+{
+  static std::map<sat::detail::IdType, ReverseDependencyIndex> _cache;
+  static SerialNumberWatcher _poolWatcher;
+  if ( _poolWatcher.remember( sat::Pool::instance().serial() ) )
+    _cache.clear();
+
+  auto it = _cache.find( attr_r.id() );
+  if ( it == _cache.end() )
+    it = _cache.emplace( attr_r.id(), ReverseDependencyIndex( attr_r ) ).first;
+  return it->second;
+}
+
+std::unordered_map<sat::Solvable, CapabilitySet> ReverseDependencyIndex::whatMatches( const std::unordered_set<sat::Solvable> & providers_r ) const
+{
+  std::unordered_map<sat::Solvable, CapabilitySet> ret;
+  if ( providers_r.empty() )
+    return ret;
+
+  std::vector<sat::Solvable> by;
+  for ( const auto & [ cap, dependents ] : _index )
+  {
+    by.clear();
+    for ( const sat::Solvable & prv : sat::WhatProvides( cap ) )
+    {
+      if ( providers_r.count( prv ) )
+        by.push_back( prv );
+    }
+    if ( by.empty() )
+      continue;
+
+    for ( const sat::Solvable & dependent : dependents )
+    {
+      if ( by.size() == 1 && by.front() == dependent )
+        continue;	// whatMatchesSolvable filters self-matches
+      ret[dependent].insert( cap );
+    }
+  }
+  return ret;
+}
+
+ReverseDependencyIndex::ReverseDependencyIndex( const sat::SolvAttr & attr_r )
+{
+  Dep dep { Dep::REQUIRES };
+  if      ( attr_r == sat::SolvAttr::dep_provides )	dep = Dep::PROVIDES;
+  else if ( attr_r == sat::SolvAttr::dep_requires )	dep = Dep::REQUIRES;
+  else if ( attr_r == sat::SolvAttr::dep_conflicts )	dep = Dep::CONFLICTS;
+  else if ( attr_r == sat::SolvAttr::dep_obsoletes )	dep = Dep::OBSOLETES;
+  else if ( attr_r == sat::SolvAttr::dep_recommends )	dep = Dep::RECOMMENDS;
+  else if ( attr_r == sat::SolvAttr::dep_suggests )	dep = Dep::SUGGESTS;
+  else if ( attr_r == sat::SolvAttr::dep_supplements )	dep = Dep::SUPPLEMENTS;
+  else if ( attr_r == sat::SolvAttr::dep_enhances )	dep = Dep::ENHANCES;
+  else
+    ZYPP_THROW( Exception( "No reverse search for " + attr_r.asString() ) );
+
+  debug::Measure m( "ReverseDependencyIndex " + attr_r.asString() );
+  const Arch & sysarch { ZConfig::instance().systemArchitecture() };
+  std::unordered_map<sat::detail::IdType, unsigned> pos;
+  for ( const sat::Solvable & slv : sat::Pool::instance().solvables() )
+  {
+    // as pool_whatmatchessolvable: available ones must be installable
+    if ( ! slv.isSystem() && ! slv.arch().compatibleWith( sysarch ) )
+      continue;
+
+    for ( const Capability & cap : slv.dep( dep ) )
+    {
+      auto res = pos.emplace( cap.id(), _index.size() );
+      if ( res.second )
+        _index.emplace_back( cap, std::vector<sat::Solvable>() );
+      std::vector<sat::Solvable> & dependents { _index[res.first->second].second };
+      if ( dependents.empty() || dependents.back() != slv )
+        dependents.push_back( slv );
+    }
+  }
+  MIL << "ReverseDependencyIndex " << attr_r << ": " << _index.size() << " capabilities" << endl;
+}
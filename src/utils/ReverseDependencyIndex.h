@@ -0,0 +1,49 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#ifndef ZYPPER_UTILS_REVERSEDEPENDENCYINDEX_H
+#define ZYPPER_UTILS_REVERSEDEPENDENCYINDEX_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <zypp/Capability.h>
+#include <zypp/sat/Solvable.h>
+#include <zypp/sat/SolvAttr.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class ReverseDependencyIndex
+/// \brief The capabilities of one dependency kind in the pool and the
+/// solvables depending on them.
+///
+/// Built in one pass over the pool and kept until the pool changes (e.g.
+/// in the shell or server). A reverse search (\c search --requires-pkg etc.)
+/// then needs one whatprovides lookup per distinct capability, rather than a
+/// pool_whatmatchessolvable scan per query hit and a matchesSolvable call per
+/// match (--verbose).
+///////////////////////////////////////////////////////////////////
+class ReverseDependencyIndex
+{
+public:
+  /** The index for \a attr_r (one of the \c dep_* attributes) of the current pool. */
+  static const ReverseDependencyIndex & get( const zypp::sat::SolvAttr & attr_r );
+
+  /** The solvables having an \c attr_r dependency provided by one of \a providers_r,
+   * and these dependencies. Like \ref sat::Pool::whatMatchesSolvable and
+   * \ref sat::Solvable::matchesSolvable for each of \a providers_r.
+   */
+  std::unordered_map<zypp::sat::Solvable, zypp::CapabilitySet> whatMatches( const std::unordered_set<zypp::sat::Solvable> & providers_r ) const;
+
+private:
+  explicit ReverseDependencyIndex( const zypp::sat::SolvAttr & attr_r );
+
+private:
+  std::vector<std::pair<zypp::Capability, std::vector<zypp::sat::Solvable>>> _index;
+};
+
+#endif // ZYPPER_UTILS_REVERSEDEPENDENCYINDEX_H
@@ -0,0 +1,373 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <zypp-core/base/Logger.h>
+#include <zypp-core/base/Exception.h>
+#include <zypp-core/base/String.h>
+#include <zypp-core/fs/PathInfo.h>
+#include <zypp/base/Measure.h>
+#include <zypp/sat/SolvAttr.h>
+
+#include "SearchIndex.h"
+
+using namespace zypp;
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+// File layout: Header, Entry[entries[0]] (name), Entry[entries[1]]
+// (summary/description), postings. The postings of an Entry are
+// the varint encoded deltas of the (solvable id - first id + 1) of
+// the solvables containing the trigram. All in host byte order; it's
+// a local cache like the solv file.
+///////////////////////////////////////////////////////////////////
+
+struct SearchIndex::Header
+{
+  char     magic[8];
+  uint64_t solvSize;	///< of the solv file the index was built from
+  int64_t  solvMtime;	///< of the solv file the index was built from
+  uint32_t span;	///< last - first solvable id + 1
+  uint32_t entries[2];	///< per section
+  uint64_t size;	///< of the index file, to detect a truncated one
+};
+
+struct SearchIndex::Entry
+{
+  uint32_t trigram;
+  uint32_t count;
+  uint64_t offset;	///< of the postings in the file
+};
+
+namespace
+{
+  constexpr const char magic[8] = { 'Z', 'Y', 'S', 'I', 'D', 'X', '0', '2' };	// 02: names without kind prefix, file size in header
+
+  inline Pathname indexFile( const Pathname & dir_r )
+  { return dir_r / "search-index"; }
+
+  inline Pathname solvFile( const Pathname & dir_r )
+  { return dir_r / "solv"; }
+
+  inline unsigned char lower( unsigned char ch_r )
+  { return( ch_r >= 'A' && ch_r <= 'Z' ? ch_r + ('a'-'A') : ch_r ); }
+
+  inline uint32_t trigram( const char * str_r )
+  { return ( uint32_t(lower( str_r[0] )) << 16 ) | ( uint32_t(lower( str_r[1] )) << 8 ) | uint32_t(lower( str_r[2] )); }
+
+  /** First id and span (last - first + 1) of \a repo_r's solvables. */
+  std::pair<sat::Solvable::IdType,uint32_t> idSpan( const Repository & repo_r )
+  {
+    sat::Solvable::IdType first = 0;
+    sat::Solvable::IdType last = 0;
+    for ( const sat::Solvable & slv : repo_r.solvables() )
+    {
+      if ( ! first )
+        first = slv.id();
+      last = slv.id();
+    }
+    return { first, first ? last - first + 1 : 0 };
+  }
+
+  /** Postings of a trigram while building the index. */
+  struct Posting
+  {
+    void add( uint32_t rel_r )	// rel_r is id - first id + 1
+    {
+      if ( rel_r == _last )
+        return;	// trigram occurs more than once in the same solvable
+      uint32_t delta = rel_r - _last;
+      while ( delta >= 0x80 )
+      {
+        _data += char( ( delta & 0x7f ) | 0x80 );
+        delta >>= 7;
+      }
+      _data += char( delta );
+      _last = rel_r;
+      ++_count;
+    }
+
+    uint32_t _last = 0;
+    uint32_t _count = 0;
+    std::string _data;
+  };
+
+  using Section = std::unordered_map<uint32_t,Posting>;
+
+  void addTrigrams( Section & section_r, const char * str_r, uint32_t rel_r )
+  {
+    if ( ! str_r )
+      return;
+    size_t len = ::strlen( str_r );
+    for ( size_t i = 0; i+3 <= len; ++i )
+      section_r[trigram( str_r+i )].add( rel_r );
+  }
+
+  /** Distinct trigrams in \a literal_r. */
+  std::vector<uint32_t> trigramsOf( const std::string & literal_r )
+  {
+    std::vector<uint32_t> ret;
+    for ( size_t i = 0; i+3 <= literal_r.size(); ++i )
+      ret.push_back( trigram( literal_r.c_str()+i ) );
+    std::sort( ret.begin(), ret.end() );
+    ret.erase( std::unique( ret.begin(), ret.end() ), ret.end() );
+    return ret;
+  }
+} // namespace
+
+Pathname SearchIndex::dir( const Pathname & solvCachePath_r, const Repository & repo_r )
+{ return solvCachePath_r / ( repo_r.isSystemRepo() ? repo_r.alias() : repo_r.info().escaped_alias() ); }
+
+bool SearchIndex::upToDate( const Pathname & dir_r )
+{
+  PathInfo solv { solvFile( dir_r ) };
+  if ( ! solv.isFile() )
+    return false;
+
+  Header header;
+  PathInfo index { indexFile( dir_r ) };
+  std::ifstream in( index.path().c_str(), std::ios::binary );
+  if ( ! in.read( reinterpret_cast<char*>(&header), sizeof(header) ) )
+    return false;
+  return( ::memcmp( header.magic, magic, sizeof(magic) ) == 0
+          && header.size == uint64_t(index.size())
+          && header.solvSize == uint64_t(solv.size())
+          && header.solvMtime == int64_t(solv.mtime()) );
+}
+
+void SearchIndex::build( const Repository & repo_r, const Pathname & dir_r )
+{
+  debug::Measure m( "SearchIndex::build " + repo_r.alias() );
+  PathInfo solv { solvFile( dir_r ) };
+  if ( ! solv.isFile() )
+    ZYPP_THROW( Exception( str::Str() << "No solv file in " << dir_r ) );
+
+  auto [ first, span ] = idSpan( repo_r );
+  Section sections[2];
+  for ( const sat::Solvable & slv : repo_r.solvables() )
+  {
+    uint32_t rel = slv.id() - first + 1;
+    addTrigrams( sections[0], slv.name().c_str(), rel );	// without kind prefix
+    addTrigrams( sections[1], slv.lookupStrAttribute( sat::SolvAttr::summary ).c_str(), rel );
+    addTrigrams( sections[1], slv.lookupStrAttribute( sat::SolvAttr::description ).c_str(), rel );
+  }
+
+  Header header;
+  ::memcpy( header.magic, magic, sizeof(magic) );
+  header.solvSize = solv.size();
+  header.solvMtime = solv.mtime();
+  header.span = span;
+  header.entries[0] = sections[0].size();
+  header.entries[1] = sections[1].size();
+
+  std::vector<Entry> entries[2];
+  uint64_t offset = sizeof(Header) + ( header.entries[0] + header.entries[1] ) * sizeof(Entry);
+  for ( unsigned sec = 0; sec < 2; ++sec )
+  {
+    for ( const auto & p : sections[sec] )
+      entries[sec].push_back( Entry{ p.first, p.second._count, 0 } );
+    std::sort( entries[sec].begin(), entries[sec].end(), []( const Entry & lhs, const Entry & rhs ) { return lhs.trigram < rhs.trigram; } );
+    for ( Entry & entry : entries[sec] )
+    {
+      entry.offset = offset;
+      offset += sections[sec][entry.trigram]._data.size();
+    }
+  }
+  header.size = offset;
+
+  // write a new file and replace the old one, so readers never see a partial index
+  Pathname tmpfile { indexFile( dir_r ).extend( ".new" ) };
+  {
+    std::ofstream out( tmpfile.c_str(), std::ios::binary | std::ios::trunc );
+    out.write( reinterpret_cast<const char*>(&header), sizeof(header) );
+    for ( unsigned sec = 0; sec < 2; ++sec )
+      out.write( reinterpret_cast<const char*>(entries[sec].data()), entries[sec].size() * sizeof(Entry) );
+    for ( unsigned sec = 0; sec < 2; ++sec )
+    {
+      for ( const Entry & entry : entries[sec] )
+      {
+        const std::string & data { sections[sec][entry.trigram]._data };
+        out.write( data.data(), data.size() );
+      }
+    }
+    if ( ! out.flush() )
+    {
+      ::unlink( tmpfile.c_str() );
+      ZYPP_THROW( Exception( str::Str() << "Can't write " << tmpfile ) );
+    }
+  }
+  if ( ::rename( tmpfile.c_str(), indexFile( dir_r ).c_str() ) != 0 )
+  {
+    std::string err { ::strerror( errno ) };
+    ::unlink( tmpfile.c_str() );
+    ZYPP_THROW( Exception( str::Str() << "Can't rename " << tmpfile << ": " << err ) );
+  }
+  MIL << "Search index for " << repo_r.alias() << ": " << header.entries[0] << "+" << header.entries[1] << " trigrams, " << offset << " bytes" << endl;
+}
+
+bool SearchIndex::update( const Repository & repo_r, const Pathname & dir_r )
+{
+  if ( upToDate( dir_r ) )
+    return true;
+
+  try
+  {
+    build( repo_r, dir_r );
+    return true;
+  }
+  catch ( const Exception & e )
+  {
+    ZYPP_CAUGHT( e );
+    WAR << "No search index for " << repo_r.alias() << endl;
+  }
+  return false;
+}
+
+SearchIndex::SearchIndex( const Repository & repo_r, const Pathname & dir_r )
+: _repo( repo_r )
+{
+  PathInfo solv { solvFile( dir_r ) };
+  if ( ! solv.isFile() )
+    return;
+
+  int fd = ::open( indexFile( dir_r ).c_str(), O_RDONLY | O_CLOEXEC );
+  if ( fd < 0 )
+    return;
+
+  struct stat st;
+  if ( ::fstat( fd, &st ) == 0 && size_t(st.st_size) >= sizeof(Header) )
+  {
+    void * addr = ::mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( addr != MAP_FAILED )
+    {
+      _data = static_cast<const char *>(addr);
+      _size = st.st_size;
+    }
+  }
+  ::close( fd );
+  if ( ! _data )
+    return;
+
+  const Header & header { *reinterpret_cast<const Header *>(_data) };
+  auto [ first, span ] = idSpan( repo_r );
+  _firstId = first;
+
+  const char * reason = nullptr;
+  if ( ::memcmp( header.magic, magic, sizeof(magic) ) != 0 )
+    reason = "bad magic";
+  else if ( header.solvSize != uint64_t(solv.size()) || header.solvMtime != int64_t(solv.mtime()) )
+    reason = "solv file changed";
+  else if ( header.span != span )
+    reason = "repo does not match";
+  else if ( _size != header.size || _size < sizeof(Header) + ( uint64_t(header.entries[0]) + header.entries[1] ) * sizeof(Entry) )
+    reason = "truncated";
+
+  if ( reason )
+  {
+    DBG << "Search index for " << repo_r.alias() << " is not usable: " << reason << endl;
+    ::munmap( const_cast<char *>(_data), _size );
+    _data = nullptr;
+    _size = 0;
+  }
+}
+
+SearchIndex::~SearchIndex()
+{
+  if ( _data )
+    ::munmap( const_cast<char *>(_data), _size );
+}
+
+std::vector<unsigned> SearchIndex::lookup( const std::string & literal_r, unsigned section_r ) const
+{
+  const Header & header { *reinterpret_cast<const Header *>(_data) };
+  const Entry * begin = reinterpret_cast<const Entry *>( _data + sizeof(Header) );
+  if ( section_r )
+    begin += header.entries[0];
+  const Entry * end = begin + header.entries[section_r];
+
+  // Intersect the postings, starting with the shortest
+  std::vector<const Entry *> hits;
+  for ( uint32_t tri : trigramsOf( literal_r ) )
+  {
+    const Entry * it = std::lower_bound( begin, end, tri, []( const Entry & lhs, uint32_t rhs ) { return lhs.trigram < rhs; } );
+    if ( it == end || it->trigram != tri )
+      return {};	// no solvable contains this trigram
+    hits.push_back( it );
+  }
+  std::sort( hits.begin(), hits.end(), []( const Entry * lhs, const Entry * rhs ) { return lhs->count < rhs->count; } );
+
+  std::vector<unsigned> ret;
+  bool initial = true;
+  for ( const Entry * entry : hits )
+  {
+    std::vector<unsigned> posting;
+    posting.reserve( entry->count );
+    const char * p = _data + std::min<uint64_t>( entry->offset, _size );
+    const char * pend = _data + _size;
+    unsigned rel = 0;
+    for ( uint32_t n = 0; n < entry->count && p < pend; ++n )
+    {
+      uint32_t delta = 0;
+      for ( unsigned shift = 0; p < pend; shift += 7 )
+      {
+        unsigned char ch = *p++;
+        delta |= uint32_t( ch & 0x7f ) << shift;
+        if ( ! ( ch & 0x80 ) )
+          break;
+      }
+      rel += delta;
+      posting.push_back( rel - 1 );
+    }
+
+    if ( initial )
+    {
+      ret.swap( posting );
+      initial = false;
+    }
+    else
+    {
+      std::vector<unsigned> both;
+      std::set_intersection( ret.begin(), ret.end(), posting.begin(), posting.end(), std::back_inserter( both ) );
+      ret.swap( both );
+    }
+    if ( ret.empty() )
+      break;
+  }
+  return ret;
+}
+
+std::optional<std::vector<sat::Solvable>> SearchIndex::candidates( const std::string & literal_r, bool text_r ) const
+{
+  if ( ! _data || literal_r.size() < 3 )
+    return std::nullopt;
+
+  std::vector<unsigned> rels { lookup( literal_r, 0 ) };
+  if ( text_r )
+  {
+    std::vector<unsigned> text { lookup( literal_r, 1 ) };
+    std::vector<unsigned> both;
+    std::set_union( rels.begin(), rels.end(), text.begin(), text.end(), std::back_inserter( both ) );
+    rels.swap( both );
+  }
+
+  std::vector<sat::Solvable> ret;
+  ret.reserve( rels.size() );
+  for ( unsigned rel : rels )
+    ret.push_back( sat::Solvable( _firstId + rel ) );
+  return ret;
+}
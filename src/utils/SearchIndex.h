@@ -0,0 +1,93 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#ifndef ZYPPER_UTILS_SEARCHINDEX_H
+#define ZYPPER_UTILS_SEARCHINDEX_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <zypp-core/Pathname.h>
+#include <zypp-core/base/NonCopyable.h>
+#include <zypp/sat/Solvable.h>
+#include <zypp/Repository.h>
+
+/// \brief Trigram index of a repos solvable names, summaries and descriptions.
+///
+/// The index is stored as file \c search-index next to the repos \c solv file
+/// and remembers the size and mtime of the \c solv file it was built from. If
+/// they don't match, the index is stale and must not be used.
+///
+/// The index maps each (ASCII lowercased) trigram to the solvables containing
+/// it, separately for the name and for the summary/description. Names are
+/// indexed without the kind prefix of the ident (like \c Match::SKIP_KIND),
+/// so \c pattern:base is found as \c base, not as \c pattern. It is just a
+/// prefilter: Any solvable containing a literal string (case insensitive) is
+/// among the \ref candidates for this string. The candidates must still be
+/// checked against the actual query.
+///
+/// \code
+///   SearchIndex::build( repo, SearchIndex::dir( solvCachePath, repo ) );
+///   ...
+///   SearchIndex idx( repo, SearchIndex::dir( solvCachePath, repo ) );
+///   if ( idx )
+///     std::optional<std::vector<sat::Solvable>> cand { idx.candidates( "zyp", true ) };
+/// \endcode
+class SearchIndex : private zypp::base::NonCopyable
+{
+public:
+  /** The directory holding \a repo_r's \c solv file (and index) below \a solvCachePath_r. */
+  static zypp::Pathname dir( const zypp::Pathname & solvCachePath_r, const zypp::Repository & repo_r );
+
+  /** Whether the index in \a dir_r exists and matches the \c solv file in \a dir_r. */
+  static bool upToDate( const zypp::Pathname & dir_r );
+
+  /** Build the index for the loaded \a repo_r and store it in \a dir_r.
+   * \a repo_r must have been loaded from the \c solv file in \a dir_r.
+   * \throws Exception if the index can not be written.
+   */
+  static void build( const zypp::Repository & repo_r, const zypp::Pathname & dir_r );
+
+  /** \ref build the index unless it is \ref upToDate. Failing is not an error,
+   * the repo is then searched without index.
+   * \returns Whether the index is up to date now.
+   */
+  static bool update( const zypp::Repository & repo_r, const zypp::Pathname & dir_r );
+
+public:
+  /** Open the index for the loaded \a repo_r stored in \a dir_r.
+   * Check \c operator bool, whether it is usable.
+   */
+  SearchIndex( const zypp::Repository & repo_r, const zypp::Pathname & dir_r );
+
+  ~SearchIndex();
+
+  /** Whether the index exists and is not stale. */
+  explicit operator bool() const
+  { return _data; }
+
+  /** The solvables (in id order) which may contain \a literal_r in their name
+   * or, if \a text_r is set, also in their summary or description.
+   * \returns nothing if \a literal_r is shorter than 3 bytes and can not be
+   * looked up.
+   */
+  std::optional<std::vector<zypp::sat::Solvable>> candidates( const std::string & literal_r, bool text_r ) const;
+
+private:
+  struct Header;
+  struct Entry;
+
+  std::vector<unsigned> lookup( const std::string & literal_r, unsigned section_r ) const;
+
+private:
+  zypp::Repository _repo;
+  zypp::sat::Solvable::IdType _firstId = 0;
+  const char * _data = nullptr;
+  size_t _size = 0;
+};
+
+#endif // ZYPPER_UTILS_SEARCHINDEX_H
@@ -0,0 +1,295 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <iostream>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <zypp-core/base/Logger.h>
+#include <zypp-core/base/Exception.h>
+
+#include "WorkerPool.h"
+
+using std::endl;
+
+WorkerPool::WorkerPool( unsigned maxJobs_r )
+: WorkerPool( std::vector<unsigned>{ maxJobs_r } )
+{}
+
+WorkerPool::WorkerPool( std::vector<unsigned> laneMaxJobs_r )
+: WorkerPool( std::move(laneMaxJobs_r), 0 )
+{}
+
+WorkerPool::WorkerPool( std::vector<unsigned> laneMaxJobs_r, unsigned maxTotal_r )
+: _maxJobs( std::move(laneMaxJobs_r) )
+, _maxTotal( maxTotal_r )
+{
+  if ( _maxJobs.empty() )
+    _maxJobs.push_back( 1 );
+  for ( unsigned & max : _maxJobs )
+  {
+    if ( ! max )
+      max = 1;
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  // No more callbacks; just don't leave zombies behind.
+  for ( Child & child : _running )
+  {
+    ::close( child._fd );
+    int status = 0;
+    while ( ::waitpid( child._pid, &status, 0 ) < 0 && errno == EINTR )
+    {;} // just loop
+  }
+}
+
+unsigned WorkerPool::running( unsigned lane_r ) const
+{
+  unsigned ret = 0;
+  for ( const Child & child : _running )
+  {
+    if ( child._lane == lane_r )
+      ++ret;
+  }
+  return ret;
+}
+
+void WorkerPool::enqueue( Job job_r, Done done_r, unsigned lane_r )
+{
+  if ( _canceled )
+  {
+    DBG << "Canceled: drop job for lane " << lane_r << endl;
+    return;
+  }
+  if ( lane_r >= _maxJobs.size() )
+  {
+    WAR << "No lane " << lane_r << "; using lane 0" << endl;
+    lane_r = 0;
+  }
+  _queued.push_back( Task{ std::move(job_r), std::move(done_r), lane_r } );
+  startQueued();
+}
+
+void WorkerPool::startQueued()
+{
+  // FIFO per lane
+  std::vector<unsigned> slots( _maxJobs );
+  for ( const Child & child : _running )
+    --slots[child._lane];
+
+  unsigned total = _maxTotal ? ( _running.size() < _maxTotal ? _maxTotal - _running.size() : 0 ) : _queued.size();
+
+  std::list<Task> tostart;
+  for ( auto it = _queued.begin(); it != _queued.end() && total; )
+  {
+    auto task = it++;
+    if ( slots[task->_lane] )
+    {
+      --slots[task->_lane];
+      --total;
+      tostart.splice( tostart.end(), _queued, task );
+    }
+  }
+
+  // A failing start may call back and enqueue; so don't iterate _queued here.
+  for ( Task & task : tostart )
+    start( std::move(task) );
+}
+
+void WorkerPool::start( Task && task_r )
+{
+  int fds[2];
+  if ( ::pipe2( fds, O_CLOEXEC ) != 0 )
+  {
+    std::string err { ::strerror( errno ) };
+    ERR << "pipe failed: " << err << endl;
+    if ( task_r._done )
+      task_r._done( -1, "pipe: " + err );
+    return;
+  }
+
+  std::cout.flush();
+  std::cerr.flush();
+  ::fflush( nullptr );
+  pid_t pid = ::fork();
+  if ( pid == 0 )
+  {
+    //////////////////////////////////////////////////////////////////////
+    // Zyppers signal handler would clean up the parents tmpdir on exit.
+    ::signal( SIGINT,  SIG_DFL );
+    ::signal( SIGTERM, SIG_DFL );
+    ::signal( SIGPIPE, SIG_DFL );
+
+    int nullfd = ::open( "/dev/null", O_RDONLY );
+    if ( nullfd >= 0 )
+    {
+      ::dup2( nullfd, STDIN_FILENO );
+      ::close( nullfd );
+    }
+    ::dup2( fds[1], STDOUT_FILENO );
+    ::dup2( fds[1], STDERR_FILENO );
+    ::close( fds[1] );
+    ::close( fds[0] );
+
+    int ret = 1;
+    try
+    {
+      ret = task_r._job();
+    }
+    catch ( const zypp::Exception & excpt_r )
+    {
+      ZYPP_CAUGHT( excpt_r );
+      std::cerr << excpt_r.asUserHistory() << endl;
+    }
+    catch ( const std::exception & excpt_r )
+    {
+      ERR << "Worker " << ::getpid() << ": " << excpt_r.what() << endl;
+      std::cerr << excpt_r.what() << endl;
+    }
+    catch (...)
+    {
+      ERR << "Worker " << ::getpid() << ": unknown exception" << endl;
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    ::fflush( nullptr );
+    ::_exit( ret );
+    // No sense in returning! I am forked away!!
+    //////////////////////////////////////////////////////////////////////
+  }
+
+  ::close( fds[1] );
+  if ( pid < 0 )
+  {
+    std::string err { ::strerror( errno ) };
+    ERR << "fork failed: " << err << endl;
+    ::close( fds[0] );
+    if ( task_r._done )
+      task_r._done( -1, "fork: " + err );
+    return;
+  }
+
+  DBG << "Worker " << pid << " started in lane " << task_r._lane << " (" << running( task_r._lane )+1 << "/" << _maxJobs[task_r._lane] << ")" << endl;
+  _running.push_back( Child{ pid, fds[0], std::string(), std::move(task_r._done), task_r._lane } );
+}
+
+void WorkerPool::finish( std::list<Child>::iterator child_r )
+{
+  ::close( child_r->_fd );
+
+  int status = 0;
+  int code = -1;
+  while ( (code = ::waitpid( child_r->_pid, &status, 0 )) < 0 && errno == EINTR )
+  {;} // just loop
+
+  int exitcode = -1;
+  if ( code < 0 )
+    ERR << "waitpid for worker " << child_r->_pid << " failed: " << ::strerror( errno ) << endl;
+  else if ( WIFEXITED( status ) )
+    exitcode = WEXITSTATUS( status );
+  else if ( WIFSIGNALED( status ) )
+    WAR << "Worker " << child_r->_pid << " killed by signal " << WTERMSIG( status ) << endl;
+
+  DBG << "Worker " << child_r->_pid << " exited (" << exitcode << ")" << endl;
+
+  // Remove it before calling back, so the callback may enqueue new jobs.
+  Done done { std::move(child_r->_done) };
+  std::string output { std::move(child_r->_output) };
+  _running.erase( child_r );
+
+  if ( done )
+    done( exitcode, output );
+}
+
+int WorkerPool::pollChildren( int timeout_r )
+{
+  std::vector<struct pollfd> pfds;
+  for ( const Child & child : _running )
+    pfds.push_back( { child._fd, POLLIN, 0 } );
+
+  int ready = ::poll( pfds.data(), pfds.size(), timeout_r );
+  if ( ready < 0 )
+  {
+    if ( errno == EINTR )
+      return -1;
+    ERR << "poll failed: " << ::strerror( errno ) << endl;
+    finish( _running.begin() );	// blocking wait for the 1st one
+    return 1;
+  }
+  if ( ready == 0 )
+    return -1;
+
+  int finished = 0;
+  auto it = _running.begin();
+  for ( const struct pollfd & pfd : pfds )
+  {
+    auto child = it++;
+    if ( ! pfd.revents )
+      continue;
+
+    char buf[4096];
+    ssize_t n = ::read( child->_fd, buf, sizeof(buf) );
+    if ( n > 0 )
+      child->_output.append( buf, n );
+    else if ( n == 0 || ( errno != EINTR && errno != EAGAIN ) )
+    {
+      finish( child );	// EOF: all write ends are closed
+      ++finished;
+    }
+  }
+  return finished;
+}
+
+bool WorkerPool::waitOne()
+{
+  startQueued();
+  if ( _running.empty() )
+    return false;
+
+  while ( pollChildren( -1 ) <= 0 )
+  {;} // just loop
+
+  startQueued();
+  return true;
+}
+
+unsigned WorkerPool::reap()
+{
+  unsigned ret = 0;
+  int finished = 0;
+  while ( ! _running.empty() && ( finished = pollChildren( 0 ) ) >= 0 )
+    ret += finished;
+
+  startQueued();
+  return ret;
+}
+
+void WorkerPool::waitAll()
+{
+  while ( waitOne() )
+  {;}
+}
+
+void WorkerPool::cancel()
+{
+  _canceled = true;
+  if ( ! _queued.empty() )
+  {
+    MIL << "Dropping " << _queued.size() << " queued jobs." << endl;
+    _queued.clear();
+  }
+  waitAll();
+}
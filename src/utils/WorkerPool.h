@@ -0,0 +1,150 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#ifndef ZYPPER_UTILS_WORKERPOOL_H
+#define ZYPPER_UTILS_WORKERPOOL_H
+
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <zypp-core/base/NonCopyable.h>
+
+/// \brief Run jobs in forked worker processes, at most \ref maxJobs at a time.
+///
+/// libzypp is not thread safe, but a forked child owns a private copy of the
+/// whole zypp state (RepoManager, media handler, callbacks,..). This allows
+/// running independent jobs, which communicate their result via the filesystem
+/// (e.g. downloading raw metadata into the repos cache directory), in parallel.
+///
+/// A \ref Job is executed in the child process and its return value becomes the
+/// child's exit code. The child's stdin is redirected to /dev/null, stdout and
+/// stderr are captured and passed to the \ref Done callback which is executed in
+/// the parent as soon as the child terminated.
+///
+/// \note The child is left via \c _exit, so no destructors are executed in the
+/// child (no zypp lock release, no tmpdir cleanup,...). A child must not prompt
+/// the user and should not leave any state behind that the parent would need
+/// to clean up.
+///
+/// \code
+///   WorkerPool pool( 4 );
+///   for ( const auto & repo : repos )
+///     pool.enqueue( [&]() { return doSomething( repo ); },
+///                   [&]( int exitcode_r, const std::string & output_r ) { ... } );
+///   pool.waitAll();
+/// \endcode
+///
+/// Jobs may be assigned to different lanes, each having its own limit. This allows
+/// building pipelines where e.g. the jobs of lane \c 0 download data and their
+/// \ref Done callbacks enqueue jobs in lane \c 1 processing it.
+/// An overall limit may additionally cap the number of children running in all
+/// lanes together (e.g. one lane per server, each limiting the connections to it).
+class WorkerPool : private zypp::base::NonCopyable
+{
+public:
+  /** Job executed in the child process, returning the child's exit code. */
+  using Job = std::function<int()>;
+
+  /** Executed in the parent when the job's child process terminated.
+   * \a exitcode_r is the child's exit code or \c -1 if fork failed or the child
+   * was killed by a signal. \a output_r is the captured stdout/stderr.
+   */
+  using Done = std::function<void( int exitcode_r, const std::string & output_r )>;
+
+public:
+  /** Ctor; a single lane; \a maxJobs_r \c 0 is treated as \c 1. */
+  explicit WorkerPool( unsigned maxJobs_r );
+
+  /** Ctor; one lane per entry in \a laneMaxJobs_r. */
+  explicit WorkerPool( std::vector<unsigned> laneMaxJobs_r );
+
+  /** Ctor; one lane per entry in \a laneMaxJobs_r, at most \a maxTotal_r children in all lanes (\c 0: no limit). */
+  WorkerPool( std::vector<unsigned> laneMaxJobs_r, unsigned maxTotal_r );
+
+  /** Dtor; waits for running children but does not start queued jobs. */
+  ~WorkerPool();
+
+public:
+  /** Max. number of concurrently running children in lane \a lane_r. */
+  unsigned maxJobs( unsigned lane_r = 0 ) const
+  { return lane_r < _maxJobs.size() ? _maxJobs[lane_r] : 0; }
+
+  /** Max. number of concurrently running children in all lanes (\c 0: no limit). */
+  unsigned maxTotal() const
+  { return _maxTotal; }
+
+  /** Number of currently running children (in all lanes). */
+  unsigned running() const
+  { return _running.size(); }
+
+  /** Number of currently running children in lane \a lane_r. */
+  unsigned running( unsigned lane_r ) const;
+
+  /** Whether jobs are running or waiting to be started. */
+  bool pending() const
+  { return !( _running.empty() && _queued.empty() ); }
+
+  /** Queue a job; it's started as soon as a slot in \a lane_r is free (maybe immediately). */
+  void enqueue( Job job_r, Done done_r, unsigned lane_r = 0 );
+
+  /** Wait until at least one running job finished and call its \ref Done.
+   * Queued jobs are started to refill free slots.
+   * \return \c false if nothing was pending.
+   */
+  bool waitOne();
+
+  /** Call the \ref Done of all jobs which already finished, without blocking.
+   * Queued jobs are started to refill free slots.
+   * \return The number of finished jobs.
+   */
+  unsigned reap();
+
+  /** Wait until all jobs are done. */
+  void waitAll();
+
+  /** Forget about queued jobs (e.g. on user abort) and wait for the running ones.
+   * Jobs enqueued afterwards (e.g. by a \ref Done callback) are dropped.
+   */
+  void cancel();
+
+private:
+  struct Task
+  {
+    Job      _job;
+    Done     _done;
+    unsigned _lane;
+  };
+
+  struct Child
+  {
+    pid_t       _pid;
+    int         _fd;		///< read end of the pipe collecting stdout/stderr
+    std::string _output;
+    Done        _done;
+    unsigned    _lane;
+  };
+
+  void startQueued();
+  void start( Task && task_r );
+  void finish( std::list<Child>::iterator child_r );
+  /** Poll the running children for \a timeout_r ms, collect their output and finish the ones terminated.
+   * \return The number of finished children or \c -1 if none was ready (or interrupted).
+   */
+  int pollChildren( int timeout_r );
+
+private:
+  std::vector<unsigned> _maxJobs;	///< per lane
+  unsigned _maxTotal = 0;		///< all lanes
+  std::list<Task> _queued;
+  std::list<Child> _running;
+  bool _canceled = false;
+};
+
+#endif // ZYPPER_UTILS_WORKERPOOL_H
@@ -7,11 +7,14 @@
 
 #include <sstream>
 #include <iostream>
+#include <fstream>
 #include <unistd.h>          // for getcwd()
 
 #include <zypp-core/base/Logger.h>
 #include <zypp-core/base/String.h>
 #include <zypp-core/base/Regex.h>
+#include <zypp-core/fs/PathInfo.h>
+#include <zypp/base/Measure.h>
 #include <zypp/media/MediaManager.h>
 #include <zypp-core/ExternalProgram.h>
 #include <zypp/parser/ProductFileReader.h>
@@ -231,20 +234,179 @@ std::string patchInteractiveFlags( const Patch & patch_r )
 
 ///////////////////////////////////////////////////////////////////
 /// class  PatchHistoryData
+///
+/// Parsing a long living systems history file takes a while. So the
+/// reduced data are kept in an index file together with the position
+/// in the history file they were read up to. Next time just the lines
+/// appended since then are parsed. If the history file was replaced
+/// (logrotate) or truncated, it's parsed from the beginning.
+///
+/// The index is written if the history was changed and the index file
+/// is writable (root).
 struct PatchHistoryData::D
 {
+  using IdType = IdString::IdType;
+
+  bool empty() const
+  { return _data.empty(); }
+
   void remember( HistoryLogPatchStateChange::Ptr ptr_r )
   {
     if ( ! ptr_r )
       return;
+    remember( IdString("patch:"+ptr_r->name()).id(), ptr_r->edition().id(), ptr_r->arch().id(),
+              ptr_r->date(), ResStatus::stringToValidateValue( ptr_r->newstate() ) );
+  }
+
+  void remember( IdType ident_r, IdType edition_r, IdType arch_r, Date date_r, ResStatus::ValidateValue state_r )
+  {
+    value_type & value { _data[ident_r][edition_r][arch_r] };
+    if ( date_r > value.first ) {
+      value.first = std::move(date_r);
+      value.second = state_r;
+    }
+  }
+
+  /** Read \a historyFile_r, using and updating the index in \a indexFile_r. */
+  void read( const Pathname & historyFile_r, const Pathname & indexFile_r )
+  {
+    debug::Measure m( "PatchHistoryData" );
+    PathInfo history { historyFile_r };
+    if ( ! history.isFile() )
+      return;
+
+    off_t offset = 0;
+    if ( ! loadIndex( indexFile_r, history, offset ) )
+    {
+      _data.clear();
+      offset = 0;
+    }
 
-    value_type & value { _data[IdString("patch:"+ptr_r->name()).id()][ptr_r->edition().id()][ptr_r->arch().id()] };
-    if ( Date date { ptr_r->date() }; date > value.first ) {
-      value.first = std::move(date);
-      value.second = ResStatus::stringToValidateValue( ptr_r->newstate() );
+    if ( offset < history.size() )
+    {
+      off_t end = readHistory( historyFile_r, offset );
+      MIL << "PatchHistoryData: parsed " << historyFile_r << " from " << offset << " to " << end << endl;
+      if ( end != offset )
+        saveIndex( indexFile_r, history, end );
     }
   }
 
+private:
+  /** Identifies the history file and the position the index was read up to. */
+  static std::string indexHeader( const PathInfo & history_r, off_t offset_r )
+  {
+    return str::Str() << "#zypper-patch-history-index 1 " << history_r.dev() << " " << history_r.ino()
+                      << " " << offset_r << " " << fingerprint( history_r.path(), offset_r );
+  }
+
+  /** Hash of the bytes in front of \a offset_r; changes if the file got rewritten. */
+  static size_t fingerprint( const Pathname & file_r, off_t offset_r )
+  {
+    std::string buf( std::min<off_t>( offset_r, 256 ), '\0' );
+    std::ifstream in( file_r.c_str(), std::ios::binary );
+    in.seekg( offset_r - buf.size() );
+    in.read( &buf[0], buf.size() );
+    return std::hash<std::string>()( buf );
+  }
+
+  /** Parse the PATCH_STATE_CHANGE lines following \a offset_r; return the position behind the last complete line. */
+  off_t readHistory( const Pathname & file_r, off_t offset_r )
+  {
+    std::ifstream in( file_r.c_str(), std::ios::binary );
+    if ( ! in.seekg( offset_r ) )
+      return offset_r;
+
+    const std::string & action { HistoryActionID::PATCH_STATE_CHANGE.asString() };
+    off_t pos = offset_r;
+    std::string line;
+    HistoryLogData::FieldVector fields;
+    while ( std::getline( in, line ) )
+    {
+      if ( in.eof() )
+        break;	// incomplete last line; parsed next time
+      pos += line.size() + 1;
+
+      // date|action|...: skip comments and other actions before splitting the line
+      // (the action may be padded with blanks).
+      std::string::size_type sep = line.find( '|' );
+      if ( line[0] == '#' || sep == std::string::npos || line.compare( sep+1, action.size(), action ) != 0 )
+        continue;
+      sep = line.find_first_not_of( ' ', sep+1+action.size() );
+      if ( sep == std::string::npos || line[sep] != '|' )
+        continue;
+
+      fields.clear();
+      str::splitEscaped( line, std::back_inserter( fields ), "|", true );
+      try
+      {
+        remember( dynamic_pointer_cast<HistoryLogPatchStateChange>( HistoryLogData::create( fields ) ) );
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );	// like HistoryLogReader::IGNORE_INVALID_ITEMS
+      }
+    }
+    return pos;
+  }
+
+  bool loadIndex( const Pathname & indexFile_r, const PathInfo & history_r, off_t & offset_r )
+  {
+    std::ifstream in( indexFile_r.c_str() );
+    std::string line;
+    if ( ! std::getline( in, line ) )
+      return false;
+
+    // The offset is part of the header; take it, then compare the whole header.
+    std::vector<std::string> words;
+    str::split( line, std::back_inserter( words ) );
+    if ( words.size() == 6 )
+      offset_r = str::strtonum<off_t>( words[4] );
+    if ( words.size() != 6 || offset_r > history_r.size() || line != indexHeader( history_r, offset_r ) )
+    {
+      MIL << "PatchHistoryData: index " << indexFile_r << " is not usable for " << history_r.path() << endl;
+      return false;
+    }
+
+    // ident|edition|arch|date|state
+    std::vector<std::string> fields;
+    while ( std::getline( in, line ) )
+    {
+      fields.clear();
+      str::split( line, std::back_inserter( fields ), "|" );
+      if ( fields.size() != 5 )
+        return false;
+      remember( IdString( fields[0] ).id(), IdString( fields[1] ).id(), IdString( fields[2] ).id(),
+                Date( str::strtonum<Date::ValueType>( fields[3] ) ),
+                ResStatus::ValidateValue( str::strtonum<int>( fields[4] ) ) );
+    }
+    return true;
+  }
+
+  void saveIndex( const Pathname & indexFile_r, const PathInfo & history_r, off_t offset_r ) const
+  {
+    Pathname tmpfile { indexFile_r.extend( ".new" ) };
+    {
+      std::ofstream out( tmpfile.c_str() );
+      if ( ! out )
+      {
+        DBG << "PatchHistoryData: can not write " << tmpfile << endl;
+        return;
+      }
+      out << indexHeader( history_r, offset_r ) << endl;
+      for ( const auto & [ident, editions] : _data )
+        for ( const auto & [edition, arches] : editions )
+          for ( const auto & [arch, value] : arches )
+            out << IdString(ident) << '|' << IdString(edition) << '|' << IdString(arch)
+                << '|' << Date::ValueType(value.first) << '|' << int(value.second) << '\n';
+      if ( ! out.flush() )
+      {
+        filesystem::unlink( tmpfile );
+        return;
+      }
+    }
+    filesystem::rename( tmpfile, indexFile_r );
+  }
+
   const PatchHistoryData::value_type & get( const sat::Solvable & solv_r  ) const
   {
     if ( auto n { _data.find( solv_r.ident().id() ) }; n != _data.end() ) {
@@ -258,7 +420,6 @@ struct PatchHistoryData::D
   }
 
 private:
-  using IdType = IdString::IdType;
   template <class Tv>
   using MapType = std::unordered_map<IdType,Tv>;
 
@@ -274,19 +435,23 @@ PatchHistoryData::PatchHistoryData( bool doparse_r )
 {
   if ( doparse_r )
   {
-    const Pathname & historyFile { Pathname::assertprefix( Zypper::instance().config().root_dir, ZConfig::instance().historyLogFile() ) };
-    parser::HistoryLogReader parser( historyFile, parser::HistoryLogReader::IGNORE_INVALID_ITEMS,
-                                     [=]( HistoryLogData::Ptr ptr_r )->bool {
-                                       if ( ! this->_d )
-                                         this->_d.reset( new D );
-                                       this->_d->remember( dynamic_pointer_cast<HistoryLogPatchStateChange>(ptr_r) );
-                                       return true;
-                                     } );
-    parser.addActionFilter( HistoryActionID::PATCH_STATE_CHANGE );
-    parser.readAll();
+    const Config & config { Zypper::instance().config() };
+    const Pathname & historyFile { Pathname::assertprefix( config.root_dir, ZConfig::instance().historyLogFile() ) };
+    _d.reset( new D );
+    _d->read( historyFile, config.rm_options.repoCachePath / "patch-history.index" );
+    if ( _d->empty() )
+      _d.reset();
   }
 }
 
+PatchHistoryData::PatchHistoryData( const Pathname & historyFile_r, const Pathname & indexFile_r )
+: _d( new D )
+{
+  _d->read( historyFile_r, indexFile_r );
+  if ( _d->empty() )
+    _d.reset();
+}
+
 PatchHistoryData::operator bool() const
 { return bool(_d); }
 
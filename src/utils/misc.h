@@ -140,6 +140,9 @@ public:
   /** Ctor parsing the history file. */
   PatchHistoryData() : PatchHistoryData( true ) {}
 
+  /** Ctor parsing \a historyFile_r, using and updating the index in \a indexFile_r. */
+  PatchHistoryData( const Pathname & historyFile_r, const Pathname & indexFile_r );
+
   /** Return an empty instance without data. */
   static PatchHistoryData placeholder();
 
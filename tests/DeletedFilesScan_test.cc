@@ -0,0 +1,150 @@
+#include <tests/lib/TestSetup.h>
+#include <zypp-core/fs/PathInfo.h>
+#include <zypp-core/fs/TmpPath.h>
+
+#include <climits>
+#include <stdlib.h>
+
+#include "utils/DeletedFilesScan.h"
+
+/** \file tests/DeletedFilesScan_test.cc
+ *
+ * The parts of DeletedFilesScan::check which do not depend on the running
+ * processes: parsing /proc/<pid>/maps lines, the filter, and passing the
+ * workers' result to the parent.
+ */
+
+using namespace zypp;
+using ProcInfo = DeletedFilesScan::ProcInfo;
+
+namespace
+{
+  std::string deletedMapping( const std::string & line_r )
+  { return std::string( DeletedFilesScan::deletedMapping( line_r ) ); }
+
+  void checkSame( const ProcInfo & lhs, const ProcInfo & rhs )
+  {
+    BOOST_CHECK_EQUAL( lhs.pid, rhs.pid );
+    BOOST_CHECK_EQUAL( lhs.ppid, rhs.ppid );
+    BOOST_CHECK_EQUAL( lhs.puid, rhs.puid );
+    BOOST_CHECK_EQUAL( lhs.command, rhs.command );
+    BOOST_CHECK( lhs.files == rhs.files );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( strip_deleted_tag )
+{
+  std::string_view path { "/usr/lib64/libc.so.6 (deleted)" };
+  BOOST_CHECK( DeletedFilesScan::stripDeletedTag( path ) );
+  BOOST_CHECK_EQUAL( path, "/usr/lib64/libc.so.6" );
+
+  for ( std::string_view untagged : { "/usr/lib64/libc.so.6", " (deleted)", "", "/usr/bin/foo (deleted) ", "/usr/bin/foo(deleted)" } )
+  {
+    std::string_view orig { untagged };
+    BOOST_CHECK( ! DeletedFilesScan::stripDeletedTag( untagged ) );
+    BOOST_CHECK_EQUAL( untagged, orig );	// unchanged
+  }
+
+  // only the trailing tag is stripped
+  path = "/tmp/x (deleted) (deleted)";
+  BOOST_CHECK( DeletedFilesScan::stripDeletedTag( path ) );
+  BOOST_CHECK_EQUAL( path, "/tmp/x (deleted)" );
+}
+
+BOOST_AUTO_TEST_CASE( maps_lines )
+{
+  BOOST_CHECK_EQUAL( deletedMapping( "7f2c1a400000-7f2c1a428000 r--p 00000000 fd:01 1311267                    /usr/lib64/libc.so.6 (deleted)" ),
+                     "/usr/lib64/libc.so.6" );
+  // blanks within the path
+  BOOST_CHECK_EQUAL( deletedMapping( "55d0c0e00000-55d0c0e02000 r-xp 00002000 fd:01 42 /opt/my app/bin/my app (deleted)" ),
+                     "/opt/my app/bin/my app" );
+  // not deleted
+  BOOST_CHECK_EQUAL( deletedMapping( "7f2c1a400000-7f2c1a428000 r--p 00000000 fd:01 1311267 /usr/lib64/libc.so.6" ), "" );
+  // anonymous and special mappings
+  BOOST_CHECK_EQUAL( deletedMapping( "7ffc2b5e4000-7ffc2b605000 rw-p 00000000 00:00 0                          [stack]" ), "" );
+  BOOST_CHECK_EQUAL( deletedMapping( "7f2c1a600000-7f2c1a800000 rw-p 00000000 00:00 0" ), "" );
+  BOOST_CHECK_EQUAL( deletedMapping( "7f2c1a600000-7f2c1a800000 rw-s 00000000 00:01 1234 SYSV00000000 (deleted)" ), "" );
+  BOOST_CHECK_EQUAL( deletedMapping( "" ), "" );
+}
+
+BOOST_AUTO_TEST_CASE( lib_or_bin )
+{
+  for ( std::string_view path : {
+    "/usr/bin/zypper", "/bin/bash", "/usr/sbin/sshd", "/sbin/init",
+    "/lib/libfoo.so", "/usr/lib/systemd/systemd", "/usr/lib64/libc.so.6", "/lib32/x", "/usr/libx32/x",
+    "/usr/libexec/foo", "/opt/app/lib/plugin.so", "/opt/app/bin/app",
+    "/tmp/libbar.so.1", "/home/user/libx.so",
+  } )
+    BOOST_CHECK_MESSAGE( DeletedFilesScan::isLibOrBin( path ), path );
+
+  for ( std::string_view path : {
+    "/srv/library/data", "/home/robin/file", "/usr/share/glib-2.0/schemas/x", "/var/cabin/x",
+    "/usr/lib64x/foo", "/usr/share/bin.txt", "/tmp/libnotes.txt", "/bin", "/usr/lib",
+    "/memfd:libfoo", "",
+  } )
+    BOOST_CHECK_MESSAGE( ! DeletedFilesScan::isLibOrBin( path ), path );
+}
+
+BOOST_AUTO_TEST_CASE( serialize_roundtrip )
+{
+  std::vector<ProcInfo> infos( 3 );
+  infos[0].pid = "1";
+  infos[0].ppid = "0";
+  infos[0].puid = "0";
+  infos[0].command = "systemd";
+  infos[0].files = { "/usr/lib64/libc.so.6", "/usr/lib/systemd/systemd" };
+
+  infos[1].pid = "4711";
+  infos[1].ppid = "1";
+  infos[1].puid = "1000";
+  infos[1].command = std::string( "a\0b\\0c\\", 8 );	// NUL and escape characters
+  infos[1].files = { "/usr/bin/new\nline", std::string( "/usr/bin/n\0l", 12 ), "/usr/lib/back\\slash", "" };
+
+  infos[2].pid = "4712";	// empty fields and no files
+
+  std::string out;
+  for ( const ProcInfo & info : infos )
+    DeletedFilesScan::serialize( info, out );
+
+  std::vector<ProcInfo> result;
+  DeletedFilesScan::deserialize( out, result );
+  BOOST_REQUIRE_EQUAL( result.size(), infos.size() );
+  for ( unsigned idx = 0; idx < infos.size(); ++idx )
+    checkSame( result[idx], infos[idx] );
+
+  // a truncated stream keeps the complete fields
+  result.clear();
+  DeletedFilesScan::deserialize( std::string_view( out ).substr( 0, out.size() - 1 ), result );
+  BOOST_REQUIRE_EQUAL( result.size(), infos.size() );
+  BOOST_CHECK_EQUAL( result[2].pid, "4712" );
+  BOOST_CHECK( result[2].command.empty() );
+
+  // appends to the result
+  DeletedFilesScan::deserialize( out, result );
+  BOOST_CHECK_EQUAL( result.size(), 2 * infos.size() );
+}
+
+BOOST_AUTO_TEST_CASE( resolve_dirs )
+{
+  filesystem::TmpDir tmp;
+  char buf[PATH_MAX];
+  BOOST_REQUIRE( ::realpath( tmp.path().c_str(), buf ) );
+  Pathname root { buf };	// the tmpdir may be below a symlink itself
+  BOOST_REQUIRE_EQUAL( filesystem::assert_dir( root / "usr/lib64" ), 0 );
+  BOOST_REQUIRE_EQUAL( filesystem::symlink( "usr/lib64", root / "lib64" ), 0 );
+
+  DeletedFilesScan::FileFilter filter {
+    (root / "lib64/libc.so.6").asString(),
+    (root / "lib64/libm.so.6").asString(),
+    (root / "usr/lib64/libz.so.1").asString(),
+    (root / "nonexistent/libx.so").asString(),
+    "libnodir.so",
+    "/libroot.so",
+  };
+  DeletedFilesScan::FileFilter expected { filter };
+  expected.insert( (root / "usr/lib64/libc.so.6").asString() );
+  expected.insert( (root / "usr/lib64/libm.so.6").asString() );
+
+  BOOST_CHECK( DeletedFilesScan::resolveDirs( filter ) == expected );
+  BOOST_CHECK( DeletedFilesScan::resolveDirs( {} ).empty() );
+}
@@ -0,0 +1,181 @@
+#include <tests/lib/TestSetup.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/Patch.h>
+
+#include <set>
+
+#include "utils/IssueIndex.h"
+#include "utils/NeedleMatcher.h"
+
+using namespace zypp;
+
+static TestSetup test( TestSetup::initLater );
+struct TestInit {
+  TestInit() {
+    test = TestSetup( Arch_x86_64 );
+    zypp::base::LogControl::instance().logfile( "./zypper_test.log" );
+    test.loadRepo(TESTS_SRC_DIR "/data/openSUSE-11.1_updates", "updates");
+  }
+  ~TestInit() { test.reset(); }
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+namespace
+{
+  /** Needle indices found in \a haystack_r (one per occurrence, sorted). */
+  std::multiset<unsigned> scan( const NeedleMatcher & matcher_r, const std::string & haystack_r )
+  {
+    std::multiset<unsigned> ret;
+    matcher_r.scan( haystack_r, [&ret]( unsigned idx_r ) { ret.insert( idx_r ); } );
+    return ret;
+  }
+
+  /** The pools patch references (type, id) as strings "type:id". */
+  std::multiset<std::string> asStrings( const IssueIndex::RefList & refs_r )
+  {
+    std::multiset<std::string> ret;
+    for ( const IssueIndex::Ref * ref : refs_r )
+      ret.insert( ref->type + ":" + ref->id + "@" + ref->patch.asString() );
+    return ret;
+  }
+
+  /** References whose id (or type) contains \a needle_r, by brute force over the pool. */
+  std::multiset<std::string> bruteForce( const std::string & needle_r, bool types_r )
+  {
+    std::multiset<std::string> ret;
+    for ( const PoolItem & pi : test.pool().byKind<Patch>() )
+    {
+      Patch::constPtr patch { pi->asKind<Patch>() };
+      for_( it, patch->referencesBegin(), patch->referencesEnd() )
+      {
+        if ( str::toLower( types_r ? it.type() : it.id() ).find( str::toLower( needle_r ) ) != std::string::npos )
+          ret.insert( it.type() + ":" + it.id() + "@" + pi.satSolvable().asString() );
+      }
+    }
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(needles_overlapping)
+{
+  NeedleMatcher matcher( { "he", "she", "his", "hers" } );
+  BOOST_CHECK( scan( matcher, "ushers" ) == std::multiset<unsigned>({ 0, 1, 3 }) );
+  BOOST_CHECK( scan( matcher, "hishe" ) == std::multiset<unsigned>({ 0, 1, 2 }) );
+  BOOST_CHECK( scan( matcher, "hehe" ) == std::multiset<unsigned>({ 0, 0 }) );
+  BOOST_CHECK( scan( matcher, "xyz" ).empty() );
+  BOOST_CHECK( scan( matcher, "" ).empty() );
+
+  // a needle inside another one and repeated needles
+  NeedleMatcher nested( { "aa", "a", "aaa", "a" } );
+  BOOST_CHECK( scan( nested, "aaa" ) == std::multiset<unsigned>({ 0, 0, 1, 1, 1, 2, 3, 3, 3 }) );
+}
+
+BOOST_AUTO_TEST_CASE(needles_case)
+{
+  // NeedleMatcher itself is case sensitive; IssueIndex folds both sides.
+  NeedleMatcher matcher( { "cve" } );
+  BOOST_CHECK( scan( matcher, "CVE-2009" ).empty() );
+  BOOST_CHECK( scan( matcher, "cve-2009" ) == std::multiset<unsigned>({ 0 }) );
+}
+
+BOOST_AUTO_TEST_CASE(needles_empty)
+{
+  NeedleMatcher none( std::vector<std::string>() );
+  BOOST_CHECK( scan( none, "anything" ).empty() );
+
+  NeedleMatcher empty( { "", "" } );	// empty needles are ignored
+  BOOST_CHECK( scan( empty, "anything" ).empty() );
+
+  NeedleMatcher mixed( { "", "th" } );
+  BOOST_CHECK( scan( mixed, "anything" ) == std::multiset<unsigned>({ 1 }) );
+}
+
+BOOST_AUTO_TEST_CASE(index_roundtrip)
+{
+  IssueIndex index( test.pool() );
+  BOOST_REQUIRE( index.size() );
+
+  // every reference is found by its id and by its type
+  unsigned refs = 0;
+  for ( const PoolItem & pi : test.pool().byKind<Patch>() )
+  {
+    Patch::constPtr patch { pi->asKind<Patch>() };
+    for_( it, patch->referencesBegin(), patch->referencesEnd() )
+    {
+      ++refs;
+      std::string ref { it.type() + ":" + it.id() + "@" + pi.satSolvable().asString() };
+      BOOST_CHECK_MESSAGE( asStrings( index.byId( it.id() ) ).count( ref ), ref << " not found by id" );
+      BOOST_CHECK_MESSAGE( asStrings( index.byType( it.type() ) ).count( ref ), ref << " not found by type" );
+    }
+  }
+  BOOST_CHECK_EQUAL( refs, index.size() );
+  BOOST_CHECK( index.byId( "no-such-issue" ).empty() );
+
+  // substring lookups, several at once
+  std::vector<std::string> needles { "4585", "CVE-2009", "cve-2009-37", "", "no-such-issue", "45" };
+  std::vector<IssueIndex::RefList> byIds { index.containing( needles, false ) };
+  BOOST_REQUIRE_EQUAL( byIds.size(), needles.size() );
+  for ( unsigned idx = 0; idx < needles.size(); ++idx )
+    BOOST_CHECK_MESSAGE( asStrings( byIds[idx] ) == bruteForce( needles[idx], false ), "needle '" << needles[idx] << "'" );
+  BOOST_CHECK_EQUAL( byIds[3].size(), index.size() );	// the empty needle matches all
+  BOOST_CHECK( byIds[4].empty() );
+
+  std::vector<IssueIndex::RefList> byTypes { index.containing( { "BUG", "cve" }, true ) };
+  BOOST_CHECK( asStrings( byTypes[0] ) == bruteForce( "bugzilla", true ) );
+  BOOST_CHECK( asStrings( byTypes[1] ) == bruteForce( "cve", true ) );
+  BOOST_CHECK( index.containing( {}, true ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE(index_case)
+{
+  IssueIndex index( test.pool() );
+  BOOST_REQUIRE( ! index.byId( "CVE-2009-3050" ).empty() );
+  BOOST_CHECK( asStrings( index.byId( "cve-2009-3050" ) ) == asStrings( index.byId( "CVE-2009-3050" ) ) );
+  BOOST_CHECK( asStrings( index.byType( "BugZilla" ) ) == asStrings( index.byType( "bugzilla" ) ) );
+}
+
+BOOST_AUTO_TEST_CASE(index_type_without_id)
+{
+  // '--bugzilla'/'--cve' without id: PoolQuery used to match the type as
+  // substring (case insensitive), then the requested type was asserted
+  // (case sensitive). update.cc does the same using containing().
+  IssueIndex index( test.pool() );
+  for ( const std::string & type : { "bugzilla", "cve", "bug", "zilla", "CVE", "" } )
+  {
+    std::multiset<std::string> baseline;
+    for ( const PoolItem & pi : test.pool().byKind<Patch>() )
+    {
+      Patch::constPtr patch { pi->asKind<Patch>() };
+      for_( it, patch->referencesBegin(), patch->referencesEnd() )
+      {
+        if ( str::toLower( it.type() ).find( str::toLower( type ) ) != std::string::npos && it.type() == type )
+          baseline.insert( it.type() + ":" + it.id() + "@" + pi.satSolvable().asString() );
+      }
+    }
+
+    IssueIndex::RefList matches { index.containing( { type }, true )[0] };
+    BOOST_CHECK_MESSAGE( asStrings( matches ) == bruteForce( type, true ), "type '" << type << "'" );
+    IssueIndex::RefList asserted;
+    for ( const IssueIndex::Ref * ref : matches )
+      if ( ref->type == type )
+        asserted.push_back( ref );
+    BOOST_CHECK_MESSAGE( asStrings( asserted ) == baseline, "type '" << type << "'" );
+  }
+  BOOST_CHECK( ! index.containing( { "cve" }, true )[0].empty() );
+  BOOST_CHECK( ! index.containing( { "bugzilla" }, true )[0].empty() );
+}
+
+BOOST_AUTO_TEST_CASE(index_staleness)
+{
+  // instance() follows the pool
+  unsigned refs = IssueIndex::instance().size();
+  BOOST_REQUIRE( refs );
+  BOOST_CHECK_EQUAL( &IssueIndex::instance(), &IssueIndex::instance() );
+
+  test.satpool().reposErase( "updates" );
+  BOOST_CHECK_EQUAL( IssueIndex::instance().size(), 0U );
+  BOOST_CHECK( IssueIndex::instance().byType( "bugzilla" ).empty() );
+
+  test.loadRepo( RepoManagerOptions::makeTestSetup( test.root() ).repoSolvCachePath / "updates" / "solv", "updates" );
+  BOOST_CHECK_EQUAL( IssueIndex::instance().size(), refs );
+}
@@ -0,0 +1,140 @@
+#include <tests/lib/TestSetup.h>
+#include <sstream>
+
+#include "output/OutJSON.h"
+
+using namespace zypp;
+using jsonout::quote;
+
+namespace
+{
+  /** What \a fnc_r writes to \c cout. */
+  template <class TFnc>
+  std::string captured( TFnc && fnc_r )
+  {
+    std::ostringstream str;
+    std::streambuf * saved = cout.rdbuf( str.rdbuf() );
+    fnc_r();
+    cout.rdbuf( saved );
+    return str.str();
+  }
+
+  const std::string replacement { "\"\xEF\xBF\xBD\"" };	// quoted U+FFFD
+}
+
+BOOST_AUTO_TEST_CASE( quote_ascii )
+{
+  BOOST_CHECK_EQUAL( quote( "" ), "\"\"" );
+  BOOST_CHECK_EQUAL( quote( "zypper" ), "\"zypper\"" );
+  BOOST_CHECK_EQUAL( quote( "a\"b\\c" ), "\"a\\\"b\\\\c\"" );
+  BOOST_CHECK_EQUAL( quote( "/" ), "\"/\"" );
+}
+
+BOOST_AUTO_TEST_CASE( quote_control_characters )
+{
+  BOOST_CHECK_EQUAL( quote( "\b\f\n\r\t" ), "\"\\b\\f\\n\\r\\t\"" );
+  BOOST_CHECK_EQUAL( quote( std::string( 1, '\0' ) ), "\"\\u0000\"" );
+  BOOST_CHECK_EQUAL( quote( "\x01\x1b\x1f" ), "\"\\u0001\\u001b\\u001f\"" );
+  BOOST_CHECK_EQUAL( quote( "\x7f" ), "\"\x7f\"" );	// DEL needs no escaping
+}
+
+BOOST_AUTO_TEST_CASE( quote_valid_utf8 )
+{
+  for ( const char * valid : {
+    "\xC2\x80",			// U+0080
+    "\xC3\xA4",			// U+00E4
+    "\xDF\xBF",			// U+07FF
+    "\xE0\xA0\x80",		// U+0800
+    "\xE2\x82\xAC",		// U+20AC
+    "\xED\x9F\xBF",		// U+D7FF
+    "\xEE\x80\x80",		// U+E000
+    "\xEF\xBF\xBF",		// U+FFFF
+    "\xF0\x90\x80\x80",		// U+10000
+    "\xF4\x8F\xBF\xBF",		// U+10FFFF
+  } )
+  {
+    BOOST_CHECK_EQUAL( quote( valid ), std::string("\"") + valid + "\"" );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( quote_overlong )
+{
+  BOOST_CHECK_EQUAL( quote( "\xC0\xAF" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\"" );	// '/' in 2 bytes
+  BOOST_CHECK_EQUAL( quote( "\xC1\xBF" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\"" );
+  BOOST_CHECK_EQUAL( quote( "\xE0\x80\xAF" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"" );	// '/' in 3 bytes
+  BOOST_CHECK_EQUAL( quote( "\xE0\x9F\xBF" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"" );	// U+07FF in 3 bytes
+  BOOST_CHECK_EQUAL( quote( "\xF0\x8F\xBF\xBF" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"" );	// U+FFFF in 4 bytes
+}
+
+BOOST_AUTO_TEST_CASE( quote_surrogates_and_out_of_range )
+{
+  // U+D800 and U+DFFF are not encodable in UTF-8
+  BOOST_CHECK_EQUAL( quote( "\xED\xA0\x80" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"" );
+  BOOST_CHECK_EQUAL( quote( "\xED\xBF\xBF" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"" );
+  // above U+10FFFF
+  BOOST_CHECK_EQUAL( quote( "\xF4\x90\x80\x80" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"" );
+  BOOST_CHECK_EQUAL( quote( "\xF5\x80\x80\x80" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"" );
+  BOOST_CHECK_EQUAL( quote( "\xFF" ), replacement );
+}
+
+BOOST_AUTO_TEST_CASE( quote_truncated )
+{
+  // a lead byte without its continuation bytes; the following bytes are kept
+  BOOST_CHECK_EQUAL( quote( "\xC3" ), replacement );
+  BOOST_CHECK_EQUAL( quote( "\xE2\x82" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\"" );
+  BOOST_CHECK_EQUAL( quote( "\xF0\x90\x80" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"" );
+  BOOST_CHECK_EQUAL( quote( "\xC3x" ), "\"\xEF\xBF\xBDx\"" );
+  BOOST_CHECK_EQUAL( quote( "\xE2\x82\"" ), "\"\xEF\xBF\xBD\xEF\xBF\xBD\\\"\"" );
+  // a stray continuation byte
+  BOOST_CHECK_EQUAL( quote( "\x80" ), replacement );
+  BOOST_CHECK_EQUAL( quote( "a\xBF" "b" ), "\"a\xEF\xBF\xBD" "b\"" );
+}
+
+BOOST_AUTO_TEST_CASE( object_and_array )
+{
+  BOOST_CHECK_EQUAL( jsonout::Object().str(), "{}" );
+  BOOST_CHECK( jsonout::Object().empty() );
+  BOOST_CHECK_EQUAL( jsonout::Array().str(), "[]" );
+  BOOST_CHECK( jsonout::Array().empty() );
+
+  jsonout::Object obj;
+  obj.add( "name", "zypper" ).add( "size", 42 ).add( "ok", true ).add( "none", (const char *)nullptr ).add( "neg", -1L );
+  BOOST_CHECK_EQUAL( obj.str(), "{\"name\":\"zypper\",\"size\":42,\"ok\":true,\"none\":null,\"neg\":-1}" );
+  BOOST_CHECK( ! obj.empty() );
+
+  jsonout::Array arr;
+  arr.add( "a\"b" ).add( jsonout::Object().add( "k", "v" ) ).addRaw( "1" );
+  BOOST_CHECK_EQUAL( arr.str(), "[\"a\\\"b\",{\"k\":\"v\"},1]" );
+
+  jsonout::Object outer;
+  outer.add( "inner", jsonout::Object().add( "x", false ) ).addRaw( "list", arr.str() ).add( "key\n", std::string( "\xC3" ) );
+  BOOST_CHECK_EQUAL( outer.str(), "{\"inner\":{\"x\":false},\"list\":" + arr.str() + ",\"key\\n\":" + replacement + "}" );
+}
+
+BOOST_AUTO_TEST_CASE( write_event )
+{
+  // "event" is the first member, one object per line
+  BOOST_CHECK_EQUAL( captured( []() { OutJSON::writeEvent( "ping", jsonout::Object() ); } ),
+                     "{\"event\":\"ping\"}\n" );
+  BOOST_CHECK_EQUAL( captured( []() { OutJSON::writeEvent( "message", jsonout::Object().add( "type", "info" ).add( "text", "a\nb" ) ); } ),
+                     "{\"event\":\"message\",\"type\":\"info\",\"text\":\"a\\nb\"}\n" );
+}
+
+BOOST_AUTO_TEST_CASE( output_type )
+{
+  // OutJSON::TYPE_JSON is not one of ztui's type bits: it must be
+  // neither plain text nor XML for the ztui helpers zypper uses.
+  OutJSON out( Out::NORMAL );
+  BOOST_CHECK( OutJSON::typeJSON( out ) );
+  BOOST_CHECK( ! out.typeNORMAL() );
+  BOOST_CHECK( ! out.typeXML() );
+
+  // Plain text decoration (TYPE_NORMAL only) and gaps are not written.
+  BOOST_CHECK_EQUAL( captured( [&out]() {
+    out.info( "decoration", Out::QUIET, Out::TYPE_NORMAL );
+    out.gap();
+  } ), "" );
+
+  BOOST_CHECK_EQUAL( captured( [&out]() { out.info( "text" ); } ),
+                     "{\"event\":\"message\",\"type\":\"info\",\"text\":\"text\"}\n" );
+}
@@ -0,0 +1,255 @@
+#include <tests/lib/TestSetup.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/Patch.h>
+#include <zypp-core/fs/PathInfo.h>
+#include <zypp-core/fs/TmpPath.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "utils/misc.h"
+
+/** \file tests/PatchHistoryData_test.cc
+ *
+ * PatchHistoryData keeps the patch state changes in an index together with
+ * the position in the history file they were read up to. Only appended lines
+ * are parsed next time; a replaced (rotated), rewritten or truncated history
+ * and an unusable index cause a full parse.
+ */
+
+using namespace zypp;
+
+static TestSetup test( TestSetup::initLater );
+struct TestInit {
+  TestInit() {
+    test = TestSetup( Arch_x86_64 );
+    zypp::base::LogControl::instance().logfile( "./zypper_test.log" );
+    test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_updates", "updates" );
+  }
+  ~TestInit() { test.reset(); }
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+namespace
+{
+  /** Some patches in the pool. */
+  std::vector<sat::Solvable> patches()
+  {
+    std::vector<sat::Solvable> ret;
+    for ( const sat::Solvable & slv : sat::Pool::instance().solvables() )
+    {
+      if ( slv.isKind<Patch>() )
+        ret.push_back( slv );
+      if ( ret.size() == 3 )
+        break;
+    }
+    BOOST_REQUIRE_EQUAL( ret.size(), 3 );
+    return ret;
+  }
+
+  Date date( const std::string & date_r )
+  { return Date( date_r, "%Y-%m-%d %H:%M:%S" ); }
+
+  /** A history line for \a slv_r (the action padded like zypp writes it, unless \a padded_r is false). */
+  std::string line( const sat::Solvable & slv_r, const std::string & date_r, const std::string & state_r, bool padded_r = true )
+  {
+    return str::Str() << date_r << "|" << ( padded_r ? "patch  " : "patch" ) << "|" << slv_r.name() << "|" << slv_r.edition()
+                      << "|" << slv_r.arch() << "|updates|important|security|needed|" << state_r << "|\n";
+  }
+
+  void write( const Pathname & file_r, const std::string & text_r, std::ios::openmode mode_r = std::ios::trunc )
+  {
+    std::ofstream out( file_r.c_str(), std::ios::out | std::ios::binary | mode_r );
+    out << text_r;
+    BOOST_REQUIRE( out.flush() );
+  }
+
+  std::string read( const Pathname & file_r )
+  {
+    std::ifstream in( file_r.c_str(), std::ios::binary );
+    return std::string( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+  }
+
+  /** The history position stored in the index header. */
+  off_t indexOffset( const Pathname & index_r )
+  {
+    std::string header { read( index_r ) };
+    header.erase( header.find( '\n' ) );
+    std::vector<std::string> words;
+    str::split( header, std::back_inserter( words ) );
+    BOOST_REQUIRE_EQUAL( words.size(), 6 );
+    return str::strtonum<off_t>( words[4] );
+  }
+
+  /** Change the date of \a slv_r in the index, so it's visible whether the index was used. */
+  void tamperIndex( const Pathname & index_r, const sat::Solvable & slv_r, const Date & date_r )
+  {
+    std::istringstream in( read( index_r ) );
+    std::string out;
+    std::string l;
+    bool found = false;
+    while ( std::getline( in, l ) )
+    {
+      std::vector<std::string> fields;
+      str::split( l, std::back_inserter( fields ), "|" );
+      if ( fields.size() == 5 && fields[0] == slv_r.ident().asString() )
+      {
+        fields[3] = str::numstring( Date::ValueType(date_r) );
+        l = str::join( fields, "|" );
+        found = true;
+      }
+      out += l + "\n";
+    }
+    BOOST_REQUIRE( found );
+    write( index_r, out );
+  }
+
+  void checkEntry( const PatchHistoryData & data_r, const sat::Solvable & slv_r, const Date & date_r, ResStatus::ValidateValue state_r )
+  {
+    BOOST_CHECK_EQUAL( data_r[slv_r].first, date_r );
+    BOOST_CHECK_EQUAL( data_r[slv_r].second, state_r );
+  }
+
+  const Date tampered { date( "2001-01-01 00:00:00" ) };
+}
+
+BOOST_AUTO_TEST_CASE( no_history )
+{
+  filesystem::TmpDir tmp;
+  PatchHistoryData data( tmp.path() / "history", tmp.path() / "index" );
+  BOOST_CHECK( ! data );
+  BOOST_CHECK( ! PathInfo( tmp.path() / "index" ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE( append_only )
+{
+  std::vector<sat::Solvable> p { patches() };
+  filesystem::TmpDir tmp;
+  Pathname history { tmp.path() / "history" };
+  Pathname index { tmp.path() / "index" };
+
+  write( history, "# comment\n"
+                  + line( p[0], "2024-01-01 10:00:00", "needed" )
+                  + "2024-01-01 10:00:01|install|foo|1-1|x86_64|root@host|updates|abc|\n"
+                  + line( p[1], "2024-01-01 10:00:02", "applied", false )
+                  + line( p[0], "2024-01-02 10:00:00", "applied" ) );
+  {
+    PatchHistoryData data( history, index );
+    BOOST_REQUIRE( data );
+    checkEntry( data, p[0], date( "2024-01-02 10:00:00" ), ResStatus::SATISFIED );
+    checkEntry( data, p[1], date( "2024-01-01 10:00:02" ), ResStatus::SATISFIED );
+    BOOST_CHECK( data[p[2]] == PatchHistoryData::noData );
+    BOOST_CHECK_EQUAL( indexOffset( index ), PathInfo( history ).size() );
+  }
+
+  // Lines appended are parsed, the ones before are taken from the index.
+  tamperIndex( index, p[0], tampered );
+  write( history, line( p[2], "2024-01-03 10:00:00", "needed" ), std::ios::app );
+  {
+    PatchHistoryData data( history, index );
+    checkEntry( data, p[0], tampered, ResStatus::SATISFIED );
+    checkEntry( data, p[2], date( "2024-01-03 10:00:00" ), ResStatus::BROKEN );
+    BOOST_CHECK_EQUAL( indexOffset( index ), PathInfo( history ).size() );
+  }
+
+  // An incomplete last line is parsed once it is complete.
+  off_t complete { PathInfo( history ).size() };
+  std::string last { line( p[1], "2024-01-04 10:00:00", "needed" ) };
+  write( history, last.substr( 0, 20 ), std::ios::app );
+  {
+    PatchHistoryData data( history, index );
+    checkEntry( data, p[1], date( "2024-01-01 10:00:02" ), ResStatus::SATISFIED );
+    BOOST_CHECK_EQUAL( indexOffset( index ), complete );
+  }
+  write( history, last.substr( 20 ), std::ios::app );
+  {
+    PatchHistoryData data( history, index );
+    checkEntry( data, p[0], tampered, ResStatus::SATISFIED );
+    checkEntry( data, p[1], date( "2024-01-04 10:00:00" ), ResStatus::BROKEN );
+    BOOST_CHECK_EQUAL( indexOffset( index ), PathInfo( history ).size() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( rotated )
+{
+  std::vector<sat::Solvable> p { patches() };
+  filesystem::TmpDir tmp;
+  Pathname history { tmp.path() / "history" };
+  Pathname index { tmp.path() / "index" };
+
+  std::string text { line( p[0], "2024-01-01 10:00:00", "applied" ) };
+  write( history, text );
+  PatchHistoryData { history, index };
+  tamperIndex( index, p[0], tampered );
+
+  // A new file (new inode) with the same content is parsed from the beginning.
+  BOOST_REQUIRE_EQUAL( filesystem::rename( history, tmp.path() / "history-1" ), 0 );
+  write( history, text + line( p[1], "2024-01-02 10:00:00", "needed" ) );
+  PatchHistoryData data( history, index );
+  checkEntry( data, p[0], date( "2024-01-01 10:00:00" ), ResStatus::SATISFIED );
+  checkEntry( data, p[1], date( "2024-01-02 10:00:00" ), ResStatus::BROKEN );
+  BOOST_CHECK_EQUAL( indexOffset( index ), PathInfo( history ).size() );
+}
+
+BOOST_AUTO_TEST_CASE( truncated )
+{
+  std::vector<sat::Solvable> p { patches() };
+  filesystem::TmpDir tmp;
+  Pathname history { tmp.path() / "history" };
+  Pathname index { tmp.path() / "index" };
+
+  write( history, line( p[0], "2024-01-01 10:00:00", "applied" ) + line( p[1], "2024-01-02 10:00:00", "needed" ) );
+  PatchHistoryData { history, index };
+  tamperIndex( index, p[0], tampered );
+
+  // Rewritten in place (same inode) and not shorter: the fingerprint does not match.
+  PathInfo before { history };
+  write( history, line( p[0], "2024-02-01 10:00:00", "applied" ) + line( p[1], "2024-02-02 10:00:00", "needed" ) + line( p[2], "2024-02-03 10:00:00", "needed" ) );
+  BOOST_REQUIRE_EQUAL( PathInfo( history ).ino(), before.ino() );
+  {
+    PatchHistoryData data( history, index );
+    checkEntry( data, p[0], date( "2024-02-01 10:00:00" ), ResStatus::SATISFIED );
+    checkEntry( data, p[1], date( "2024-02-02 10:00:00" ), ResStatus::BROKEN );
+    checkEntry( data, p[2], date( "2024-02-03 10:00:00" ), ResStatus::BROKEN );
+  }
+
+  // Shorter than the position in the index.
+  tamperIndex( index, p[0], tampered );
+  write( history, line( p[0], "2024-03-01 10:00:00", "needed" ) );
+  {
+    PatchHistoryData data( history, index );
+    checkEntry( data, p[0], date( "2024-03-01 10:00:00" ), ResStatus::BROKEN );
+    BOOST_CHECK( data[p[1]] == PatchHistoryData::noData );
+    BOOST_CHECK( data[p[2]] == PatchHistoryData::noData );
+    BOOST_CHECK_EQUAL( indexOffset( index ), PathInfo( history ).size() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( corrupt_index )
+{
+  std::vector<sat::Solvable> p { patches() };
+  filesystem::TmpDir tmp;
+  Pathname history { tmp.path() / "history" };
+  Pathname index { tmp.path() / "index" };
+
+  write( history, line( p[0], "2024-01-01 10:00:00", "applied" ) );
+  PatchHistoryData { history, index };
+  std::string valid { read( index ) };
+  std::string header { valid.substr( 0, valid.find( '\n' ) ) };
+
+  for ( const std::string & corrupt : {
+    std::string(),
+    std::string( "garbage\n" ),
+    "#zypper-patch-history-index 1\n",
+    "#zypper-patch-history-index 2" + header.substr( header.find( " 1 " ) + 2 ) + "\n",	// other version
+    header + " 0\n",
+    header + "\n" + p[0].ident().asString() + "|only|three\n",	// valid header, bad entry
+  } )
+  {
+    write( index, corrupt );
+    PatchHistoryData data( history, index );
+    checkEntry( data, p[0], date( "2024-01-01 10:00:00" ), ResStatus::SATISFIED );
+    BOOST_CHECK( data[p[1]] == PatchHistoryData::noData );
+    BOOST_CHECK_EQUAL( read( index ), valid );	// rewritten
+  }
+}
@@ -0,0 +1,113 @@
+#include <tests/lib/TestSetup.h>
+#include <zypp/sat/Pool.h>
+
+#include <set>
+
+#include "utils/ReverseDependencyIndex.h"
+
+/** \file tests/ReverseDependencyIndex_test.cc
+ *
+ * 'search --requires-pkg/--provides-pkg [--verbose]' used to call
+ * sat::Pool::whatMatchesSolvable for each query hit and
+ * sat::Solvable::matchesSolvable for each match. The index must find
+ * the same solvables and dependencies.
+ */
+
+using namespace zypp;
+
+static TestSetup test( TestSetup::initLater );
+struct TestInit {
+  TestInit() {
+    test = TestSetup( Arch_x86_64 );
+    zypp::base::LogControl::instance().logfile( "./zypper_test.log" );
+    test.loadTargetRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_subset" );
+    test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "main" );
+  }
+  ~TestInit() { test.reset(); }
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+namespace
+{
+  using Matches = std::unordered_map<sat::Solvable, CapabilitySet>;
+
+  /** The installed and available solvables named \a name_r (the query hits). */
+  std::unordered_set<sat::Solvable> named( const std::string & name_r )
+  {
+    std::unordered_set<sat::Solvable> ret;
+    for ( const sat::Solvable & slv : test.satpool().solvables() )
+    {
+      if ( slv.name() == name_r )
+        ret.insert( slv );
+    }
+    return ret;
+  }
+
+  /** The former lookup: whatMatchesSolvable per provider, matchesSolvable per match. */
+  Matches perProvider( const sat::SolvAttr & attr_r, const std::unordered_set<sat::Solvable> & providers_r )
+  {
+    Matches ret;
+    for ( const sat::Solvable & prv : providers_r )
+    {
+      for ( auto id : sat::Pool::instance().whatMatchesSolvable( attr_r, prv ) )
+      {
+        sat::Solvable matched { static_cast<sat::Solvable::IdType>(id) };
+        CapabilitySet caps { matched.matchesSolvable( attr_r, prv ).second };
+        ret[matched].insert( caps.begin(), caps.end() );
+      }
+    }
+    return ret;
+  }
+
+  std::set<std::string> solvables( const Matches & matches_r )
+  {
+    std::set<std::string> ret;
+    for ( const auto & el : matches_r )
+      ret.insert( el.first.asString() );
+    return ret;
+  }
+
+  /** Compare the solvables (plain) and their dependencies (--verbose). */
+  void checkSame( const sat::SolvAttr & attr_r, const std::unordered_set<sat::Solvable> & providers_r, const std::string & what_r )
+  {
+    BOOST_REQUIRE_MESSAGE( ! providers_r.empty(), what_r );
+    Matches expected { perProvider( attr_r, providers_r ) };
+    Matches indexed { ReverseDependencyIndex::get( attr_r ).whatMatches( providers_r ) };
+
+    BOOST_CHECK_MESSAGE( solvables( indexed ) == solvables( expected ), what_r << ": " << indexed.size() << " solvables, expected " << expected.size() );
+    for ( const auto & [ slv, caps ] : expected )
+    {
+      auto it = indexed.find( slv );
+      if ( it != indexed.end() )
+        BOOST_CHECK_MESSAGE( it->second == caps, what_r << ": dependencies of " << slv );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( requires_pkg )
+{
+  for ( const char * lib : { "glibc", "zlib", "libxml2" } )
+    checkSame( sat::SolvAttr::dep_requires, named( lib ), std::string("--requires-pkg ") + lib );
+  BOOST_CHECK( ! perProvider( sat::SolvAttr::dep_requires, named( "glibc" ) ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( provides_pkg )
+{
+  for ( const char * lib : { "glibc", "zlib", "libxml2" } )
+    checkSame( sat::SolvAttr::dep_provides, named( lib ), std::string("--provides-pkg ") + lib );
+}
+
+BOOST_AUTO_TEST_CASE( several_providers )
+{
+  // one query hitting several packages (and installed and available versions)
+  std::unordered_set<sat::Solvable> providers;
+  for ( const char * lib : { "glibc", "zlib", "libxml2" } )
+  {
+    std::unordered_set<sat::Solvable> hits { named( lib ) };
+    providers.insert( hits.begin(), hits.end() );
+  }
+  checkSame( sat::SolvAttr::dep_requires, providers, "--requires-pkg (several)" );
+  checkSame( sat::SolvAttr::dep_recommends, providers, "--recommends-pkg (several)" );
+
+  BOOST_CHECK( ReverseDependencyIndex::get( sat::SolvAttr::dep_requires ).whatMatches( {} ).empty() );
+}
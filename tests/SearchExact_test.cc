@@ -0,0 +1,114 @@
+#include <tests/lib/TestSetup.h>
+#include <sstream>
+
+#include "commands/search/search.h"
+#include "output/OutXML.h"
+
+/** \file tests/SearchExact_test.cc
+ *
+ * 'search --match-exact' with plain names looks up the names (case
+ * insensitive via an index of the lowercased names in the pool) rather than
+ * running a PoolQuery with one term per argument. The result must be the same.
+ */
+
+using namespace zypp;
+
+extern ZYpp::Ptr God;
+static TestSetup test( TestSetup::initLater );
+struct TestInit {
+  TestInit() {
+    test = TestSetup( Arch_x86_64 );
+    zypp::base::LogControl::instance().logfile( "./zypper_test.log" );
+    God = zypp::getZYpp();
+
+    test.loadTargetRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_subset" );
+    test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "main" );
+    test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_updates", "updates" );
+  }
+  ~TestInit() { test.reset(); }
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+namespace
+{
+  /** The XML written by 'search --match-exact \a options_r \a names_r'. */
+  std::string xmlSearch( std::vector<const char *> options_r, const std::vector<std::string> & names_r, bool lookup_r )
+  {
+    Zypper & zypper { Zypper::instance() };
+    zypper.setOutputWriter( new OutXML( Out::QUIET ) );
+
+    SearchCmd cmd( { "search" } );
+    options_r.insert( options_r.begin(), { "search", "--match-exact" } );
+    cmd.parseArguments( zypper, options_r.size(), const_cast<char * const *>( options_r.data() ) );
+    cmd.setPositionalArguments( names_r );
+
+    SearchCmd::exactNameLookup = lookup_r;
+    std::ostringstream str;
+    std::streambuf * saved = cout.rdbuf( str.rdbuf() );
+    cmd.run( zypper );
+    cout.rdbuf( saved );
+    SearchCmd::exactNameLookup = true;
+    return str.str();
+  }
+
+  /** Whether the lookup finds what the PoolQuery finds; returns the number of hits. */
+  unsigned checkSame( const std::vector<const char *> & options_r, const std::vector<std::string> & names_r )
+  {
+    std::string query { xmlSearch( options_r, names_r, false ) };
+    std::string lookup { xmlSearch( options_r, names_r, true ) };
+    std::ostringstream what;
+    for ( const char * option : options_r )
+      what << option << " ";
+    for ( const std::string & name : names_r )
+      what << name << " ";
+    BOOST_CHECK_MESSAGE( lookup == query, "search --match-exact " << what.str() );
+
+    unsigned hits = 0;
+    for ( std::string::size_type pos = query.find( "<solvable " ); pos != std::string::npos; pos = query.find( "<solvable ", pos+1 ) )
+      ++hits;
+    return hits;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( names )
+{
+  const std::vector<std::string> names { "zypper", "glibc", "kernel-default", "nomatch" };
+  BOOST_CHECK( checkSame( {}, names ) );
+  BOOST_CHECK( checkSame( { "--details" }, names ) );
+  BOOST_CHECK( checkSame( { "--case-sensitive" }, names ) );
+  BOOST_CHECK( ! checkSame( {}, { "nomatch" } ) );
+}
+
+BOOST_AUTO_TEST_CASE( case_insensitive )
+{
+  BOOST_CHECK( checkSame( {}, { "ZYPPER", "GLibc", "Kernel-Default" } ) );
+  BOOST_CHECK( checkSame( { "--details" }, { "ZYPPER", "zypper" } ) );
+  BOOST_CHECK( ! checkSame( { "--case-sensitive" }, { "ZYPPER", "GLibc" } ) );
+}
+
+BOOST_AUTO_TEST_CASE( name_edition )
+{
+  // "N-V" and "N-V-R" (glibc-2.9-2.9 is in the subset and main)
+  BOOST_CHECK( checkSame( { "--details" }, { "glibc-2.9", "glibc-2.9-2.9" } ) );
+  BOOST_CHECK( checkSame( { "--details" }, { "GLIBC-2.9-2.9", "zypper" } ) );
+  BOOST_CHECK( checkSame( { "--details", "--case-sensitive" }, { "glibc-2.9-2.9" } ) );
+  checkSame( { "--details" }, { "glibc-0.1", "glibc-2.9-0.1" } );
+}
+
+BOOST_AUTO_TEST_CASE( kinds )
+{
+  const std::vector<std::string> names { "zypper", "glibc", "kernel-default", "base", "openSUSE" };
+  for ( const char * kind : { "package", "srcpackage", "pattern", "product", "patch" } )
+  {
+    checkSame( { "--type", kind }, names );
+    checkSame( { "--type", kind, "--case-sensitive" }, names );
+  }
+  checkSame( { "--type", "pattern", "--type", "product" }, { "BASE", "OPENsuse" } );
+}
+
+BOOST_AUTO_TEST_CASE( repeated )
+{
+  // the name index is kept for the same pool
+  for ( unsigned i = 0; i < 3; ++i )
+    BOOST_CHECK( checkSame( {}, { "Zypper", "glibc" } ) );
+}
@@ -0,0 +1,175 @@
+#include <tests/lib/TestSetup.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/Pattern.h>
+#include <zypp-core/fs/PathInfo.h>
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "utils/SearchIndex.h"
+
+using namespace zypp;
+
+static TestSetup test( TestSetup::initLater );
+struct TestInit {
+  TestInit() {
+    test = TestSetup( Arch_x86_64 );
+    zypp::base::LogControl::instance().logfile( "./zypper_test.log" );
+    test.loadRepo(TESTS_SRC_DIR "/data/openSUSE-11.1", "main");
+  }
+  ~TestInit() { test.reset(); }
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+namespace
+{
+  Repository repo()
+  { return sat::Pool::instance().reposFind( "main" ); }
+
+  Pathname dir()
+  { return SearchIndex::dir( RepoManagerOptions::makeTestSetup( test.root() ).repoSolvCachePath, repo() ); }
+
+  bool containsCI( const std::string & str_r, const std::string & literal_r )
+  { return str::toLower( str_r ).find( str::toLower( literal_r ) ) != std::string::npos; }
+
+  std::unordered_set<sat::Solvable> candidates( const SearchIndex & index_r, const std::string & literal_r, bool text_r )
+  {
+    std::optional<std::vector<sat::Solvable>> cand { index_r.candidates( literal_r, text_r ) };
+    BOOST_REQUIRE_MESSAGE( cand, "No lookup for " << literal_r );
+    BOOST_CHECK( std::is_sorted( cand->begin(), cand->end(), []( sat::Solvable lhs, sat::Solvable rhs ) { return lhs.id() < rhs.id(); } ) );
+    return { cand->begin(), cand->end() };
+  }
+
+  /** Each solvable containing \a literal_r must be a candidate. */
+  unsigned checkCandidates( const SearchIndex & index_r, const std::string & literal_r, bool text_r )
+  {
+    std::unordered_set<sat::Solvable> cset { candidates( index_r, literal_r, text_r ) };
+    unsigned hits = 0;
+    for ( const sat::Solvable & slv : repo().solvables() )
+    {
+      bool hit = containsCI( slv.name(), literal_r );
+      if ( ! hit && text_r )
+        hit = containsCI( slv.lookupStrAttribute( sat::SolvAttr::summary ), literal_r )
+           || containsCI( slv.lookupStrAttribute( sat::SolvAttr::description ), literal_r );
+      if ( hit )
+      {
+        ++hits;
+        BOOST_CHECK_MESSAGE( cset.count( slv ), slv << " is no candidate for " << literal_r );
+      }
+    }
+    return hits;
+  }
+
+  void touchSolv()
+  {
+    PathInfo solv { dir() / "solv" };
+    BOOST_REQUIRE( solv.isFile() );
+    struct timespec ts[2] = { { solv.mtime()+60, 0 }, { solv.mtime()+60, 0 } };
+    BOOST_REQUIRE( ::utimensat( AT_FDCWD, solv.path().c_str(), ts, 0 ) == 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(build)
+{
+  BOOST_REQUIRE( repo() );
+  SearchIndex::build( repo(), dir() );
+  BOOST_CHECK( SearchIndex::upToDate( dir() ) );
+  BOOST_CHECK( SearchIndex( repo(), dir() ) );
+}
+
+BOOST_AUTO_TEST_CASE(trigrams)
+{
+  SearchIndex index( repo(), dir() );
+  BOOST_REQUIRE( index );
+
+  for ( const std::string & literal : { "zyp", "lib", "apparmor", "devel", "kernel-default" } )
+  {
+    BOOST_CHECK( checkCandidates( index, literal, false ) );
+    BOOST_CHECK( checkCandidates( index, literal, true ) );
+  }
+  // summary/description matches are no name candidates
+  BOOST_CHECK( candidates( index, "the", false ).size() < candidates( index, "the", true ).size() );
+  // nothing to find
+  BOOST_CHECK( candidates( index, "qqqxxxqqq", true ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE(case_folding)
+{
+  SearchIndex index( repo(), dir() );
+  BOOST_REQUIRE( index );
+
+  BOOST_CHECK( candidates( index, "ZYP", false ) == candidates( index, "zyp", false ) );
+  BOOST_CHECK( candidates( index, "KeRnEl", true ) == candidates( index, "kernel", true ) );
+}
+
+BOOST_AUTO_TEST_CASE(short_queries)
+{
+  SearchIndex index( repo(), dir() );
+  BOOST_REQUIRE( index );
+
+  BOOST_CHECK( ! index.candidates( "", false ) );
+  BOOST_CHECK( ! index.candidates( "z", false ) );
+  BOOST_CHECK( ! index.candidates( "zy", true ) );
+  BOOST_CHECK( index.candidates( "zyp", true ) );
+}
+
+BOOST_AUTO_TEST_CASE(kind_prefix)
+{
+  SearchIndex index( repo(), dir() );
+  BOOST_REQUIRE( index );
+
+  // patterns are found by name, not by the "pattern:" of their ident
+  std::unordered_set<sat::Solvable> cset { candidates( index, "pattern", false ) };
+  unsigned patterns = 0;
+  for ( const sat::Solvable & slv : repo().solvables() )
+  {
+    if ( ! slv.isKind<Pattern>() )
+      continue;
+    ++patterns;
+    if ( slv.name().size() >= 3 )
+      BOOST_CHECK_MESSAGE( candidates( index, slv.name(), false ).count( slv ), slv << " is no candidate for its name" );
+    if ( ! containsCI( slv.name(), "pattern" ) )
+      BOOST_CHECK_MESSAGE( ! cset.count( slv ), slv << " is a candidate for 'pattern'" );
+  }
+  BOOST_CHECK( patterns );
+}
+
+BOOST_AUTO_TEST_CASE(staleness)
+{
+  Pathname ifile { dir() / "search-index" };
+
+  // corrupt magic
+  {
+    std::fstream f( ifile.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+    f.seekp( 0 );
+    f.write( "XXXX", 4 );
+  }
+  BOOST_CHECK( ! SearchIndex::upToDate( dir() ) );
+  BOOST_CHECK( ! SearchIndex( repo(), dir() ) );
+  BOOST_CHECK( SearchIndex::update( repo(), dir() ) );
+  BOOST_CHECK( SearchIndex( repo(), dir() ) );
+
+  // truncated
+  BOOST_REQUIRE( ::truncate( ifile.c_str(), PathInfo( ifile ).size() - 1 ) == 0 );
+  BOOST_CHECK( ! SearchIndex::upToDate( dir() ) );
+  BOOST_CHECK( ! SearchIndex( repo(), dir() ) );
+  BOOST_CHECK( SearchIndex::update( repo(), dir() ) );
+  BOOST_CHECK( SearchIndex( repo(), dir() ) );
+
+  // solv file changed
+  touchSolv();
+  BOOST_CHECK( ! SearchIndex::upToDate( dir() ) );
+  BOOST_CHECK( ! SearchIndex( repo(), dir() ) );
+  BOOST_CHECK( SearchIndex::update( repo(), dir() ) );
+  BOOST_CHECK( SearchIndex( repo(), dir() ) );
+
+  // missing
+  filesystem::unlink( ifile );
+  BOOST_CHECK( ! SearchIndex::upToDate( dir() ) );
+  BOOST_CHECK( ! SearchIndex( repo(), dir() ) );
+}
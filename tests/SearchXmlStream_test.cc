@@ -0,0 +1,70 @@
+#include <tests/lib/TestSetup.h>
+#include <climits>
+#include <sstream>
+
+#include "commands/search/search.h"
+#include "output/OutXML.h"
+
+using namespace zypp;
+
+extern ZYpp::Ptr God;
+static TestSetup test( TestSetup::initLater );
+struct TestInit {
+  TestInit() {
+    test = TestSetup( Arch_x86_64 );
+    zypp::base::LogControl::instance().logfile( "./zypper_test.log" );
+    God = zypp::getZYpp();
+
+    // Byte-wise "Packman" sorts before "openSUSE", case insensitive after it.
+    test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "openSUSE" );
+    test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_subset", "Packman" );
+  }
+  ~TestInit() { test.reset(); }
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+namespace
+{
+  /** The XML written by 'search \a args_r' with chunks of \a chunkRows_r rows. */
+  std::string xmlSearch( std::vector<const char *> args_r, unsigned chunkRows_r )
+  {
+    Zypper & zypper { Zypper::instance() };
+    zypper.setOutputWriter( new OutXML( Out::QUIET ) );
+
+    SearchCmd cmd( { "search" } );
+    args_r.insert( args_r.begin(), "search" );
+    cmd.parseArguments( zypper, args_r.size(), const_cast<char * const *>( args_r.data() ) );
+    cmd.setPositionalArguments( { "lib" } );
+
+    SearchCmd::xmlChunkRows = chunkRows_r;
+    std::ostringstream str;
+    std::streambuf * saved = cout.rdbuf( str.rdbuf() );
+    cmd.run( zypper );
+    cout.rdbuf( saved );
+    SearchCmd::xmlChunkRows = 1000;
+    return str.str();
+  }
+
+  void checkStreamed( const std::vector<const char *> & args_r )
+  {
+    std::string full { xmlSearch( args_r, UINT_MAX ) };	// a single chunk: the complete table sorted
+    BOOST_REQUIRE( full.find( "<solvable " ) != std::string::npos );
+    for ( unsigned chunkRows : { 1U, 7U, 100U } )
+      BOOST_CHECK_MESSAGE( xmlSearch( args_r, chunkRows ) == full, "chunks of " << chunkRows << " rows" );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( by_name )
+{
+  checkStreamed( {} );
+  checkStreamed( { "--details" } );
+}
+
+BOOST_AUTO_TEST_CASE( by_repo )
+{
+  std::string full { xmlSearch( { "--details", "--sort-by-repo" }, UINT_MAX ) };
+  // both repos are in the result, ordered as Table::sort does
+  BOOST_REQUIRE( full.find( "repository=\"Packman\"" ) != std::string::npos );
+  BOOST_REQUIRE( full.find( "repository=\"openSUSE\"" ) != std::string::npos );
+  checkStreamed( { "--details", "--sort-by-repo" } );
+}
@@ -0,0 +1,116 @@
+#include <tests/lib/TestSetup.h>
+#include <clocale>
+#include <sstream>
+
+#include <zypp/ui/Selectable.h>
+
+#include "Summary.h"
+#include "lib/BaselineSummary.h"
+
+/** \file tests/Summary_test.cc
+ *
+ * The Summary keeps its lists as flat solvable vectors, collects the weak
+ * dependencies in one memoized walk and classifies the transaction in a
+ * single pool sweep. The output must stay the same: it is compared with the
+ * output of the baseline Summary (tests/lib/BaselineSummary.cc) for a fixed
+ * transaction, for several view options and collation locales.
+ */
+
+using namespace zypp;
+
+extern ZYpp::Ptr God;
+static TestSetup test( TestSetup::initLater );
+struct TestInit {
+  TestInit() {
+    test = TestSetup( Arch_x86_64 );
+    zypp::base::LogControl::instance().logfile( "./zypper_test.log" );
+    God = zypp::getZYpp();
+
+    test.loadTargetRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_subset" );
+    test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "main" );
+    test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_updates", "updates" );
+
+    // Installs (with recommends), upgrades and removals.
+    for ( const char * name : { "MozillaFirefox", "zypper", "GraphicsMagick" } )
+      ui::Selectable::get( name )->setToInstall( ResStatus::USER );
+    for ( const char * name : { "cron", "PolicyKit-doc" } )
+      ui::Selectable::get( name )->setToDelete( ResStatus::USER );
+    test.resolver().setForceResolve( true );
+    test.resolver().doUpdate();
+  }
+  ~TestInit() { test.reset(); }
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+namespace
+{
+  struct Rendered
+  {
+    std::string plain;
+    std::string xml;
+    unsigned toInstall = 0;
+  };
+
+  template <class TSummary>
+  Rendered render( unsigned viewOptions_r )
+  {
+    TSummary summary( test.pool(), SummaryHints(), typename TSummary::ViewOptions( viewOptions_r ) );
+    summary.setForceNoColor( true );
+
+    Rendered ret;
+    std::ostringstream plain;
+    summary.dumpTo( plain );
+    ret.plain = plain.str();
+    std::ostringstream xml;
+    summary.dumpAsXmlTo( xml );
+    ret.xml = xml.str();
+    ret.toInstall = summary.packagesToGetAndInstall();
+    return ret;
+  }
+
+  void checkSameOutput( const char * locale_r )
+  {
+    for ( unsigned viewOptions : {
+      unsigned(Summary::DEFAULT),
+      unsigned(Summary::DEFAULT | Summary::SHOW_VERSION | Summary::SHOW_REPO),
+      unsigned(Summary::DETAILS | Summary::SHOW_UNSUPPORTED | Summary::SHOW_NOT_UPDATED | Summary::SHOW_LOCKS),
+      unsigned(Summary::SHOW_ALL),
+    } )
+    {
+      Rendered current { render<Summary>( viewOptions ) };
+      Rendered baseline { render<baseline::Summary>( viewOptions ) };
+      BOOST_CHECK( current.toInstall );
+      BOOST_CHECK_EQUAL( current.toInstall, baseline.toInstall );
+      BOOST_CHECK_MESSAGE( current.plain == baseline.plain,
+                           "plain output differs (" << locale_r << ", view options 0x" << std::hex << viewOptions << ")" );
+      BOOST_CHECK_MESSAGE( current.xml == baseline.xml,
+                           "XML output differs (" << locale_r << ", view options 0x" << std::hex << viewOptions << ")" );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( transaction )
+{
+  unsigned transacting = 0;
+  for ( const PoolItem & pi : test.pool() )
+  {
+    if ( pi.status().transacts() )
+      ++transacting;
+  }
+  BOOST_REQUIRE( transacting );
+}
+
+BOOST_AUTO_TEST_CASE( same_output )
+{
+  // The names are ordered by strcoll, so the collation locale matters.
+  for ( const char * locale : { "C", "en_US.UTF-8", "de_DE.UTF-8" } )
+  {
+    if ( ! std::setlocale( LC_COLLATE, locale ) )
+    {
+      BOOST_TEST_MESSAGE( "locale " << locale << " not available" );
+      continue;
+    }
+    checkSameOutput( locale );
+  }
+  std::setlocale( LC_COLLATE, "C" );
+}
@@ -0,0 +1,162 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+/** \file zypper-bench.cc
+ * Time zypper's startup and query hot paths on the test repos.
+ *
+ * Not a unit test; run it manually and compare the results between
+ * releases:
+ * \code
+ *   make zypper-bench && tests/zypper-bench [ITERATIONS] > bench.json
+ * \endcode
+ * Prints one JSON object per line (NDJSON). Each line holds either the pool
+ * setup used, or the timings of one operation in milliseconds.
+ */
+#define INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include <tests/lib/TestSetup.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+
+#include "commands/search/search.h"
+#include "commands/query/info.h"
+#include "update.h"
+#include "Summary.h"
+
+using namespace zypp;
+
+extern ZYpp::Ptr God;
+
+namespace
+{
+  /** Redirect std::cout to /dev/null while in scope; the commands print a lot. */
+  struct MuteCout
+  {
+    MuteCout()
+    : _devnull( "/dev/null" )
+    , _orig( cout.rdbuf( _devnull.rdbuf() ) )
+    {}
+
+    ~MuteCout()
+    { cout.rdbuf( _orig ); }
+
+    std::ofstream _devnull;
+    std::streambuf * _orig;
+  };
+
+  /** Run \a fnc_r \a iterations_r times and print the timings as JSON line. */
+  void bench( const std::string & name_r, unsigned iterations_r, const std::function<void()> & fnc_r )
+  {
+    std::vector<double> ms;
+    for ( unsigned i = 0; i < iterations_r; ++i )
+    {
+      MuteCout mute;
+      auto start = std::chrono::steady_clock::now();
+      fnc_r();
+      ms.push_back( std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count() );
+    }
+    std::sort( ms.begin(), ms.end() );
+
+    double total = 0;
+    for ( double t : ms )
+      total += t;
+
+    cout << "{\"name\":\"" << name_r << "\""
+         << ",\"iterations\":" << iterations_r
+         << str::form( ",\"min_ms\":%.3f,\"median_ms\":%.3f,\"max_ms\":%.3f,\"total_ms\":%.3f",
+                       ms.front(), ms[ms.size()/2], ms.back(), total )
+         << "}" << endl;
+  }
+
+  /** RepoInfo for a test repo in \a dir_r. */
+  RepoInfo testRepo( const std::string & alias_r, const Pathname & dir_r )
+  {
+    RepoInfo ret;
+    ret.setAlias( alias_r );
+    ret.addBaseUrl( dir_r.asUrl() );
+    ret.setGpgCheck( false );
+    return ret;
+  }
+
+  void runCommand( ZypperBaseCommand & cmd_r, const std::vector<std::string> & args_r )
+  {
+    Zypper & zypper { Zypper::instance() };
+    zypper.clearExitInfoCode();
+    cmd_r.setPositionalArguments( args_r );
+    cmd_r.run( zypper );
+  }
+} // namespace
+
+int main( int argc, char * argv[] )
+{
+  unsigned iterations = 5;
+  if ( argc > 1 )
+    iterations = std::max( 1U, str::strtonum<unsigned>( argv[1] ) );
+
+  zypp::base::LogControl::instance().logfile( "./zypper_bench.log" );
+
+  TestSetup test( Arch_x86_64 );
+  God = zypp::getZYpp();
+  Zypper & zypper { test.zypper() };
+
+  RepoManager repoManager { test.repomanager() };
+  RepoInfo mainRepo { testRepo( "main", TESTS_SRC_DIR "/data/openSUSE-11.1" ) };
+  RepoInfo updatesRepo { testRepo( "updates", TESTS_SRC_DIR "/data/openSUSE-11.1_updates" ) };
+  // A subset of the main repo faked as installed system
+  RepoInfo systemRepo { testRepo( sat::Pool::systemRepoAlias(), TESTS_SRC_DIR "/data/openSUSE-11.1_subset" ) };
+  for ( const RepoInfo & repo : { mainRepo, updatesRepo, systemRepo } )
+    repoManager.addRepository( repo );
+
+  // startup
+  bench( "repo-build-cache", iterations, [&]() { repoManager.buildCache( mainRepo, RepoManager::BuildForced ); } );
+  bench( "repo-load", iterations, [&]() { repoManager.loadFromCache( mainRepo ); } );
+  repoManager.buildCache( updatesRepo );
+  repoManager.loadFromCache( updatesRepo );
+  repoManager.buildCache( systemRepo );
+  // There is no rpmdb in the test root, so this is loading the faked @System
+  // from its solv cache, not Target::load().
+  bench( "system-repo-load", iterations, [&]() { repoManager.loadFromCache( systemRepo ); } );
+  bench( "pool-prepare", 1, [&]() { test.poolProxy(); } );
+
+  const sat::Pool & satpool { test.satpool() };
+  cout << "{\"name\":\"pool\",\"repos\":" << satpool.reposSize()
+       << ",\"solvables\":" << satpool.solvablesSize()
+       << ",\"installed\":" << satpool.systemRepo().solvablesSize()
+       << "}" << endl;
+
+  // queries
+  {
+    SearchCmd cmd( { "search" } );
+    bench( "search", iterations, [&]() { runCommand( cmd, { "zypper" } ); } );
+  }
+  {
+    SearchCmd cmd( { "search" } );
+    cmd.setMode( SearchCmd::MatchMode::Exact );
+    bench( "search-exact", iterations, [&]() { runCommand( cmd, { "zypper", "glibc", "kernel-default", "nomatch" } ); } );
+  }
+  {
+    InfoCmd cmd( { "info" } );
+    bench( "info", iterations, [&]() { runCommand( cmd, { "zypper", "glibc" } ); } );
+  }
+  bench( "list-updates", iterations, [&]() { list_updates( zypper, { ResKind::package }, false, false ); } );
+  bench( "list-updates-candidates", iterations, [&]() { list_updates( zypper, { ResKind::package }, false, false, PatchSelector(), VCF_None, UpdateMode::Candidates ); } );
+  bench( "list-patches", iterations, [&]() { list_updates( zypper, { ResKind::patch }, false, false ); } );
+
+  // summary of a full update
+  bench( "resolve-update", 1, [&]() { God->resolver()->doUpdate(); } );
+  bench( "summary", iterations, [&]() {
+    Summary summary( God->pool(), SummaryHints() );
+    summary.dumpTo( cout );
+  } );
+  bench( "summary-xml", iterations, [&]() {
+    Summary summary( God->pool(), SummaryHints() );
+    summary.dumpAsXmlTo( cout );
+  } );
+
+  return 0;
+}